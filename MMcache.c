@@ -0,0 +1,164 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// On-disk cache of the mark table for each puzzle size
+// The table is written once, then mapped in read-only by later runs - so concurrent runs share it through the page cache
+// Anything wrong with a cache file (wrong version, wrong size, bad checksum) just means the table is built again
+//
+#include "MMcache.h"
+#include "MMchk.h"
+#include "MMparams.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Map in the cached mark table for this puzzle, if there is a good one
+// Returns 0 with markTable pointing into the mapped file, otherwise 1 (and the table needs to be built)
+int mapMarkCache( Repo* pRepo )
+{
+    char         name[512];
+    struct stat  info;
+    CacheHeader* pHeader = NULL;
+    void*        map     = NULL;
+    char*        reason  = NULL;
+    uint64_t     size    = markTableSize( pRepo );
+    int          fd      = -1;
+
+    markCacheName( pRepo, name, sizeof(name) );
+    fd = open( name, O_RDONLY );
+    if( fd == -1 ) return 1;            // Not cached yet
+
+    if( fstat( fd, &info ) != 0 || (uint64_t)info.st_size != sizeof(CacheHeader) + size )
+    {
+        close( fd );
+        fprintf( pRepo->err, "Mark cache %s is the wrong size - rebuilding it\n", name );
+        return 1;
+    }
+    map = mmap( NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if( map == MAP_FAILED )
+    {
+        fprintf( pRepo->err, "Unable to map mark cache %s (%s) - rebuilding it\n", name, strerror( errno ) );
+        return 1;
+    }
+
+    pHeader = (CacheHeader*)map;
+    if( memcmp( pHeader->magic, MARK_CACHE_MAGIC, 8 ) != 0 )
+        reason = "is not a mark cache";
+    else if( pHeader->version != MARK_CACHE_VERSION )
+        reason = "is from another version";
+    else if( pHeader->pegs != (uint32_t)pRepo->pegs || pHeader->colours != (uint32_t)pRepo->colours
+             || pHeader->codes != (uint32_t)pRepo->codes || pHeader->size != size )
+        reason = "is for another puzzle";
+    else if( pHeader->checksum != cacheChecksum( (unsigned char*)map + sizeof(CacheHeader), size ) )
+        reason = "is corrupt";
+
+    if( reason != NULL )
+    {
+        munmap( map, info.st_size );
+        fprintf( pRepo->err, "Mark cache %s %s - rebuilding it\n", name, reason );
+        return 1;
+    }
+
+    pRepo->markMap     = map;
+    pRepo->markMapSize = info.st_size;
+    pRepo->markTable   = (char*)map + sizeof(CacheHeader);     // Read only - nothing writes to the marks once set up
+    return 0;
+}
+
+// Write the mark table to the cache
+// It goes to a temporary file which is then renamed, so no other run can ever see a half written cache
+int saveMarkCache( Repo* pRepo )
+{
+    char        name[512];
+    char        temp[520];
+    CacheHeader header;
+    uint64_t    size    = markTableSize( pRepo );
+    uint64_t    done    = 0;
+    ssize_t     written = 0;
+    int         fd      = -1;
+    int         rc      = 0;
+
+    memset( &header, 0, sizeof(header) );
+    memcpy( header.magic, MARK_CACHE_MAGIC, 8 );
+    header.version  = MARK_CACHE_VERSION;
+    header.pegs     = pRepo->pegs;
+    header.colours  = pRepo->colours;
+    header.codes    = pRepo->codes;
+    header.size     = size;
+    header.checksum = cacheChecksum( (unsigned char*)pRepo->markTable, size );
+
+    markCacheName( pRepo, name, sizeof(name) );
+    snprintf( temp, sizeof(temp), "%s.XXXXXX", name );
+    fd = mkstemp( temp );
+    if( fd == -1 )
+    {
+        fprintf( pRepo->err, "Unable to write mark cache %s (%s)\n", name, strerror( errno ) );
+        return -1;
+    }
+
+    if( write( fd, &header, sizeof(header) ) != sizeof(header) ) rc = -1;
+    while( rc == 0 && done < size )
+    {
+        written = write( fd, pRepo->markTable + done, size - done );
+        if( written <= 0 ) rc = -1;
+        else done += written;
+    }
+    if( rc == 0 && fchmod( fd, 0644 ) != 0 ) rc = -1;
+    if( close( fd ) != 0 ) rc = -1;
+    if( rc == 0 && rename( temp, name ) != 0 ) rc = -1;
+
+    if( rc != 0 )
+    {
+        fprintf( pRepo->err, "Unable to write mark cache %s (%s)\n", name, strerror( errno ) );
+        unlink( temp );
+    }
+    return rc;
+}
+
+// Release a mapped mark cache
+void unmapMarkCache( Repo* pRepo )
+{
+    munmap( pRepo->markMap, pRepo->markMapSize );
+    pRepo->markMap     = NULL;
+    pRepo->markMapSize = 0;
+    pRepo->markTable   = NULL;
+}
+
+// Name of the cache file for this puzzle - the version is part of the name, so different versions can share a directory
+void markCacheName( Repo* pRepo, char* name, int maxLen )
+{
+    snprintf( name, maxLen, "%s/MMmarks(%d,%d).v%d", pRepo->markCache, pRepo->pegs, pRepo->colours, MARK_CACHE_VERSION );
+}
+
+// FNV-1a over 64 bit words (then any odd bytes at the end) - quick enough to check a big table on every load
+uint64_t cacheChecksum( const unsigned char* data, uint64_t size )
+{
+    uint64_t hash  = 0xcbf29ce484222325ULL;
+    uint64_t word  = 0;
+    uint64_t i     = 0;
+
+    for( i = 0; i + 8 <= size; i += 8 )
+    {
+        memcpy( &word, data + i, 8 );
+        hash = ( hash ^ word ) * 0x100000001b3ULL;
+    }
+    for( ; i < size; i++ )
+        hash = ( hash ^ data[i] ) * 0x100000001b3ULL;
+
+    return hash;
+}
@@ -0,0 +1,40 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMCACHE_H
+#define MMCACHE_H
+
+#include "MMchk.h"
+
+#include <stdint.h>
+
+#define MARK_CACHE_MAGIC       "MMchkMRK"
+#define MARK_CACHE_VERSION     2                       // Change whenever the layout of the mark table changes
+
+// Start of a mark cache file - the mark table follows straight after
+typedef struct CacheHeader
+{
+    char     magic[8];                                 // MARK_CACHE_MAGIC
+    uint32_t version;                                  // MARK_CACHE_VERSION
+    uint32_t pegs;
+    uint32_t colours;
+    uint32_t codes;
+    uint64_t size;                                     // Bytes of mark table following the header
+    uint64_t checksum;                                 // Of the mark table, to catch a corrupt file
+    uint8_t  spare[24];                                // Pad to 64 bytes, so the table is well aligned
+} CacheHeader;
+
+int      mapMarkCache( Repo* pRepo );
+int      saveMarkCache( Repo* pRepo );
+void     unmapMarkCache( Repo* pRepo );
+void     markCacheName( Repo* pRepo, char* name, int maxLen );
+uint64_t cacheChecksum( const unsigned char* data, uint64_t size );
+
+#endif  /* MMCACHE_H */
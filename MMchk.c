@@ -9,41 +9,123 @@
 //  I would be very interested to hear your feedback about this program and results you have obtained from it
 /******************************************************************************************************************/
 //
-// Main function to setup,launch and report on the resolution of a Mastermind puzzle
+// Functions to launch and report on the checking of a Mastermind solution
 //
 #include "MMchk.h"
 #include "MMparams.h"
 #include "MMsortfns.h"
 #include "MMutility.h"
+#include "MMsample.h"
+#include "MMtree.h"
+#include "MMthreads.h"
+#include "MMkernels.h"
+#include "MMdiff.h"
+#include "MMshard.h"
+#include "MMperf.h"
+#include "MMpipe.h"
+#include "MMfeasible.h"
+#include "MMtable.h"
+#include "MMdaemon.h"
+#include "MMspill.h"
+#include "MMprogress.h"
+#include "MMscan.h"
+#include "MMdag.h"
+#include "MMformat.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
-#include <unistd.h>
 
 
-// Program entry point and high level orchestration of activities
-int main( int argc, char **argv )
+// Validate a solution that has been opened (by setup or openSolution) - the high level orchestration of activities
+// This holds no state outside of the repository, so separate repositories can be validated on separate threads
+int validate( Repo* pRepo )
 {
-    Repo         repo;
     int          rc = 0;
 
-    // Use the parameters passed (or defaults) to define the puzzle that is to be solved
-    rc = setup( &repo, argc, argv ); if( rc ) return rc;    // Setup repository and access file for analysis
-    rc = parseHeader( &repo );       if( rc ) return rc;    // Check header and find max number of guesses
-    rc = countPegs( &repo );         if( rc ) return rc;    // Return the number of pegs in each code
-    rc = countCodes( &repo );        if( rc ) return rc;    // Return the number of codes listed in the solution file
-    rc = parseFile( &repo );         if( rc ) return rc;    // Read the whole file into data structures
-    rc = setupCodeDefs( &repo );     if( rc ) return rc;    // Can only set up code defs after we know the number of codes, pegs and colours
-    rc = setupMarks( &repo );        if( rc ) return rc;    // Can only set up the marks after we know the number of codes, pegs and colours
+    if( pRepo->clientName != NULL ) return runClient( pRepo ); // Have the daemon check the solution, and show its report
+    if( pRepo->daemonName != NULL ) return runDaemon( pRepo ); // Check solutions sent by clients, until told to stop
+    if( pRepo->benchName != NULL ) return benchTable( pRepo ); // Time lookups in a decision table - there is no solution to check
+    if( isDag( pRepo ) ) return dagCheck( pRepo );          // A strategy file written by --export-dag, rather than a solution
+    if( pRepo->diffName != NULL )
+        return diffSolutions( pRepo );                      // Compare the strategies of two solutions, rather than check one
+    if( pRepo->mergeCount > 0 ) return mergeShards( pRepo ); // Combine the partial results from each shard
+    if( pRepo->shards > 0 ) return shardCheck( pRepo );     // Check one shard of the file, for merging later
+    if( pRepo->failFast ) return gate( pRepo );             // Gating run - only interested in the first error
+    if( pRepo->sampleSize > 0 || pRepo->sampleRate > 0 )
+        return sampleCheck( pRepo );                        // Quick look - only check a random sample of lines
+    if( pRepo->outOfCore ) return spillCheck( pRepo );      // Too big for memory - check in sorted runs spilled to disk
+
+    rc = phase( pRepo, "parseHeader", parseHeader );       if( rc ) return rc;    // Check header and find max number of guesses
+    rc = phase( pRepo, "countPegs", countPegs );           if( rc ) return rc;    // Return the number of pegs in each code
+
+    if( canPipeline( pRepo ) )
+    {
+        rc = phase( pRepo, "pipeCheck", pipeCheck );           if( rc ) return rc;    // Read, parse, count turns and check marks, with each stage overlapping the next
+        rc = phase( pRepo, "setupCodeDefs", setupCodeDefs );   if( rc ) return rc;    // Code defs are only needed for reporting here
+        if( pRepo->checks & CHECK_CODES )
+        {
+            rc = phase( pRepo, "checkCodes", checkCodes ); if( rc ) return rc;  // Check all codes are there, and none repeated
+        }
+        if( pRepo->checks & CHECK_CONSISTENCY )
+        {
+            rc = phase( pRepo, "checkGuesses", checkGuesses ); if( rc ) return rc;  // Check that only one guess is made per group of codes
+        }
+    }
+    else
+    {
+        rc = phase( pRepo, "countCodes", countCodes );         if( rc ) return rc;    // Return the number of codes listed in the solution file
+        rc = phase( pRepo, "parseFile", parseFile );           if( rc ) return rc;    // Read the whole file into data structures
+        rc = phase( pRepo, "setupCodeDefs", setupCodeDefs );   if( rc ) return rc;    // Can only set up code defs after we know the number of codes, pegs and colours
 
-    rc = checkCodes( &repo );        if( rc ) return rc;    // Check all codes are there, and none repeated
-    rc = checkCounts( &repo );       if( rc ) return rc;    // Check all solutions end in all-black and that the counts of turns to solve is correct
-    rc = checkGuesses( &repo );      if( rc ) return rc;    // Check that only one guess is made per group of codes
-    rc = checkMarks( &repo );        if( rc ) return rc;    // Check that all the marking is correct
+        if( pRepo->replay )
+        {
+            rc = phase( pRepo, "checkCounts", checkCounts );   if( rc ) return rc;    // Check all solutions end in all-black and that the counts of turns to solve is correct
+            rc = phase( pRepo, "checkReplay", checkReplay );   if( rc ) return rc;    // Play every code through the strategy tree - checks codes, guesses and marks in one pass
+        }
+        else
+        {
+            // Only the chosen passes are run, and the marks are only set up if they are to be checked
+            // The turns taken are always counted, as the other passes (and the TTTS) depend on them
+            if( pRepo->checks & CHECK_MARKS )
+            {
+                rc = phase( pRepo, "setupMarks", setupMarks ); if( rc ) return rc;  // Can only set up the marks after we know the number of codes, pegs and colours
+            }
 
-    rc = report( &repo );            if( rc ) return rc;    // Output findings to stdout
+            if( pRepo->checks & CHECK_CODES )
+            {
+                rc = phase( pRepo, "checkCodes", checkCodes ); if( rc ) return rc;  // Check all codes are there, and none repeated
+            }
+            rc = phase( pRepo, "checkCounts", checkCounts );   if( rc ) return rc;    // Check all solutions end in all-black and that the counts of turns to solve is correct
+            if( pRepo->checks & CHECK_CONSISTENCY )
+            {
+                rc = phase( pRepo, "checkGuesses", checkGuesses ); if( rc ) return rc;  // Check that only one guess is made per group of codes
+            }
+            if( pRepo->checks & CHECK_MARKS )
+            {
+                rc = phase( pRepo, "checkMarks", checkMarks ); if( rc ) return rc;  // Check that all the marking is correct
+            }
+        }
+    }
+
+    if( pRepo->checks & CHECK_FEASIBILITY )
+    {
+        rc = phase( pRepo, "checkFeasibility", checkFeasibility ); if( rc ) return rc;  // Check guesses are bracketed exactly when they can't be the code
+    }
+    rc = skipChecks( pRepo );                              if( rc ) return rc;    // Passes not chosen are taken as passed
+
+    rc = phase( pRepo, "report", report );                 if( rc ) return rc;    // Output findings to the report stream (stdout unless told otherwise)
+    reportFeasibility( pRepo );                                                   // Candidate set sizes (--feasibility only)
+    if( pRepo->tableName != NULL )
+    {
+        rc = phase( pRepo, "exportTable", exportTable );   if( rc ) return rc;    // Write the strategy as a decision table, if it is valid
+    }
+    if( pRepo->dagName != NULL )
+    {
+        rc = phase( pRepo, "exportDag", exportDag );       if( rc ) return rc;    // Write the strategy as a compact strategy file, if it is valid
+    }
+    perfReport( pRepo );                                                          // What each phase used (--perf-counters only)
 
     return 0;    
 }
@@ -72,7 +154,7 @@ int parseHeader( Repo* pRepo )
             offset += fieldLen + 1;
             if( strcmp( field, "#" ) != 0 )
             {
-                fprintf( stderr, "Header line is incorrectly formatted - assuming file is corrupt\n" );
+                fprintf( pRepo->err, "Header line is incorrectly formatted - assuming file is corrupt\n" );
                 return -1;
             }
         }
@@ -82,7 +164,7 @@ int parseHeader( Repo* pRepo )
             offset += fieldLen + 1;
             if( strcmp( field, "Solution" ) != 0 )
             {
-                fprintf( stderr, "Header line is incorrectly formatted - assuming file is corrupt\n" );
+                fprintf( pRepo->err, "Header line is incorrectly formatted - assuming file is corrupt\n" );
                 return -1;
             }
         }
@@ -92,19 +174,19 @@ int parseHeader( Repo* pRepo )
             offset += fieldLen + 1;
             if( strcmp( field, "Turns" ) != 0 )
             {
-                fprintf( stderr, "Header line is incorrectly formatted - assuming file is corrupt\n" );
+                fprintf( pRepo->err, "Header line is incorrectly formatted - assuming file is corrupt\n" );
                 return -1;
             }
         }
         if( fields == ( fields / 2 ) * 2 )      // Not expecting an even number of fields
         {
-            fprintf( stderr, "Header line shows mismatched guesses and marks - assuming file is corrupt\n" );
+            fprintf( pRepo->err, "Header line shows mismatched guesses and marks - assuming file is corrupt\n" );
             return -1;
         }
 
         if( fields > 3 + 10 * 2 )               // Not expection more than 10 guesses
         {
-            fprintf( stderr, "Header line shows more guesses than expected - assuming file is corrupt\n" );
+            fprintf( pRepo->err, "Header line shows more guesses than expected - assuming file is corrupt\n" );
             return -1;
         }
 
@@ -144,19 +226,26 @@ int countPegs( Repo* pRepo )
 // We will also try to work out the number of colours in this puzzle
 int countCodes( Repo* pRepo )
 {
-    char   line[256];
-    int    colours = 0;
-    int    codes   = 0;
-    int    rc      = 0;
+    ScanFile scan;
+    ScanLine line;
+    int      colours = 0;
+    int      codes   = 0;
+    int      rc      = 0;
 
     // Count the actual number of codes reported in the solution output
     rc = fseek( pRepo->fp, 0, SEEK_SET );      // Go to the beginning of the file
     if( rc != 0 )
     {
-        fprintf( stderr, "Error running fseek in countCodes\n" );
+        fprintf( pRepo->err, "Error running fseek in countCodes\n" );
         return -1;
     }
-    while( getLine( pRepo->fp, line, 256 ) != EOF )  pRepo->actualCodes += 1;
+    rc = openScan( &scan, pRepo ); if( rc ) return rc;
+    while( scanLine( &scan, &line ) != EOF )
+    {
+        pRepo->actualCodes += 1;
+        progressCount( pRepo, 1, strlen( line.line ) + 1 );
+    }
+    closeScan( &scan );
     pRepo->actualCodes -= 1;    // Account for header line
 
     // Calculate the apparent number of colours and compare with what we may have read from the filename
@@ -171,6 +260,7 @@ int countCodes( Repo* pRepo )
     pRepo->codes = round( pow( pRepo->colours, pRepo->pegs ) );
     pRepo->codesOK = ( pRepo->codes == pRepo->actualCodes );
 
+    selectKernel( pRepo );
     return 0;
 }
 
@@ -179,265 +269,494 @@ int countCodes( Repo* pRepo )
 // Note that the header file will not be stored
 int parseFile( Repo* pRepo )
 {
-    char line[256];
-    char field[256];
-    int  fields   = 0;
-    int  offset   = 0;
-    int  code     = 0;
-    int  guesses  = 0;
-    int  fieldLen = 0;
-    bool done     = false;
-    int  allBlack = -1;
-    int  i        = 0;
-    int  j        = 0;
-    int  rc       = 0;
+    ScanFile scan;
+    ScanLine line;
+    int      fields   = 0;
+    int      i        = 0;
+    int      rc       = 0;
 
-    allBlack = ( pRepo->pegs * ( pRepo->pegs + 3 ) ) / 2 - 1;
+    rc = newSolutions( pRepo, pRepo->actualCodes ); if( rc ) return rc;
 
-    pRepo->data = malloc( sizeof(Solution) * pRepo->actualCodes );
-    if( pRepo->data == NULL )
+    rc = fseek( pRepo->fp, 0, SEEK_SET );      // Go to the beginning of the file
+    rc = openScan( &scan, pRepo ); if( rc ) return rc;
+
+    // Throw away header line
+    scanLine( &scan, &line );
+
+    for( i = 0; i < pRepo->actualCodes && rc == 0; i++ )
     {
-        fprintf( stderr, "Failed to create Solution array\n" );
-        return -1;
+        fields = scanLine( &scan, &line );
+        if( fields != EOF )
+        {
+            pRepo->data[i].line     = i;
+            pRepo->data[i].fileLine = line.number;
+            if( parseScanned( pRepo, &pRepo->data[i], &line ) != 0 )
+            {
+                if( pRepo->failFast ) rc = failLine( pRepo, line.number, line.line, "More guesses than expected" );
+                else
+                {
+                    fprintf( pRepo->err, "More guesses than expected\n" );
+                    rc = -1;
+                }
+                break;
+            }
+            progressCount( pRepo, 1, strlen( line.line ) + 1 );
+            progressProblems( pRepo, ! pRepo->data[i].codeOK + ! pRepo->data[i].guessesOK );
+
+            // When gating, check each line as soon as it is read, rather than waiting for the whole file
+            if( pRepo->failFast )
+            {
+                countTurns( pRepo, &pRepo->data[i] );
+                if( lineFault( pRepo, &pRepo->data[i] ) != NULL )
+                    rc = failLine( pRepo, line.number, line.line, lineFault( pRepo, &pRepo->data[i] ) );
+            }
+        }
+        else
+        {
+            fprintf( pRepo->err, "Problem with inconsistent code counts in parseFile\n" );
+            rc = -1;
+        }
     }
-    pRepo->missing = malloc( sizeof(Absent) * pRepo->codes );
-    if( pRepo->missing == NULL )
+
+    closeScan( &scan );
+    return rc;
+}
+
+// Create the array of solutions, with every solution (and its turns) set to a known starting state
+int newSolutions( Repo* pRepo, int count )
+{
+    int  rc       = 0;
+
+    pRepo->data = malloc( sizeof(Solution) * count );
+    if( pRepo->data == NULL )
     {
-        fprintf( stderr, "Failed to create Absent array\n" );
+        fprintf( pRepo->err, "Failed to create Solution array\n" );
         return -1;
     }
 
-    for( i = 0; i < pRepo->codes; i++ )
+    rc = initSolutions( pRepo, pRepo->data, count );
+    if( rc != 0 )
     {
-        pRepo->missing[i].code        = i;
-        pRepo->missing[i].codeMissing = true;
+        free( pRepo->data );
+        pRepo->data = NULL;
     }
+    return rc;
+}
 
-    for( i = 0; i < pRepo->actualCodes; i++ )
+// Set every solution in an array (and its turns) to a known starting state
+// If any of the turn arrays can't be allocated, those already allocated are freed again
+int initSolutions( Repo* pRepo, Solution* data, int count )
+{
+    int  i        = 0;
+    int  j        = 0;
+
+    for( i = 0; i < count; i++ )
     {
         // Parameters
-        pRepo->data[i].line            = -1;
-        pRepo->data[i].code            = -1;
-        pRepo->data[i].noTurns         = -1;
-        pRepo->data[i].actualNoTurns   = 99999;
+        data[i].line            = -1;
+        data[i].fileLine        = -1;
+        data[i].code            = -1;
+        data[i].noTurns         = -1;
+        data[i].actualNoTurns   = 99999;
         // Correctness flags
-        pRepo->data[i].codeOK          = false;     // Set either way, so need to prove its good
-        pRepo->data[i].codeRepeated    = true;      // Set either way, so need to prove its good
-        pRepo->data[i].turnsOK         = false;     // Set either way, so need to prove its good
-        pRepo->data[i].resolved        = false;     // Set if ok, so need to prove its good
-        pRepo->data[i].marksOK         = true;      // Only change if there's a problem, so start optimistically
-        pRepo->data[i].guessesOK       = false;     // Set either way, so need to prove its good
-        pRepo->data[i].guessConsistant = true;      // Only change if there's a problem, so start optimistically
-
-        pRepo->data[i].turns = malloc( sizeof(Turn) * pRepo->guesses );
-        if( pRepo->data[i].turns != NULL )
+        data[i].codeOK          = false;     // Set either way, so need to prove its good
+        data[i].codeRepeated    = true;      // Set either way, so need to prove its good
+        data[i].turnsOK         = false;     // Set either way, so need to prove its good
+        data[i].resolved        = false;     // Set if ok, so need to prove its good
+        data[i].marksOK         = true;      // Only change if there's a problem, so start optimistically
+        data[i].guessesOK       = false;     // Set either way, so need to prove its good
+        data[i].guessConsistant = true;      // Only change if there's a problem, so start optimistically
+        data[i].bracketsOK      = true;      // Only change if there's a problem, so start optimistically
+
+        data[i].turns = malloc( sizeof(Turn) * pRepo->guesses );
+        if( data[i].turns != NULL )
         {
             for( j = 0; j < pRepo->guesses; j++ )
             {
                 // Parameters
-                pRepo->data[i].turns[j].guess        = -1;
-                pRepo->data[i].turns[j].mark         = -1;
+                data[i].turns[j].guess        = -1;
+                data[i].turns[j].mark         = -1;
                 // Correctness flags
-                pRepo->data[i].turns[j].guessOK      = false;     // Set either way, so need to prove its good
-                pRepo->data[i].turns[j].markOK       = false;     // Set if ok, so need to prove its good
+                data[i].turns[j].guessOK      = false;     // Set either way, so need to prove its good
+                data[i].turns[j].markOK       = false;     // Set if ok, so need to prove its good
+                data[i].turns[j].bracketed    = false;
+                data[i].turns[j].bracketOK    = true;      // Only change if there's a problem, so start optimistically
             }
         }
         else
         {
-            fprintf( stderr, "Failed to create one of the Turn arrays\n" );
+            fprintf( pRepo->err, "Failed to create one of the Turn arrays\n" );
+            while( --i >= 0 ) free( data[i].turns );
             return -1;
         }
     }
 
-    rc = fseek( pRepo->fp, 0, SEEK_SET );      // Go to the beginning of the file
+    return 0;
+}
 
-    // Throw away header line
-    getLine( pRepo->fp, line, 256 );
+// Parse one line of the solution file (already split off by getLine, which also counted the fields)
+// Returns non-zero if the line has more guesses than the header allows for
+int parseLine( Repo* pRepo, Solution* pSoln, char* line, int fields )
+{
+    char field[256];
+    int  offset   = 0;
+    int  code     = 0;
+    int  guesses  = 0;
+    int  fieldLen = 0;
+    bool done     = false;
+    int  allBlack = -1;
+    int  j        = 0;
 
-    for( i = 0; i < pRepo->actualCodes; i++ )
+    allBlack = ( pRepo->pegs * ( pRepo->pegs + 3 ) ) / 2 - 1;
+
+    offset = 0;
+    if( fields >= 3 )
     {
-        fields = getLine( pRepo->fp, line, 256 );
-        if( fields != EOF )
+        fieldLen = nextField( line + offset, field, 256 );
+        offset += fieldLen + 1;
+        pSoln->code = stringToInt( field );
+
+        fieldLen = nextField( line + offset, field, 256 );
+        offset += fieldLen + 1;
+        code = parseCode( pRepo, field );
+        pSoln->codeOK = ( pSoln->code == code );
+
+        fieldLen = nextField( line + offset, field, 256 );
+        offset += fieldLen + 1;
+        pSoln->noTurns = stringToInt( field );
+    }
+
+    guesses = (fields - 3) / 2;
+    pSoln->guessesOK = ( guesses * 2 + 3 == fields );       // Must have pairs of fields (Guess + Mark)
+
+    if( guesses > pRepo->guesses )
+        return -1;
+
+    done = false;
+    for( j = 0; j < guesses && ! done; j++ )
+    {
+        fieldLen = nextField( line + offset, field, 256 );
+        if( fieldLen > 0 )
         {
-            pRepo->data[i].line = i;
-            offset = 0;
-            if( fields >= 3 )
+            offset += fieldLen + 1;
+            pSoln->turns[j].guess = parseCode( pRepo, field );
+            pSoln->turns[j].guessOK = ( pSoln->turns[j].guess != -1 );
+            pSoln->turns[j].bracketed = ( field[0] == '(' );
+
+            fieldLen = nextField( line + offset, field, 256 );
+            if( fieldLen > 0 )
             {
-                fieldLen = nextField( line + offset, field, 256 );
                 offset += fieldLen + 1;
-                pRepo->data[i].code = stringToInt( field );
+                pSoln->turns[j].mark = getMark( pRepo, field );
+                if( pSoln->turns[j].mark == allBlack || pSoln->turns[j].mark == -1 ) done = true;
+            }
+            else
+            {
+                done = true;
+            }
+        }
+        else
+        {
+            done = true;
+        }
 
-                fieldLen = nextField( line + offset, field, 256 );
-                offset += fieldLen + 1;
-                code = parseCode( pRepo, field );
-                pRepo->data[i].codeOK = ( pRepo->data[i].code == code );
+    }
+    return 0;
+}
 
-                fieldLen = nextField( line + offset, field, 256 );
-                offset += fieldLen + 1;
-                pRepo->data[i].noTurns = stringToInt( field );
-            }
+// Parse a line already split into its fields (by the scanner) - as parseLine, but reading each field where it is
+// Returns non-zero if the line has more guesses than the header allows for
+int parseFields( Repo* pRepo, Solution* pSoln, char** field, int fields )
+{
+    int  code     = 0;
+    int  guesses  = 0;
+    bool done     = false;
+    int  allBlack = -1;
+    int  j        = 0;
+
+    allBlack = ( pRepo->pegs * ( pRepo->pegs + 3 ) ) / 2 - 1;
+
+    if( fields >= 3 )
+    {
+        pSoln->code = stringToInt( field[0] );
+        code = parseCode( pRepo, field[1] );
+        pSoln->codeOK = ( pSoln->code == code );
+        pSoln->noTurns = stringToInt( field[2] );
+    }
+
+    guesses = (fields - 3) / 2;
+    pSoln->guessesOK = ( guesses * 2 + 3 == fields );       // Must have pairs of fields (Guess + Mark)
+
+    if( guesses > pRepo->guesses )
+        return -1;
 
-            guesses = (fields - 3) / 2;
-            pRepo->data[i].guessesOK = ( guesses * 2 + 3 == fields );       // Must have pairs of fields (Guess + Mark)
+    done = false;
+    for( j = 0; j < guesses && ! done; j++ )
+    {
+        if( field[3+2*j][0] != '\0' )
+        {
+            pSoln->turns[j].guess = parseCode( pRepo, field[3+2*j] );
+            pSoln->turns[j].guessOK = ( pSoln->turns[j].guess != -1 );
+            pSoln->turns[j].bracketed = ( field[3+2*j][0] == '(' );
 
-            if( guesses > pRepo->guesses )
+            if( field[4+2*j][0] != '\0' )
             {
-                fprintf( stderr, "More guesses than expected\n" );
-                return -1;
+                pSoln->turns[j].mark = getMark( pRepo, field[4+2*j] );
+                if( pSoln->turns[j].mark == allBlack || pSoln->turns[j].mark == -1 ) done = true;
             }
-
-            done = false;
-            for( j = 0; j < guesses && ! done; j++ )
+            else
             {
-                fieldLen = nextField( line + offset, field, 256 );
-                if( fieldLen > 0 )
-                {
-                    offset += fieldLen + 1;
-                    pRepo->data[i].turns[j].guess = parseCode( pRepo, field );
-                    pRepo->data[i].turns[j].guessOK = ( pRepo->data[i].turns[j].guess != -1 );
-
-                    fieldLen = nextField( line + offset, field, 256 );
-                    if( fieldLen > 0 )
-                    {
-                        offset += fieldLen + 1;
-                        pRepo->data[i].turns[j].mark = getMark( pRepo, field );
-                        if( pRepo->data[i].turns[j].mark == allBlack || pRepo->data[i].turns[j].mark == -1 ) done = true;
-                    }
-                    else
-                    {
-                        done = true;
-                    }
-                }
-                else
-                {
-                    done = true;
-                }
-
+                done = true;
             }
         }
         else
         {
-            fprintf( stderr, "Problem with inconsistent code counts in parseFile\n" );
-            return -1;
+            done = true;
         }
     }
-
     return 0;
 }
 
 // Check all codes are there, and none repeated
+// Each code is marked off in a bitmap of codes seen, with a second bitmap catching any code seen more than once
+// This is one pass over the lines (in parallel) - there is no need to sort
 int checkCodes( Repo* pRepo )
 {
-    int priorCode = 0;
-    int expectedCode = 0;
-    int i        = 0;
-    int j        = 0;
+    bool      repeats = false;
+    uint64_t* claimed = NULL;
+    int       code    = 0;
+    int       w       = 0;
+    int       i       = 0;
+    int       rc      = 0;
 
-    // Sort into code order
-    qsort( pRepo->data, pRepo->actualCodes, sizeof(Solution), cmpCodeOrder );
-    for( i = 0; i < pRepo->actualCodes; i++ )
+    rc = newCodeMaps( pRepo ); if( rc ) return rc;
+    rc = runParallel( pRepo, pRepo->actualCodes, seeCodes, NULL ); if( rc ) return rc;
+
+    for( w = 0; w < bitmapWords( pRepo->codes ) && ! repeats; w++ )
+        if( pRepo->repeat[w] != 0 ) repeats = true;
+
+    // Only the first line (in file order) showing a repeated code escapes being flagged as a repeat
+    if( repeats )
     {
-        if( pRepo->data[i].code == expectedCode )
+        claimed = (uint64_t*)calloc( bitmapWords( pRepo->codes ), sizeof(uint64_t) );
+        if( claimed == NULL )
         {
-            pRepo->data[i].codeRepeated = false;
+            fprintf( pRepo->err, "Failed to create code bitmap\n" );
+            return -1;
         }
-        else if( pRepo->data[i].code == priorCode )
+        for( i = 0; i < pRepo->actualCodes; i++ )
         {
-            pRepo->data[i].codeRepeated = true;
+            code = pRepo->data[i].code;
+            if( code < 0 || code >= pRepo->codes || ! testBit( pRepo->repeat, code ) )
+                continue;
+            if( testBit( claimed, code ) )
+                pRepo->data[i].codeRepeated = true;
+            else
+                setBit( claimed, code );
         }
-        else if( pRepo->data[i].code > expectedCode )
+        free( claimed );
+    }
+
+    pRepo->missingCodes = countMissing( pRepo );
+    return 0;
+}
+
+// Mark off the codes shown on lines [from, to) in the seen bitmap
+// Bits are set atomically, so blocks of lines can be worked through on separate threads
+// A code that was already seen is marked in the repeat bitmap
+void seeCodes( Repo* pRepo, int from, int to, void* arg )
+{
+    int code    = 0;
+    int repeats = 0;
+    int i       = 0;
+
+    (void)arg;
+    for( i = from; i < to; i++ )
+    {
+        code = pRepo->data[i].code;
+        pRepo->data[i].codeRepeated = false;
+        if( code < 0 || code >= pRepo->codes ) continue;
+        if( atomicSetBit( pRepo->seen, code ) )
         {
-            for( j = expectedCode; j < pRepo->data[i].code; j++ )
-            {
-                pRepo->missing[j].codeMissing = true;
-                pRepo->data[j].codeRepeated = false;
-            }
-            pRepo->data[i].codeRepeated = false;
+            atomicSetBit( pRepo->repeat, code );
+            repeats += 1;
         }
-        expectedCode = pRepo->data[i].code + 1;
-        priorCode = pRepo->data[i].code;
-
-        // Mark off each code we've seen
-        if( priorCode < pRepo->codes )
-            pRepo->missing[priorCode].codeMissing = false;
+    }
+    progressCount( pRepo, to - from, 0 );
+    progressProblems( pRepo, repeats );
+}
 
+// Set up empty bitmaps of codes seen and repeated
+// Bits past the last code are set in the seen bitmap, so they never show as missing
+int newCodeMaps( Repo* pRepo )
+{
+    int words = bitmapWords( pRepo->codes );
+    int code  = 0;
+
+    free( pRepo->seen );
+    free( pRepo->repeat );
+    pRepo->seen   = (uint64_t*)calloc( words, sizeof(uint64_t) );
+    pRepo->repeat = (uint64_t*)calloc( words, sizeof(uint64_t) );
+    if( pRepo->seen == NULL || pRepo->repeat == NULL )
+    {
+        fprintf( pRepo->err, "Failed to create code bitmaps\n" );
+        return -1;
     }
+    for( code = pRepo->codes; code < words * 64; code++ )
+        setBit( pRepo->seen, code );
+
     return 0;
 }
 
+// Count the codes not seen
+int countMissing( Repo* pRepo )
+{
+    int missing = 0;
+    int w       = 0;
+
+    for( w = 0; w < bitmapWords( pRepo->codes ); w++ )
+        missing += __builtin_popcountll( ~pRepo->seen[w] );
+
+    return missing;
+}
+
 // Check all solutions end in all-black and that the counts of turns to solve is correct
 int checkCounts( Repo* pRepo )
+{
+    int  i        = 0;
+
+    for( i = 0; i < pRepo->actualCodes; i++ )
+    {
+        countTurns( pRepo, &pRepo->data[i] );
+        progressCount( pRepo, 1, 0 );
+        progressProblems( pRepo, ! pRepo->data[i].turnsOK + ! pRepo->data[i].resolved );
+    }
+
+    return 0;
+}
+
+// Check a single solution ends in all-black and that the count of turns to solve is correct
+int countTurns( Repo* pRepo, Solution* pSoln )
 {
     int  allBlack = 0;
     bool done     = false;
-    int  i        = 0;
     int  g        = 0;
 
     // Calculate what mark represents sucess
     allBlack = ( pRepo->pegs * ( pRepo->pegs + 3 ) ) / 2 - 1;
 
-    for( i = 0; i < pRepo->actualCodes; i++ )
+    for( g = 0; g < pRepo->guesses && ! done; g++ )
     {
-        done = false;
-        for( g = 0; g < pRepo->guesses && ! done; g++ )
+        if( pSoln->turns[g].mark == allBlack )
         {
-            if( pRepo->data[i].turns[g].mark == allBlack )
-            {
-                pRepo->data[i].turnsOK = ( pRepo->data[i].noTurns == g + 1 );
-                pRepo->data[i].actualNoTurns = g + 1;
-                pRepo->data[i].resolved = true;
-                done = true;
-            }
-            else if( pRepo->data[i].turns[g].mark == -1 )
-            {
-                pRepo->data[i].turnsOK = ( pRepo->data[i].noTurns == g );
-                pRepo->data[i].actualNoTurns = g;
-                pRepo->data[i].resolved = false;
-                done = true;
-            }
+            pSoln->turnsOK = ( pSoln->noTurns == g + 1 );
+            pSoln->actualNoTurns = g + 1;
+            pSoln->resolved = true;
+            done = true;
+        }
+        else if( pSoln->turns[g].mark == -1 )
+        {
+            pSoln->turnsOK = ( pSoln->noTurns == g );
+            pSoln->actualNoTurns = g;
+            pSoln->resolved = false;
+            done = true;
         }
     }
     return 0;
 }
 
 // Check that only one guess is made per group of codes
+// Once in mark order, each solution is compared with the one before it - so blocks of the order are checked in parallel
 int checkGuesses( Repo* pRepo )
 {
-    int  code      = 0;
-    int  level     = 0;
-    int  lastMark  = 0;
-    int  lastGuess = 0;
-    int  prevGuess = 0;
-    int  allBlack  = 0;
-    int  i         = 0;
+    int*      order     = NULL;
+    int       rc        = 0;
 
-    // Sort into mark order
-    qsort( pRepo->data, pRepo->actualCodes, sizeof(Solution), cmpMarkOrder );
+    if( pRepo->actualCodes == 0 ) return 0;
 
-    // Calculate what mark represents sucess
-    allBlack = ( pRepo->pegs * ( pRepo->pegs + 3 ) ) / 2 - 1;
+    // Index the solutions in mark order - the solutions themselves stay in file order
+    order = (int*)malloc( sizeof(int) * pRepo->actualCodes );
+    if( order == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate array in checkGuesses\n" );
+        return -1;
+    }
+    rc = sortByMarks( pRepo, order );
+    if( rc == 0 )
+        rc = runParallel( pRepo, pRepo->actualCodes, compareGuesses, order );
 
-    // Check that the same guess was made for every code at first level
-    prevGuess = pRepo->data[0].turns[0].guess;
-    for( i = 1; i < pRepo->actualCodes; i++ )
-        if( pRepo->data[i].turns[0].guess != prevGuess ) pRepo->data[i].guessConsistant = false;
+    free( order );
+    return rc;
+}
 
-    // Now check eery guess at other levels
-    for( i = 1; i < pRepo->actualCodes; i++ )
+// Compare the guesses of solutions [from, to) of the mark order with those of the solution before each
+// Only the later solution of each pair is flagged, so every block gives the same flags as one pass over the whole order
+void compareGuesses( Repo* pRepo, int from, int to, void* arg )
+{
+    Solution* pSoln     = NULL;
+    Solution* pPrev     = NULL;
+    int*      order     = (int*)arg;
+    int       level     = 0;
+    int       problems  = 0;
+    int       i         = 0;
+
+    for( i = from > 0 ? from : 1; i < to; i++ )
     {
+        pSoln = &pRepo->data[order[i]];
+        pPrev = &pRepo->data[order[i-1]];
+
+        // The same guess must be made for every code at first level
+        if( pSoln->turns[0].guess != pRepo->data[order[0]].turns[0].guess ) pSoln->guessConsistant = false;
+
         // Look at each level and if the previous guesses and marks were the same - this guess must be the same
-        for( level = 1; level < pRepo->data[i].actualNoTurns; level++ )
+        for( level = 1; level < pSoln->actualNoTurns && level < pRepo->guesses; level++ )
         {
-            lastMark  = pRepo->data[i-1].turns[level-1].mark;
-            lastGuess = pRepo->data[i-1].turns[level-1].guess;
-            if( pRepo->data[i].turns[level-1].mark == lastMark && pRepo->data[i].turns[level-1].guess == lastGuess )
+            if( pSoln->turns[level-1].mark == pPrev->turns[level-1].mark && pSoln->turns[level-1].guess == pPrev->turns[level-1].guess )
             {
-                prevGuess = pRepo->data[i-1].turns[level].guess;
-                if( pRepo->data[i].turns[level].guess != prevGuess )
-                    pRepo->data[i].guessConsistant = false;
+                if( pSoln->turns[level].guess != pPrev->turns[level].guess )
+                    pSoln->guessConsistant = false;
             }
 
         }
+        problems += ! pSoln->guessConsistant;
+    }
+    progressCount( pRepo, to - from, 0 );
+    progressProblems( pRepo, problems );
+}
+
+// Passes that were not chosen (--checks) are taken as passed, so only the chosen ones can report problems
+// The report says which passes were run, so this is not mistaken for a full check
+// The turns are always counted, so their flags are only cleared here
+int skipChecks( Repo* pRepo )
+{
+    Solution* pSoln = NULL;
+    int       i     = 0;
+    int       g     = 0;
+
+    if( ! ( pRepo->checks & CHECK_CODES ) )
+    {
+        pRepo->codesOK      = true;
+        pRepo->missingCodes = 0;
+    }
+
+    for( i = 0; i < pRepo->actualCodes; i++ )
+    {
+        pSoln = &pRepo->data[i];
+        if( ! ( pRepo->checks & CHECK_CODES ) )
+        {
+            pSoln->codeOK       = true;
+            pSoln->codeRepeated = false;
+        }
+        if( ! ( pRepo->checks & CHECK_COUNTS ) )
+        {
+            pSoln->turnsOK  = true;
+            pSoln->resolved = true;
+        }
+        if( ! ( pRepo->checks & CHECK_MARKS ) )
+        {
+            pSoln->marksOK = true;
+            for( g = 0; g < pRepo->guesses; g++ ) pSoln->turns[g].markOK = true;
+        }
     }
     return 0;
 }
@@ -456,64 +775,51 @@ int checkMarks( Repo* pRepo )
             mark = marking( pRepo, pRepo->data[i].code, pRepo->data[i].turns[g].guess );
             if( pRepo->data[i].turns[g].mark == mark )
                 pRepo->data[i].turns[g].markOK = true;
+            else if( pRepo->failFast )
+                return failLine( pRepo, pRepo->data[i].fileLine, NULL, "Mark(s) wrong" );
+            else
+                progressProblems( pRepo, 1 );
         }
+        progressCount( pRepo, 1, 0 );
     }
     return 0;
 }
 
 int report( Repo* pRepo )
 {
-    bool  fileError     = false;
-    bool  solutionError = false;
-    bool* solnErrIndex  = NULL;
-    bool  guessError    = false;
-    char  buffer[15];
-    char  line[256];
-    FILE* fpo           = NULL;
-    int   len           = 0;
-    int   TTTS          = 0;
-    int   i             = 0;
-    int   j             = 0;
+    ScanFile scan;
+    ScanLine line;
+    OutBuf   out;
+    bool     fileError     = false;
+    bool     solutionError = false;
+    bool*    solnErrIndex  = NULL;
+    bool     partial       = ( pRepo->checks & CHECK_DEFAULT ) != CHECK_DEFAULT;   // Were any of the usual passes left out?
+    FILE*    fpo           = NULL;
+    char     checks[64];
+    int      TTTS          = 0;
+    int      i             = 0;
+    int      rc            = 0;
 
     solnErrIndex = (bool*)malloc( sizeof(bool) * pRepo->actualCodes );
     if( solnErrIndex == NULL )
     {
-        fprintf( stderr, "Failed to allocate array in report function\n" );
+        fprintf( pRepo->err, "Failed to allocate array in report function\n" );
         return -1;
     }
 
-    // Put solutions back into original order
-    qsort( pRepo->data, pRepo->actualCodes, sizeof(Solution), cmpLineOrder );
-    qsort( pRepo->missing, pRepo->codes, sizeof(Absent), cmpAbsentOrder );
-
     // Write header for stdout status
-    fprintf( stdout, "\nAnalysis of %s:   ", pRepo->baseName );
+    say( pRepo, "\nAnalysis of %s:   ", pRepo->baseName );
 
     // Work out if there are any top level problems
-    if( ! pRepo->pegsOK || ! pRepo->coloursOK || ! pRepo->codesOK || pRepo->missing[0].codeMissing )
+    if( ! pRepo->pegsOK || ! pRepo->coloursOK || ! pRepo->codesOK || pRepo->missingCodes > 0 )
         fileError = true;
 
     // Now work out if there are any solution level problems
     for( i = 0; i < pRepo->actualCodes; i++ )
     {
-        solnErrIndex[i] = false;
-
-        if(    ! pRepo->data[i].codeOK   ||   pRepo->data[i].codeRepeated || ! pRepo->data[i].turnsOK
-            || ! pRepo->data[i].resolved || ! pRepo->data[i].marksOK      || ! pRepo->data[i].guessesOK || ! pRepo->data[i].guessConsistant
-          )
-        {
-            solnErrIndex[i] = true;
+        solnErrIndex[i] = solutionFault( pRepo, &pRepo->data[i] );
+        if( solnErrIndex[i] )
             solutionError = true;
-        }
-        else
-        {
-            for( j = 0; j < pRepo->data[i].actualNoTurns; j++ )
-                if( ! pRepo->data[i].turns[j].guessOK || ! pRepo->data[i].turns[j].markOK )
-                {
-                    solnErrIndex[i] = true;
-                    solutionError = true;
-                }
-        }
     }
 
     // Hopefully no problems...
@@ -521,115 +827,276 @@ int report( Repo* pRepo )
     {
         for( i = 0; i < pRepo->actualCodes; i++ )
             TTTS += pRepo->data[i].noTurns;
-        fprintf( stdout, "No errors found.  TTTS = %d\n\n", TTTS );
+        if( partial )
+            say( pRepo, "No errors found (checks: %s).  TTTS = %d\n\n", printChecks( pRepo->checks, checks ), TTTS );
+        else
+            say( pRepo, "No errors found.  TTTS = %d\n\n", TTTS );
+        free( solnErrIndex );
         return 0;
     }
 
     // If there are high level problems - write the details to stdout
     if( fileError )
-    {
-        fprintf( stdout, "\n" );
-        if( ! pRepo->pegsOK || ! pRepo->coloursOK )
-            fprintf( stdout, "Inconsistent numbers of Pegs/Colours between filename and solution (Ignoring filename)\n" );
-
-        if( ! pRepo->codesOK )
-        {
-            fprintf( stdout, "Unexpected number of codes shown in solution\n" );
-            fprintf( stdout, "Expecting %d codes, actually output %d codes\n", pRepo->codes, pRepo->actualCodes );
-        }
+        reportFileErrors( pRepo );
 
-        if( pRepo->missing[0].codeMissing )
-        {
-            fprintf( stdout, "The following code(s) were not shown in the solution file\n" );
-            fprintf( stdout, "  %s", printCode( pRepo, pRepo->missing[0].code, true, buffer ) );
-            for( i = 1; pRepo->missing[i].codeMissing; i++ )
-                fprintf( stdout, ",%s", printCode( pRepo, pRepo->missing[i].code, true, buffer ) );
-            fprintf( stdout, "\n" );
-        }
+    if( solutionError && ! pRepo->errorsFile )
+    {
+        say( pRepo, "solution level errors\n" );
     }
-
-    if( solutionError )
+    else if( solutionError )
     {
-        // Change directory and also set up output filename
-        if( chdir( pRepo->dirName ) != 0 )
-        {
-            fprintf( stderr, "Can't change to directory %s\n", pRepo->dirName );
-            return -1;
-        }
-
-        strcpy( pRepo->outputName, pRepo->filename );
-        len = strlen( pRepo->outputName );
-        if( pRepo->outputName[len-4] == '.' && pRepo->outputName[len-3] == 'c' && pRepo->outputName[len-2] == 's' && pRepo->outputName[len-1] == 'v' )
-        {
-            strcpy( pRepo->outputName + len - 4, "_ERRORS.csv" );
-        }
-        else
-        {
-            fprintf( stderr, "Filename does not have the expected extension (.csv) - output to ERRORS.csv (may overwrite)\n" );
-            strcpy( pRepo->outputName, "ERRORS.csv" );
-        }
-        fpo = fopen( pRepo->outputName, "w" );
+        fpo = openErrorsFile( pRepo );
         if( fpo == NULL )
         {
-            fprintf( stderr, "Unable to open file: %s\n", pRepo->outputName );
-            fprintf( stderr, "Solution errors - but unable to output details\n" );
+            free( solnErrIndex );
             return -1;
         }
 
-        // Tell stdout that there's an error file - and what it's called
-        fprintf( stdout, "solution level errors - details in %s\n", pRepo->outputName );
-
         // Now merge the input file with errors found
+        // The rows are gathered into a large buffer, so the file is written a buffer at a time
         fseek( pRepo->fp, 0, SEEK_SET );      // Go to the beginning of the solution file
-
-        getLine( pRepo->fp, line, 256 );
-        fprintf( fpo, "Status,Issues,%s\n", line );  // Write header
-
-        for( i = 0; i < pRepo->actualCodes; i++ )
+        rc = openScan( &scan, pRepo );
+        if( rc == 0 )
         {
-            getLine( pRepo->fp, line, 256 );
-            if( ! solnErrIndex[i] )
-            {
-                fprintf( fpo, "OK,,%s\n", line );  // Say it's ok - then add original line
-            }
-            else
+            rc = openOut( &out, pRepo, fpo );
+            if( rc == 0 )
             {
-                fprintf( fpo, "ERR," );            // Say there's an error, then add details
-                if( ! pRepo->data[i].codeOK )           fprintf( fpo, "Code and Rep don't match " );
-                if( pRepo->data[i].codeRepeated )       fprintf( fpo, "Repeated " );
-                if( ! pRepo->data[i].turnsOK )          fprintf( fpo, "Turns incorrect " );
-                if( ! pRepo->data[i].resolved )         fprintf( fpo, "Not resolved " );
-                if( ! pRepo->data[i].marksOK )          fprintf( fpo, "Mark(s) wrong " );
-                if( ! pRepo->data[i].guessesOK )        fprintf( fpo, "Guess/mark issue " );
-                if( ! pRepo->data[i].guessConsistant )  fprintf( fpo, "Inconsistent guesses " );
-
-                fprintf( fpo, ",%s\n", line );  // Finish with original line
-
-                guessError = false;
-                for( j = 0; j < pRepo->data[i].actualNoTurns; j++ )
-                    if( ! pRepo->data[i].turns[j].guessOK || ! pRepo->data[i].turns[j].markOK )
-                        guessError = true;
-                if( guessError )
+                if( scanLine( &scan, &line ) == EOF ) line.line[0] = '\0';
+                putText( &out, "Status,Issues,", 14 );  // Write header
+                putString( &out, line.line );
+                putChar( &out, '\n' );
+
+                for( i = 0; i < pRepo->actualCodes; i++ )
                 {
-                    fprintf( fpo, ",,,,," );  // Step over initial fields
-                    for( j = 0; j < pRepo->data[i].actualNoTurns; j++ )
-                    {
-                        if( ! pRepo->data[i].turns[j].guessOK ) fprintf( fpo, "Prob," ); else fprintf( fpo, "," ); 
-                        if( ! pRepo->data[i].turns[j].markOK )  fprintf( fpo, "Prob," ); else fprintf( fpo, "," );
-                    }
-                    fprintf( fpo, "\n" );
+                    if( scanLine( &scan, &line ) == EOF ) line.line[0] = '\0';
+                    writeErrorRow( &out, &pRepo->data[i], line.line, solnErrIndex[i] );
                 }
+                if( closeOut( &out ) ) fprintf( pRepo->err, "Unable to write all of %s\n", pRepo->outputName );
             }
+            closeScan( &scan );
         }
         fclose( fpo );
     }
-    fprintf( stdout, "\n" );
+    if( partial ) say( pRepo, "Only these checks were run: %s\n", printChecks( pRepo->checks, checks ) );
+    say( pRepo, "\n" );
     free( solnErrIndex );
     solnErrIndex = NULL;
 
+    return rc;
+}
+
+// Say what is wrong with the file as a whole - the numbers of pegs, colours and codes, and any codes not shown
+void reportFileErrors( Repo* pRepo )
+{
+    say( pRepo, "\n" );
+    if( ! pRepo->pegsOK || ! pRepo->coloursOK )
+        say( pRepo, "Inconsistent numbers of Pegs/Colours between filename and solution (Ignoring filename)\n" );
+
+    if( ! pRepo->codesOK )
+    {
+        say( pRepo, "Unexpected number of codes shown in solution\n" );
+        say( pRepo, "Expecting %d codes, actually output %d codes\n", pRepo->codes, pRepo->actualCodes );
+    }
+
+    if( pRepo->missingCodes > 0 )
+    {
+        // List the codes not seen - each clear bit
+        say( pRepo, "The following code(s) were not shown in the solution file\n" );
+        listCodes( pRepo, pRepo->seen, true );
+    }
+}
+
+// Open the _ERRORS.csv file alongside the solution file, and say where it is
+// Returns NULL if it can't be opened
+FILE* openErrorsFile( Repo* pRepo )
+{
+    FILE* fpo = NULL;
+    int   len = 0;
+
+    // Set up output filename - alongside the solution file
+    // (The directory is not changed, as that would affect anything else running in this process)
+    snprintf( pRepo->outputName, 256, "%s", pRepo->filename );
+    len = strlen( pRepo->outputName );
+    if( len >= 4 && len + 7 < 256 && strcmp( pRepo->outputName + len - 4, ".csv" ) == 0 )
+    {
+        strcpy( pRepo->outputName + len - 4, "_ERRORS.csv" );
+    }
+    else
+    {
+        fprintf( pRepo->err, "Filename does not have the expected extension (.csv) - output to ERRORS.csv (may overwrite)\n" );
+        if( pRepo->dirName[0] != '\0' )
+            snprintf( pRepo->outputName, 256, "%s/ERRORS.csv", pRepo->dirName );
+        else
+            strcpy( pRepo->outputName, "ERRORS.csv" );
+    }
+    fpo = fopen( pRepo->outputName, "w" );
+    if( fpo == NULL )
+    {
+        fprintf( pRepo->err, "Unable to open file: %s\n", pRepo->outputName );
+        fprintf( pRepo->err, "Solution errors - but unable to output details\n" );
+        return NULL;
+    }
+
+    // Tell stdout that there's an error file - and what it's called
+    say( pRepo, "solution level errors - details in %s\n", pRepo->outputName );
+    return fpo;
+}
+
+// Write a line of the solution to the _ERRORS.csv file - marked OK, or with its problems and where in the line they are
+void writeErrorRow( OutBuf* pOut, Solution* pSoln, char* line, bool fault )
+{
+    bool guessError = false;
+    int  j          = 0;
+
+    if( ! fault )
+    {
+        putText( pOut, "OK,,", 4 );     // Say it's ok - then add original line
+        putString( pOut, line );
+        putChar( pOut, '\n' );
+        return;
+    }
+
+    putText( pOut, "ERR,", 4 );        // Say there's an error, then add details
+    if( ! pSoln->codeOK )           putString( pOut, "Code and Rep don't match " );
+    if( pSoln->codeRepeated )       putString( pOut, "Repeated " );
+    if( ! pSoln->turnsOK )          putString( pOut, "Turns incorrect " );
+    if( ! pSoln->resolved )         putString( pOut, "Not resolved " );
+    if( ! pSoln->marksOK )          putString( pOut, "Mark(s) wrong " );
+    if( ! pSoln->guessesOK )        putString( pOut, "Guess/mark issue " );
+    if( ! pSoln->guessConsistant )  putString( pOut, "Inconsistent guesses " );
+    if( ! pSoln->bracketsOK )       putString( pOut, "Brackets wrong " );
+
+    putChar( pOut, ',' );              // Finish with original line
+    putString( pOut, line );
+    putChar( pOut, '\n' );
+
+    for( j = 0; j < pSoln->actualNoTurns; j++ )
+        if( ! pSoln->turns[j].guessOK || ! pSoln->turns[j].markOK || ! pSoln->turns[j].bracketOK )
+            guessError = true;
+    if( guessError )
+    {
+        putText( pOut, ",,,,,", 5 );   // Step over initial fields
+        for( j = 0; j < pSoln->actualNoTurns; j++ )
+        {
+            if( ! pSoln->turns[j].guessOK || ! pSoln->turns[j].bracketOK ) putText( pOut, "Prob,", 5 ); else putChar( pOut, ',' );
+            if( ! pSoln->turns[j].markOK )  putText( pOut, "Prob,", 5 ); else putChar( pOut, ',' );
+        }
+        putChar( pOut, '\n' );
+    }
+}
+
+// Gating run - stop at the first error of any kind and return FAIL_FAST_RC
+// The checks are run cheapest first, so that a broken file is rejected as early as possible
+// Each line is checked as it is parsed, and the mark tables are only built once everything else has passed
+int gate( Repo* pRepo )
+{
+    int  first = -1;
+    int  i     = 0;
+    int  rc    = 0;
+
+    // Header and overall shape of the file
+    rc = parseHeader( pRepo );       if( rc ) return failLine( pRepo, 1, NULL, "Header line is incorrectly formatted" );
+    rc = countPegs( pRepo );         if( rc ) return rc;
+    if( ! pRepo->pegsOK )                     return failFile( pRepo, "Inconsistent numbers of Pegs between filename and solution" );
+    rc = countCodes( pRepo );        if( rc ) return rc;
+    if( ! pRepo->coloursOK )                  return failFile( pRepo, "Inconsistent numbers of Colours between filename and solution" );
+    if( ! pRepo->codesOK )                    return failFile( pRepo, "Unexpected number of codes shown in solution" );
+
+    // Codes, guess/mark format, turn counts and resolution are checked line by line as the file is read
+    // A file that can't be read through is a failure too (the problem has been reported already)
+    rc = parseFile( pRepo );         if( rc == FAIL_FAST_RC ) return rc;
+    if( rc )                                  return failFile( pRepo, "The solution file could not be read" );
+
+    // Repeated and missing codes
+    rc = checkCodes( pRepo );        if( rc ) return rc;
+    for( i = 0; i < pRepo->actualCodes; i++ )
+        if( pRepo->data[i].codeRepeated && ( first == -1 || pRepo->data[i].line < pRepo->data[first].line ) )
+            first = i;
+    if( first != -1 )                         return failLine( pRepo, pRepo->data[first].fileLine, NULL, "Repeated" );
+    if( pRepo->missingCodes > 0 )             return failFile( pRepo, "Code(s) not shown in the solution file" );
+
+    // Consistency of guesses between lines
+    rc = checkGuesses( pRepo );      if( rc ) return rc;
+    for( i = 0; i < pRepo->actualCodes; i++ )
+        if( ! pRepo->data[i].guessConsistant && ( first == -1 || pRepo->data[i].line < pRepo->data[first].line ) )
+            first = i;
+    if( first != -1 )                         return failLine( pRepo, pRepo->data[first].fileLine, NULL, "Inconsistent guesses" );
+
+    // Finally the marks, which are the only checks needing the (expensive) mark tables
+    rc = setupCodeDefs( pRepo );     if( rc ) return rc;
+    rc = setupMarks( pRepo );        if( rc ) return rc;
+    rc = checkMarks( pRepo );        if( rc ) return rc;
+
+    say( pRepo, "\nAnalysis of %s:   No errors found.\n\n", pRepo->baseName );
     return 0;
 }
 
+// Does this solution have an error of any kind?
+bool solutionFault( Repo* pRepo, Solution* pSoln )
+{
+    int  j = 0;
+
+    (void)pRepo;
+    if(    ! pSoln->codeOK   ||   pSoln->codeRepeated || ! pSoln->turnsOK
+        || ! pSoln->resolved || ! pSoln->marksOK      || ! pSoln->guessesOK || ! pSoln->guessConsistant
+        || ! pSoln->bracketsOK
+      )
+        return true;
+
+    for( j = 0; j < pSoln->actualNoTurns; j++ )
+        if( ! pSoln->turns[j].guessOK || ! pSoln->turns[j].markOK )
+            return true;
+
+    return false;
+}
+
+// Describe the first problem with a solution that can be seen from its own line alone
+// (ie not repeats, consistency with other lines or marking)
+// Returns NULL if there is no such problem
+char* lineFault( Repo* pRepo, Solution* pSoln )
+{
+    int  j = 0;
+
+    if( ! pSoln->codeOK )    return "Code and Rep don't match";
+    if( ! pSoln->guessesOK ) return "Guess/mark issue";
+    for( j = 0; j < pSoln->actualNoTurns && j < pRepo->guesses; j++ )
+        if( ! pSoln->turns[j].guessOK ) return "Guess/mark issue";
+    if( ! pSoln->resolved )  return "Not resolved";
+    if( ! pSoln->turnsOK )   return "Turns incorrect";
+
+    return NULL;
+}
+
+// Fail-fast report of a problem with the file as a whole
+int failFile( Repo* pRepo, char* reason )
+{
+    say( pRepo, "\nAnalysis of %s:   Failed - %s\n\n", pRepo->baseName, reason );
+    return FAIL_FAST_RC;
+}
+
+// Fail-fast report of the first offending line
+// Lines are numbered as in the file (from 1 - the header - with any blank lines counted)
+// If the text of the line is not to hand, it is read back from the file
+int failLine( Repo* pRepo, int line, char* text, char* reason )
+{
+    char buffer[256];
+    int  c = 0;
+    int  i = 0;
+
+    if( text == NULL )
+    {
+        fseek( pRepo->fp, 0, SEEK_SET );
+        for( i = 1; i < line; i++ )
+            while( ( c = getc( pRepo->fp ) ) != '\n' && c != EOF );
+        getLine( pRepo->fp, buffer, 256 );
+        text = buffer;
+    }
+
+    say( pRepo, "\nAnalysis of %s:   Failed - %s\n", pRepo->baseName, reason );
+    say( pRepo, "  Line %d: %s\n\n", line, text );
+    return FAIL_FAST_RC;
+}
+
 // Reverse calculate the numeric code from a text based representation
 // Note that the codes are displayed with the post significant value to the right
 // The code may also have backets around it (to show that it is not in the code list)
@@ -644,9 +1111,11 @@ int parseCode( Repo* pRepo, char* szCode )
         offset = 1;
     if( strlen( szCode ) != pRepo->pegs + offset * 2 )
     {
-        fprintf( stderr, "Wrong number of pegs in code\n" );
+        fprintf( pRepo->err, "Wrong number of pegs in code\n" );
         return -1;
     }
+    if( pRepo->kernel != NULL )
+        return pRepo->kernel->parse( szCode + offset );
     for( i = 0; i < pRepo->pegs; i++ )
     {
         code *= pRepo->colours;
@@ -17,6 +17,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 // Program identification information
 #define MAYOR_VERSION          0
@@ -28,17 +29,41 @@
 #define PROGRAM_NAME           "Mastermind Solution Checker"
 
 #define XX                     -1                      // Rogue value for marking scheme (char)
-#define STOP                   65535                   // Rogue value for codes (unsigned short)
+#define STOP                   -1                      // Rogue value for codes
 #define MAX_PEGS               10
 #define MAX_COLOURS            10
+#define MAX_THREADS            64
+#define FAIL_FAST_RC           2                       // Exit status when --fail-fast finds an error in the solution
+
+// Ways of finding the mark for a guess against a code - chosen to fit the memory available
+#define MARKS_TABLE            0                       // Full table of every mark, worked out up front
+#define MARKS_ROWS             1                       // A row of marks for each distinct guess made in the solution
+#define MARKS_SCORE            2                       // Score each guess against its code as it is checked
+#define MARK_PACK_PEGS         4                       // Up to this many pegs, two marks are packed into each byte of the table
+#define MARK_TABLE_ALIGN       64                      // The mark table starts on a cache line
+#define MARK_FILL_BLOCKS       16                      // Blocks of rows for each thread to fill
+
+// Checking passes that can be chosen with --checks
+#define CHECK_CODES            0x01                    // Every code shown once, and each matching its number
+#define CHECK_COUNTS           0x02                    // Every line resolved in the number of turns given
+#define CHECK_CONSISTENCY      0x04                    // The same guess after the same guesses and marks
+#define CHECK_MARKS            0x08                    // Every mark correct
+#define CHECK_FEASIBILITY      0x10                    // Guesses bracketed exactly when they can't be the code
+#define CHECK_DEFAULT          ( CHECK_CODES | CHECK_COUNTS | CHECK_CONSISTENCY | CHECK_MARKS )
 
 // Structure pre-declarations
 struct Repo;
 struct CodeDef;
 struct Turn;
 struct Solution;
-struct Absent;
-struct CodeDef;
+struct Tree;
+struct Warm;
+struct Kernel;
+struct Perf;
+struct Feasible;
+struct Scanner;
+struct Dag;
+struct OutBuf;
 
 // Root structure used to hold all of the puzzle parameters and to point to structures used in finding the best solution
 typedef struct Repo
@@ -55,15 +80,63 @@ typedef struct Repo
     int              codes;                          // Expected number of codes
     int              actualCodes;                    // Actual number of codes in solution file
     int              guesses;                        // Max number of guesses
+    // Options
+    bool             failFast;                       // Stop at the first error found (gating runs)
+    int              sampleSize;                     // Number of lines to sample (0 to check every line)
+    double           sampleRate;                     // Proportion of lines to sample (0 to check every line)
+    unsigned long long seed;                         // Seed for picking sample lines (0 to pick one)
+    bool             replay;                         // Check by playing every code through the strategy tree
+    int              threads;                        // Number of threads to use for parallel checks
+    char*            diffName;                       // Second solution to compare this one with (NULL if not diffing)
+    char*            markCache;                      // Directory holding cached mark tables (NULL for no cache)
+    long long        maxMemory;                      // Memory budget for the marks in bytes (0 to base it on the memory fitted)
+    int              shard;                          // Shard of the solution file to check (1 to shards)
+    int              shards;                         // Number of shards the file is split into (0 to check the whole file)
+    char**           mergeNames;                     // Partial results to merge into a report (NULL if not merging)
+    int              mergeCount;                     // Number of partial results to merge
+    int              checks;                         // Checking passes to run - CHECK_... flags
+    char*            tableName;                      // Decision table to write once the solution is found valid (NULL for none)
+    char*            dagName;                        // Strategy file to write once the solution is found valid (NULL for none)
+    char*            benchName;                      // Decision table to time lookups in, rather than check a solution
+    char*            daemonName;                     // Socket to serve validation requests on (NULL if not a daemon)
+    char*            clientName;                     // Socket of the daemon to send this request to (NULL to check here)
+    char**           clientArgs;                     // Options and filename to send to the daemon
+    int              clientArgCount;
+    bool             stream;                         // Send the solution itself to the daemon, rather than its path
+    struct Warm*     warm;                           // Tables kept warm by the daemon, to borrow rather than build (NULL if none)
+    bool             pipeline;                       // Overlap reading, parsing and checking the lines on separate threads
+    bool             perfCounters;                   // Count cycles, instructions and misses for each phase of the run
+    bool             showProgress;                   // Show progress on stderr every second
+    bool             outOfCore;                      // Check the file in sorted runs spilled to disk, rather than in memory
+    char*            scratchDir;                     // Directory for the runs (NULL for $TMPDIR, or /tmp)
+    const struct Scanner* scanner;                   // Finds the commas and line ends in the text read (see MMscan.h)
     // Correctness flags
     bool             pegsOK;                         // Do we have a consistent view of the numbers of pegs?
     bool             coloursOK;                      // Do we have a consistent view of the numbers of colours?
     bool             codesOK;                        // Did we get the expected number of codes?
+    // Output
+    FILE*            out;                            // Where the report is written (NULL for no report)
+    FILE*            err;                            // Where problems running the check are reported (stderr unless told otherwise)
+    bool             errorsFile;                     // Write details of solution level errors to an _ERRORS.csv file (and any _NODES.csv file)?
     // Sub structures
     struct CodeDef*  codeDefs;                       // Static information about each code
-    char**           marking;                        // Two dimensional array holding marks
+    char*            markTable;                      // Single block holding the triangle of marks (see markIndex)
+    bool             markPacked;                     // Two marks to a byte in markTable (up to MARK_PACK_PEGS pegs)
+    void*            markMap;                        // Mapped mark cache file holding markTable (NULL if malloc'd)
+    size_t           markMapSize;                    // Size of the mapped mark cache file
+    int              markStrategy;                   // How marks are found - MARKS_TABLE, MARKS_ROWS or MARKS_SCORE
+    char**           guessMarks;                     // Row of marks against every code, for each guess made (MARKS_ROWS)
+    char*            guessBlock;                     // Single block holding the guessMarks rows
     struct Solution* data;                           // All data held in file being analysed (except headers)
-    struct Absent*   missing;                        // List of missing codes
+    uint64_t*        seen;                           // Bitmap of the codes shown in the solution
+    uint64_t*        repeat;                         // Bitmap of the codes shown more than once
+    int              missingCodes;                   // Number of codes not shown in the solution
+    struct Tree*     tree;                           // Strategy tree (when one has been built)
+    const struct Kernel* kernel;                     // Kernel specialised for these pegs and colours (NULL for generic code)
+    struct Perf*     perf;                           // Performance counters (when --perf-counters is given and they have been opened)
+    struct Progress* progress;                       // Counts watched by the progress monitor (NULL if not watched)
+    struct Feasible* feasible;                       // Candidate set sizes found by the feasibility check
+    struct Dag*      dag;                            // Strategy read from a strategy file (when one is being checked)
 } Repo;
 
 // A turn consists of a guess and a mark
@@ -75,6 +148,8 @@ typedef struct Turn
     // Correctness flags
     bool guessOK;                               // Is the guess a well formatted guess?
     bool markOK;                                // Is the mark what was expected?
+    bool bracketed;                             // Was the guess shown in brackets (as not a possible code)?
+    bool bracketOK;                             // Are the brackets right? (Only checked by the feasibility pass)
 } Turn;
 
 // A Solution consists the code to be guessed, an array of turns and the number of turns taken to resolve
@@ -83,6 +158,7 @@ typedef struct Solution
 {   
     // Parameters
     int          line;                          // Line of the file that contains this solution (not counting the header)
+    int          fileLine;                      // Line number in the file, counting the header and blank lines (set by parseFile)
     int          code;                          // The code solved on this line
     int          noTurns;                       // Number of turns we are told it takes to solve this code
     int          actualNoTurns;                 // Number of turns it actually took (clearly should be the same)
@@ -94,16 +170,10 @@ typedef struct Solution
     bool         marksOK;                       // Are all the given marks accurate?
     bool         guessesOK;                     // Is the format of the guesses ok - ie Guess+Mark, Guess+Mark...
     bool         guessConsistant;               // Is the same guess made for every code after the same mark?
+    bool         bracketsOK;                    // Are guesses bracketed exactly when they can't be the code?
     struct Turn* turns;
 } Solution;
 
-// A Solution consists the code to be guessed, an array of turns and the number of turns taken to resolve
-typedef struct Absent
-{
-    int          code;                          // Store details of any missing codes
-    bool         codeMissing;
-} Absent;
-
 // Definition of each possible code
 typedef struct CodeDef
 {
@@ -111,16 +181,53 @@ typedef struct CodeDef
     char colourFrequency[MAX_COLOURS];                 // How many times each colour is used in this code 
 } CodeDef;
 
+// A node of the strategy tree - the guess made at this point in the game
+typedef struct Node
+{
+    int          guess;                         // Guess made at this node (-1 if no line has reached it yet)
+    int          depth;                         // Number of turns already taken to reach this node
+    int          line;                          // First line to reach this node
+} Node;
+
+// The strategy tree, held as an array of nodes plus, for each node, the child node reached by each mark
+typedef struct Tree
+{
+    int          marks;                         // Number of possible marks (children per node)
+    int          nodes;                         // Number of nodes in use
+    int          size;                          // Number of nodes allocated
+    struct Node* node;
+    int*         child;                         // child[node * marks + mark] is the next node, or -1
+} Tree;
+
 int main( int argc, char **argv );
+int validate( Repo* pRepo );
 int parseHeader( Repo* pRepo );
 int countPegs( Repo* pRepo );
 int countCodes( Repo* pRepo );
 int parseFile( Repo* pRepo );
+int newSolutions( Repo* pRepo, int count );
+int initSolutions( Repo* pRepo, Solution* data, int count );
+int parseLine( Repo* pRepo, Solution* pSoln, char* line, int fields );
+int parseFields( Repo* pRepo, Solution* pSoln, char** field, int fields );
 int checkCodes( Repo* pRepo );
+void seeCodes( Repo* pRepo, int from, int to, void* arg );
+int newCodeMaps( Repo* pRepo );
+int countMissing( Repo* pRepo );
 int checkCounts( Repo* pRepo );
 int checkGuesses( Repo* pRepo );
+void compareGuesses( Repo* pRepo, int from, int to, void* arg );
 int checkMarks( Repo* pRepo );
+int skipChecks( Repo* pRepo );
 int report( Repo* pRepo );
+void reportFileErrors( Repo* pRepo );
+FILE* openErrorsFile( Repo* pRepo );
+void writeErrorRow( struct OutBuf* pOut, Solution* pSoln, char* line, bool fault );
+int gate( Repo* pRepo );
+int countTurns( Repo* pRepo, Solution* pSoln );
+bool solutionFault( Repo* pRepo, Solution* pSoln );
+char* lineFault( Repo* pRepo, Solution* pSoln );
+int failFile( Repo* pRepo, char* reason );
+int failLine( Repo* pRepo, int line, char* text, char* reason );
 int parseCode( Repo* pRepo, char* szCode );
 int getField( FILE* fp, char* field, int maxLen );
 int nextField( char* string, char* field, int maxLen );
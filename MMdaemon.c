@@ -0,0 +1,632 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Resident validation daemon (--daemon) and its client (--client)
+// The daemon listens on a Unix-domain socket, and checks each solution it is sent on one of a pool of worker threads
+// The code definitions and mark table for each puzzle size are built for the first solution of that size, then kept warm
+// The client sends its options and the solution (as a path, or the text itself), and shows the report it gets back
+//
+// A request is a few lines of text:
+//     MMCHK 2
+//     ARG <option>                   - once for each option, eg ARG --checks=codes (only those in clientOptions are accepted)
+//     FILE <path>                    - the solution file, as the daemon sees it
+//  or BODY <length> <name>           - followed by length bytes of the solution itself
+//  or RUN                            - no solution
+// The reply is RC <return code> <length> <error length>, followed by length bytes of report, then error length bytes of
+// the problems found running the check (what a run of its own would have written to stderr)
+//
+#include "MMdaemon.h"
+#include "MMchk.h"
+#include "MMparams.h"
+#include "MMlib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+
+static WarmTable* findWarm( Warm* pWarm, Repo* pRepo );
+static void       stopDaemon( int signal );
+static int        checkClientArgs( Repo* pRepo, int argCount, char** args );
+
+// Set by SIGINT or SIGTERM - the only state outside of a repository, as a signal handler can reach nothing else
+static volatile sig_atomic_t stopping = 0;
+
+// The options a client may send - only those choosing what is checked and reported, and whether each takes a value
+// Nothing else is let through, so no client can have the daemon write files of its choosing or change how it runs
+static const struct { char* name; bool value; } clientOptions[] =
+{
+    { "--checks",      true  },
+    { "--feasibility", false },
+    { "--fail-fast",   false },
+    { "--sample",      true  },
+    { "--sample-rate", true  },
+    { "--seed",        true  },
+};
+
+// Serve validation requests on the socket named by --daemon, until told to stop
+int runDaemon( Repo* pRepo )
+{
+    struct sockaddr_un addr;
+    struct sigaction   action;
+    struct stat        info;
+    pthread_t          tid[MAX_THREADS];
+    sigset_t           signals;
+    Daemon             daemon;
+    int                workers = 0;
+    int                client  = -1;
+    int                t       = 0;
+
+    if( strlen( pRepo->daemonName ) >= sizeof(addr.sun_path) )
+    {
+        fprintf( pRepo->err, "Socket name %s is too long\n", pRepo->daemonName );
+        return -1;
+    }
+
+    stopping = 0;                                      // A daemon run earlier in this process may have been stopped
+    memset( &daemon, 0, sizeof(daemon) );
+    daemon.pRepo = pRepo;
+    pthread_mutex_init( &daemon.warm.lock, NULL );
+    pthread_mutex_init( &daemon.lock, NULL );
+    pthread_cond_init( &daemon.ready, NULL );
+
+    // A socket left behind by an earlier daemon is removed - anything else of that name is left alone
+    if( stat( pRepo->daemonName, &info ) == 0 && S_ISSOCK( info.st_mode ) )
+        unlink( pRepo->daemonName );
+
+    memset( &addr, 0, sizeof(addr) );
+    addr.sun_family = AF_UNIX;
+    strcpy( addr.sun_path, pRepo->daemonName );
+    daemon.listenFd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if( daemon.listenFd == -1 || bind( daemon.listenFd, (struct sockaddr*)&addr, sizeof(addr) ) != 0 || listen( daemon.listenFd, DAEMON_QUEUE ) != 0 )
+    {
+        fprintf( pRepo->err, "Unable to listen on %s (%s)\n", pRepo->daemonName, strerror( errno ) );
+        if( daemon.listenFd != -1 ) close( daemon.listenFd );
+        return -1;
+    }
+
+    // Stop cleanly on SIGINT or SIGTERM - only this thread takes them, so they always interrupt accept
+    // A client going away part way through its reply must not stop the daemon
+    memset( &action, 0, sizeof(action) );
+    action.sa_handler = stopDaemon;
+    sigaction( SIGINT, &action, NULL );
+    sigaction( SIGTERM, &action, NULL );
+    signal( SIGPIPE, SIG_IGN );
+
+    sigemptyset( &signals );
+    sigaddset( &signals, SIGINT );
+    sigaddset( &signals, SIGTERM );
+    pthread_sigmask( SIG_BLOCK, &signals, NULL );
+    workers = pRepo->threads > MAX_THREADS ? MAX_THREADS : pRepo->threads < 1 ? 1 : pRepo->threads;
+    for( t = 0; t < workers; t++ )
+    {
+        if( pthread_create( &tid[t], NULL, daemonWorker, &daemon ) != 0 )
+            break;
+    }
+    workers = t;
+    pthread_sigmask( SIG_UNBLOCK, &signals, NULL );
+    fprintf( pRepo->err, "MMchk daemon listening on %s with %d workers\n", pRepo->daemonName, workers );
+
+    while( ! stopping && workers > 0 )
+    {
+        client = accept( daemon.listenFd, NULL, NULL );
+        if( client == -1 )
+        {
+            if( errno != EINTR )
+                fprintf( pRepo->err, "Unable to accept a request (%s)\n", strerror( errno ) );
+            continue;
+        }
+
+        pthread_mutex_lock( &daemon.lock );
+        if( daemon.count == DAEMON_QUEUE )
+        {
+            fprintf( pRepo->err, "Too many requests waiting - turning one away\n" );
+            close( client );
+        }
+        else
+        {
+            daemon.queue[( daemon.head + daemon.count ) % DAEMON_QUEUE] = client;
+            daemon.count += 1;
+            pthread_cond_signal( &daemon.ready );
+        }
+        pthread_mutex_unlock( &daemon.lock );
+    }
+
+    // Let the workers finish what is queued, then tidy up
+    pthread_mutex_lock( &daemon.lock );
+    daemon.stop = true;
+    pthread_cond_broadcast( &daemon.ready );
+    pthread_mutex_unlock( &daemon.lock );
+    for( t = 0; t < workers; t++ )
+        pthread_join( tid[t], NULL );
+
+    close( daemon.listenFd );
+    unlink( pRepo->daemonName );
+    freeWarm( &daemon.warm );
+    pthread_cond_destroy( &daemon.ready );
+    pthread_mutex_destroy( &daemon.lock );
+    fprintf( pRepo->err, "MMchk daemon stopped\n" );
+    return 0;
+}
+
+static void stopDaemon( int signal )
+{
+    (void)signal;
+    stopping = 1;
+}
+
+// Worker thread - serve queued connections one at a time, until the daemon stops and the queue is empty
+void* daemonWorker( void* arg )
+{
+    Daemon* pDaemon = (Daemon*)arg;
+    int     fd      = -1;
+
+    for( ;; )
+    {
+        pthread_mutex_lock( &pDaemon->lock );
+        while( pDaemon->count == 0 && ! pDaemon->stop )
+            pthread_cond_wait( &pDaemon->ready, &pDaemon->lock );
+        if( pDaemon->count == 0 )
+        {
+            pthread_mutex_unlock( &pDaemon->lock );
+            break;
+        }
+        fd = pDaemon->queue[pDaemon->head];
+        pDaemon->head   = ( pDaemon->head + 1 ) % DAEMON_QUEUE;
+        pDaemon->count -= 1;
+        pthread_mutex_unlock( &pDaemon->lock );
+
+        serveRequest( pDaemon, fd );
+    }
+    return NULL;
+}
+
+// Check one solution for a client, and send back the report
+// Each request has a repository of its own, with the daemon's options, then those sent with the request
+void serveRequest( Daemon* pDaemon, int fd )
+{
+    Repo    repo;
+    FILE*   in        = NULL;
+    char*   args[DAEMON_MAX_ARGS+1];
+    char*   path      = NULL;
+    char*   body      = NULL;
+    char*   report    = NULL;
+    char*   errors    = NULL;
+    char    reply[96];
+    size_t  length    = 0;
+    size_t  reportLen = 0;
+    size_t  errorsLen = 0;
+    int     argCount  = 1;
+    int     rc        = 0;
+    int     i         = 0;
+
+    in = fdopen( fd, "r" );
+    if( in == NULL )
+    {
+        close( fd );
+        return;
+    }
+
+    // Problems with the request are sent back with the report, rather than written to the daemon's own stderr
+    initRepo( &repo );
+    repo.err       = open_memstream( &errors, &errorsLen );
+    if( repo.err == NULL ) repo.err = stderr;
+    repo.threads   = pDaemon->pRepo->threads;
+    repo.maxMemory = pDaemon->pRepo->maxMemory;
+    repo.markCache = pDaemon->pRepo->markCache;
+    args[0]        = "MMchk";
+
+    rc = readRequest( &repo, in, args, &argCount, &path, &body, &length );
+    if( rc == 0 ) rc = checkClientArgs( &repo, argCount, args );
+    if( rc == 0 ) rc = parseOptions( &repo, argCount, args );
+
+    repo.warm = &pDaemon->warm;
+    repo.out  = open_memstream( &report, &reportLen );
+    if( rc == 0 && body != NULL )
+    {
+        repo.errorsFile = false;         // There is nowhere sensible to write it - the solution is not on this machine's disk
+        rc = mmchkValidateBuffer( &repo, path, body, length, NULL );
+    }
+    else if( rc == 0 && path != NULL )
+        rc = mmchkValidateFile( &repo, path, NULL );
+    else if( rc == 0 )
+        rc = validate( &repo );
+
+    if( repo.out != NULL )
+        fclose( repo.out );
+    repo.out = NULL;
+    if( repo.err != stderr )
+        fclose( repo.err );
+    repo.err = stderr;
+    snprintf( reply, sizeof(reply), "RC %d %zu %zu\n", rc, report != NULL ? reportLen : 0, errors != NULL ? errorsLen : 0 );
+    if( sendAll( fd, reply, strlen( reply ) ) == 0 && report != NULL )
+        sendAll( fd, report, reportLen );
+    if( errors != NULL )
+        sendAll( fd, errors, errorsLen );
+
+    freeRepo( &repo );
+    for( i = 1; i < argCount; i++ )
+        free( args[i] );
+    free( path );
+    free( body );
+    free( report );
+    free( errors );
+    fclose( in );
+}
+
+// Read a request - its options go into args (after args[0]), and the solution into path (and body, if it was sent)
+// Returns -1 if the request is not well formed
+int readRequest( Repo* pRepo, FILE* in, char** args, int* argCount, char** path, char** body, size_t* length )
+{
+    char   line[DAEMON_LINE];
+    size_t len  = 0;
+    int    name = 0;
+
+    if( fgets( line, sizeof(line), in ) == NULL || strncmp( line, DAEMON_PROTOCOL "\n", sizeof(DAEMON_PROTOCOL) ) != 0 )
+    {
+        fprintf( pRepo->err, "Request is not from an MMchk client\n" );
+        return -1;
+    }
+
+    while( fgets( line, sizeof(line), in ) != NULL )
+    {
+        len = strlen( line );
+        if( len == 0 || line[len-1] != '\n' )
+            break;
+        line[--len] = '\0';
+
+        if( strncmp( line, "ARG ", 4 ) == 0 && *argCount < DAEMON_MAX_ARGS )
+        {
+            args[(*argCount)++] = strdup( line + 4 );
+        }
+        else if( strncmp( line, "FILE ", 5 ) == 0 )
+        {
+            *path = strdup( line + 5 );
+            return 0;
+        }
+        else if( strcmp( line, "RUN" ) == 0 )
+        {
+            return 0;
+        }
+        else if( sscanf( line, "BODY %zu %n", length, &name ) == 1 && name > 0 && *length > 0 )
+        {
+            if( *length > DAEMON_MAX_BODY )
+            {
+                fprintf( pRepo->err, "A solution of %zu bytes is more than the daemon accepts (%zu)\n", *length, DAEMON_MAX_BODY );
+                return -1;
+            }
+            *path = strdup( line + name );
+            *body = (char*)malloc( *length );
+            if( *body == NULL )
+            {
+                fprintf( pRepo->err, "Failed to allocate a request of %zu bytes\n", *length );
+                return -1;
+            }
+            if( fread( *body, 1, *length, in ) != *length )
+                break;
+            return 0;
+        }
+        else
+            break;
+    }
+    fprintf( pRepo->err, "Request is not well formed\n" );
+    return -1;
+}
+
+// Check a client only sent options from clientOptions (anything not an option is the solution's name)
+// Returns -1, with the option named, if any other was sent
+static int checkClientArgs( Repo* pRepo, int argCount, char** args )
+{
+    int count = sizeof( clientOptions ) / sizeof( clientOptions[0] );
+    int i     = 0;
+    int o     = 0;
+
+    for( i = 1; i < argCount; i++ )
+    {
+        if( args[i][0] != '-' ) continue;
+        for( o = 0; o < count; o++ )
+            if( isOption( args[i], clientOptions[o].name ) ) break;
+        if( o == count )
+        {
+            fprintf( pRepo->err, "Option %s can't be sent to the daemon\n", args[i] );
+            return -1;
+        }
+        if( clientOptions[o].value && strchr( args[i], '=' ) == NULL ) i++;     // Step over its value
+    }
+    return 0;
+}
+
+// Send this request to the daemon named by --client, and show its report
+// Returns the daemon's return code, so the client can stand in for a run of its own
+int runClient( Repo* pRepo )
+{
+    struct sockaddr_un addr;
+    char               request[DAEMON_LINE+16];
+    char               path[PATH_MAX];
+    char               chunk[65536];
+    FILE*              in        = NULL;
+    FILE*              solnFp    = NULL;
+    FILE*              text      = NULL;
+    char*              body      = NULL;
+    char*              arg       = NULL;
+    size_t             length    = 0;
+    size_t             errorsLen = 0;
+    size_t             got       = 0;
+    int                fd        = -1;
+    int                rc        = 0;
+    int                i         = 0;
+
+    if( strlen( pRepo->clientName ) >= sizeof(addr.sun_path) )
+    {
+        fprintf( pRepo->err, "Socket name %s is too long\n", pRepo->clientName );
+        return -1;
+    }
+    memset( &addr, 0, sizeof(addr) );
+    addr.sun_family = AF_UNIX;
+    strcpy( addr.sun_path, pRepo->clientName );
+    fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if( fd == -1 || connect( fd, (struct sockaddr*)&addr, sizeof(addr) ) != 0 )
+    {
+        fprintf( pRepo->err, "Unable to reach the MMchk daemon on %s (%s)\n", pRepo->clientName, strerror( errno ) );
+        if( fd != -1 ) close( fd );
+        return -1;
+    }
+    signal( SIGPIPE, SIG_IGN );
+
+    // Pass on every option, except those that are only for the client
+    rc = sendAll( fd, DAEMON_PROTOCOL "\n", strlen( DAEMON_PROTOCOL "\n" ) );
+    for( i = 0; rc == 0 && i < pRepo->clientArgCount; i++ )
+    {
+        arg = pRepo->clientArgs[i];
+        if( arg == pRepo->filename || strcmp( arg, "--stream" ) == 0 )
+            continue;
+        if( isOption( arg, "--client" ) )
+        {
+            if( strchr( arg, '=' ) == NULL ) i++;
+            continue;
+        }
+        if( strchr( arg, '\n' ) != NULL || strlen( arg ) >= DAEMON_LINE - 8 )
+        {
+            fprintf( pRepo->err, "Option %s can't be sent to the daemon\n", arg );
+            rc = -1;
+            break;
+        }
+        snprintf( request, sizeof(request), "ARG %s\n", arg );
+        rc = sendAll( fd, request, strlen( request ) );
+    }
+
+    // Then the solution - its path (which the daemon opens for itself), or the text of it
+    if( rc == 0 && pRepo->filename == NULL )
+    {
+        rc = sendAll( fd, "RUN\n", 4 );
+    }
+    else if( rc == 0 && ( pRepo->stream || strcmp( pRepo->filename, "-" ) == 0 ) )
+    {
+        solnFp = strcmp( pRepo->filename, "-" ) == 0 ? stdin : fopen( pRepo->filename, "r" );
+        text   = open_memstream( &body, &length );
+        if( solnFp == NULL || text == NULL )
+        {
+            fprintf( pRepo->err, "Filename \"%s\"is invalid", pRepo->filename );
+            rc = -1;
+        }
+        while( rc == 0 && ( got = fread( chunk, 1, sizeof(chunk), solnFp ) ) > 0 )
+            fwrite( chunk, 1, got, text );
+        if( text != NULL ) fclose( text );
+        if( solnFp != NULL && solnFp != stdin ) fclose( solnFp );
+
+        if( rc == 0 )
+        {
+            snprintf( request, sizeof(request), "BODY %zu %s\n", length, strcmp( pRepo->filename, "-" ) == 0 ? "stdin" : pRepo->filename );
+            rc = sendAll( fd, request, strlen( request ) );
+        }
+        if( rc == 0 ) rc = sendAll( fd, body, length );
+        free( body );
+    }
+    else if( rc == 0 )
+    {
+        if( realpath( pRepo->filename, path ) == NULL || strlen( path ) >= DAEMON_LINE - 8 )
+        {
+            fprintf( pRepo->err, "Filename \"%s\"is invalid", pRepo->filename );
+            rc = -1;
+        }
+        else
+        {
+            snprintf( request, sizeof(request), "FILE %s\n", path );
+            rc = sendAll( fd, request, strlen( request ) );
+        }
+    }
+
+    // The reply - the return code, then the report and the problems just as the daemon wrote them
+    if( rc == 0 )
+    {
+        in = fdopen( fd, "r" );
+        if( in == NULL || fscanf( in, "RC %d %zu %zu", &rc, &length, &errorsLen ) != 3 || fgetc( in ) != '\n' )
+        {
+            fprintf( pRepo->err, "No reply from the MMchk daemon on %s\n", pRepo->clientName );
+            rc = -1;
+            length    = 0;
+            errorsLen = 0;
+        }
+        while( length > 0 && ( got = fread( chunk, 1, length < sizeof(chunk) ? length : sizeof(chunk), in ) ) > 0 )
+        {
+            if( pRepo->out != NULL ) fwrite( chunk, 1, got, pRepo->out );
+            length -= got;
+        }
+        while( errorsLen > 0 && ( got = fread( chunk, 1, errorsLen < sizeof(chunk) ? errorsLen : sizeof(chunk), in ) ) > 0 )
+        {
+            fwrite( chunk, 1, got, pRepo->err );
+            errorsLen -= got;
+        }
+    }
+
+    if( in != NULL )
+        fclose( in );
+    else
+        close( fd );
+    return rc;
+}
+
+// Write all of the data to a socket
+// Returns -1 if the other end has gone away
+int sendAll( int fd, const char* data, size_t length )
+{
+    ssize_t sent = 0;
+
+    while( length > 0 )
+    {
+        sent = send( fd, data, length, MSG_NOSIGNAL );
+        if( sent <= 0 )
+        {
+            if( sent == -1 && errno == EINTR ) continue;
+            return -1;
+        }
+        data   += sent;
+        length -= sent;
+    }
+    return 0;
+}
+
+// Find the warm tables for this puzzle size, making room for them if this is the first solution of that size
+// The caller holds the lock - returns NULL if every slot is taken by other sizes
+static WarmTable* findWarm( Warm* pWarm, Repo* pRepo )
+{
+    WarmTable* pTable = NULL;
+    int        t      = 0;
+
+    for( t = 0; t < pWarm->tables; t++ )
+        if( pWarm->table[t].pegs == pRepo->pegs && pWarm->table[t].colours == pRepo->colours )
+            return &pWarm->table[t];
+    if( pWarm->tables == DAEMON_WARM )
+        return NULL;
+
+    pTable = &pWarm->table[pWarm->tables++];
+    memset( pTable, 0, sizeof(WarmTable) );
+    pTable->pegs    = pRepo->pegs;
+    pTable->colours = pRepo->colours;
+    pthread_cond_init( &pTable->built, NULL );
+    return pTable;
+}
+
+// Borrow the code definitions for this puzzle, building them if no solution of this size has been seen yet
+// They are built outside the lock, so requests for other sizes are not held up - those for this size wait for them
+int warmCodeDefs( Repo* pRepo )
+{
+    WarmTable* pTable = NULL;
+    int        rc     = 0;
+
+    pthread_mutex_lock( &pRepo->warm->lock );
+    pTable = findWarm( pRepo->warm, pRepo );
+    while( pTable != NULL && pTable->buildingDefs )
+        pthread_cond_wait( &pTable->built, &pRepo->warm->lock );
+    if( pTable != NULL && pTable->codeDefs != NULL )
+    {
+        pRepo->codeDefs = pTable->codeDefs;
+        pthread_mutex_unlock( &pRepo->warm->lock );
+        return 0;
+    }
+    if( pTable != NULL ) pTable->buildingDefs = true;
+    pthread_mutex_unlock( &pRepo->warm->lock );
+
+    rc = buildCodeDefs( pRepo );                 // If there is no room to keep them, this solution has its own
+    if( pTable == NULL ) return rc;
+
+    pthread_mutex_lock( &pRepo->warm->lock );
+    if( rc == 0 ) pTable->codeDefs = pRepo->codeDefs;
+    pTable->buildingDefs = false;                // If the build failed, the next request tries for itself
+    pthread_cond_broadcast( &pTable->built );
+    pthread_mutex_unlock( &pRepo->warm->lock );
+
+    return rc;
+}
+
+// Borrow the full mark table for this puzzle, building it (or mapping it from the cache) if need be
+// As warmCodeDefs, the table is built outside the lock and requests for this size wait for it
+int warmMarkTable( Repo* pRepo )
+{
+    WarmTable* pTable = NULL;
+    int        rc     = 0;
+
+    pthread_mutex_lock( &pRepo->warm->lock );
+    pTable = findWarm( pRepo->warm, pRepo );
+    while( pTable != NULL && pTable->buildingMarks )
+        pthread_cond_wait( &pTable->built, &pRepo->warm->lock );
+    if( pTable != NULL && pTable->markTable != NULL )
+    {
+        pRepo->markTable  = pTable->markTable;
+        pRepo->markPacked = pTable->markPacked;
+        pthread_mutex_unlock( &pRepo->warm->lock );
+        return 0;
+    }
+    if( pTable != NULL ) pTable->buildingMarks = true;
+    pthread_mutex_unlock( &pRepo->warm->lock );
+
+    rc = buildMarkTable( pRepo );
+    if( pTable == NULL ) return rc;
+
+    pthread_mutex_lock( &pRepo->warm->lock );
+    if( rc == 0 )
+    {
+        pTable->markTable   = pRepo->markTable;
+        pTable->markPacked  = pRepo->markPacked;
+        pTable->markMap     = pRepo->markMap;          // The warm table now owns any mapping
+        pTable->markMapSize = pRepo->markMapSize;
+        pRepo->markMap      = NULL;
+        pRepo->markMapSize  = 0;
+    }
+    pTable->buildingMarks = false;
+    pthread_cond_broadcast( &pTable->built );
+    pthread_mutex_unlock( &pRepo->warm->lock );
+
+    return rc;
+}
+
+// Hand back any tables borrowed, so freeRepo leaves them alone
+void warmRelease( Repo* pRepo )
+{
+    int t = 0;
+
+    pthread_mutex_lock( &pRepo->warm->lock );
+    for( t = 0; t < pRepo->warm->tables; t++ )
+    {
+        if( pRepo->codeDefs != NULL && pRepo->codeDefs == pRepo->warm->table[t].codeDefs )
+            pRepo->codeDefs = NULL;
+        if( pRepo->markTable != NULL && pRepo->markTable == pRepo->warm->table[t].markTable )
+            pRepo->markTable = NULL;
+    }
+    pthread_mutex_unlock( &pRepo->warm->lock );
+}
+
+// Release every warm table
+void freeWarm( Warm* pWarm )
+{
+    WarmTable* pTable = NULL;
+    int        t      = 0;
+
+    for( t = 0; t < pWarm->tables; t++ )
+    {
+        pTable = &pWarm->table[t];
+        pthread_cond_destroy( &pTable->built );
+        free( pTable->codeDefs );
+        if( pTable->markMap != NULL )
+            munmap( pTable->markMap, pTable->markMapSize );
+        else
+            free( pTable->markTable );
+    }
+    pWarm->tables = 0;
+    pthread_mutex_destroy( &pWarm->lock );
+}
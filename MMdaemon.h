@@ -0,0 +1,75 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMDAEMON_H
+#define MMDAEMON_H
+
+#include "MMchk.h"
+
+#include <stddef.h>
+#include <pthread.h>
+
+#define DAEMON_PROTOCOL        "MMCHK 2"               // First line of every request
+#define DAEMON_QUEUE           64                      // Connections accepted and waiting for a worker
+#define DAEMON_WARM            8                       // Puzzle sizes whose tables are kept warm
+#define DAEMON_MAX_ARGS        64                      // Most options a request can carry
+#define DAEMON_LINE            4096                    // Longest line of a request (eg a path)
+#define DAEMON_MAX_BODY        ( (size_t)1 << 30 )     // Largest solution a client can send whole
+
+// Tables for one puzzle size, built by the first request of that size and lent to every later one
+// A table is built outside the lock - later requests for it wait on built, while requests for other sizes carry on
+typedef struct WarmTable
+{
+    int              pegs;
+    int              colours;
+    struct CodeDef*  codeDefs;
+    char*            markTable;                        // Full mark table (NULL until a request needs one)
+    bool             markPacked;
+    void*            markMap;                          // Mapped mark cache holding markTable (NULL if malloc'd)
+    size_t           markMapSize;
+    bool             buildingDefs;                     // Is a request building codeDefs?
+    bool             buildingMarks;                    // Is a request building markTable?
+    pthread_cond_t   built;                            // Signalled when a build finishes (whether or not it worked)
+} WarmTable;
+
+// Every table kept warm - requests run concurrently, so the first to need a table builds it (and the rest wait)
+typedef struct Warm
+{
+    pthread_mutex_t  lock;
+    int              tables;
+    WarmTable        table[DAEMON_WARM];
+} Warm;
+
+// The daemon - connections are queued by the listening thread and taken by the workers
+typedef struct Daemon
+{
+    Repo*            pRepo;                            // Options the daemon was started with
+    Warm             warm;
+    int              listenFd;
+    pthread_mutex_t  lock;
+    pthread_cond_t   ready;                            // Signalled when a connection is queued
+    int              queue[DAEMON_QUEUE];
+    int              head;
+    int              count;
+    bool             stop;                             // Set when the daemon is told to stop - workers finish what is queued
+} Daemon;
+
+int   runDaemon( Repo* pRepo );
+void* daemonWorker( void* arg );
+void  serveRequest( Daemon* pDaemon, int fd );
+int   readRequest( Repo* pRepo, FILE* in, char** args, int* argCount, char** path, char** body, size_t* length );
+int   runClient( Repo* pRepo );
+int   sendAll( int fd, const char* data, size_t length );
+int   warmCodeDefs( Repo* pRepo );
+int   warmMarkTable( Repo* pRepo );
+void  warmRelease( Repo* pRepo );
+void  freeWarm( Warm* pWarm );
+
+#endif  /* MMDAEMON_H */
@@ -0,0 +1,514 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Compact strategy files (--export-dag) - each node of the strategy stored once, rather than the whole path to it on
+// every line of a solution file.  A node is a guess and the marks leading on to its children, a few bytes in all
+// The nodes are written bottom up, so a child is referred to by how far back it is, which is usually a short number
+//
+// A strategy file given to MMchk is checked by walking it from the root with the codes still possible at each node:
+// they are marked against the guess once, the guess solves the code if it is one of them, and the rest are shared
+// out between the children by their marks.  So each node is visited once, and nothing is parsed but the nodes
+// (In a valid strategy every subtree solves its own codes, so no two are the same and nothing can be shared)
+//
+#include "MMdag.h"
+#include "MMchk.h"
+#include "MMcache.h"
+#include "MMformat.h"
+#include "MMkernels.h"
+#include "MMparams.h"
+#include "MMperf.h"
+#include "MMtable.h"
+#include "MMtree.h"
+#include "MMutility.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static const char* decodeNodes( Dag* pDag, const unsigned char* data );
+static bool        getVarint( const unsigned char* data, uint64_t size, uint64_t* pPos, uint64_t* pValue );
+static size_t      putVarint( unsigned char* data, uint64_t value );
+static int         writeDag( Repo* pRepo, char* name, DagHeader* pHeader, unsigned char* data );
+
+// Does the file hold a strategy written by --export-dag, rather than a solution?
+bool isDag( Repo* pRepo )
+{
+    char magic[8];
+    bool dag = false;
+
+    if( pRepo->fp == NULL || fseek( pRepo->fp, 0, SEEK_SET ) != 0 ) return false;
+    dag = fread( magic, 1, 8, pRepo->fp ) == 8 && memcmp( magic, DAG_MAGIC, 8 ) == 0;
+    fseek( pRepo->fp, 0, SEEK_SET );
+    return dag;
+}
+
+// Check a strategy file - read its nodes, walk them with the codes still possible at each, and report
+int dagCheck( Repo* pRepo )
+{
+    int rc = 0;
+
+    freeDag( pRepo );
+    pRepo->dag = (Dag*)calloc( 1, sizeof(Dag) );
+    if( pRepo->dag == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate strategy\n" );
+        return -1;
+    }
+
+    rc = phase( pRepo, "readDag", readDag );
+    if( rc == 0 ) rc = phase( pRepo, "walkDag", walkDag );
+    if( rc == 0 ) rc = phase( pRepo, "report", reportDag );
+    perfReport( pRepo );
+    return rc;
+}
+
+// Read the header and nodes, checking the file is whole and every node makes sense on its own
+// The numbers of pegs, colours and codes are taken from the header
+int readDag( Repo* pRepo )
+{
+    Dag*           pDag    = pRepo->dag;
+    DagHeader*     pHeader = &pDag->header;
+    unsigned char* data    = NULL;
+    const char*    reason  = NULL;
+    int            n       = 0;
+    int            rc      = 0;
+
+    fseek( pRepo->fp, 0, SEEK_SET );
+    if( fread( pHeader, sizeof(DagHeader), 1, pRepo->fp ) != 1 )
+        reason = "is cut short";
+    else if( pHeader->version != DAG_VERSION )
+        reason = "was written by another version";
+    else if( pHeader->pegs < 1 || pHeader->pegs > MAX_PEGS || pHeader->colours < 1 || pHeader->colours > MAX_COLOURS
+             || pHeader->codes != (uint32_t)round( pow( pHeader->colours, pHeader->pegs ) )
+             || pHeader->marks != pHeader->pegs * ( pHeader->pegs + 3 ) / 2
+             || pHeader->nodes > pHeader->size / 2 || pHeader->size > ( 1ULL << 31 ) )
+        reason = "has a bad header";
+
+    if( reason == NULL )
+    {
+        data             = (unsigned char*)malloc( pHeader->size + 1 );
+        pDag->guess      = (int*)malloc( sizeof(int) * ( pHeader->nodes + 1 ) );
+        pDag->bracketed  = (bool*)malloc( sizeof(bool) * ( pHeader->nodes + 1 ) );
+        pDag->first      = (int*)malloc( sizeof(int) * ( pHeader->nodes + 1 ) );
+        pDag->parents    = (int*)calloc( pHeader->nodes + 1, sizeof(int) );
+        pDag->mark       = (uint8_t*)malloc( pHeader->size / 2 + 1 );         // Each child takes two bytes at least
+        pDag->child      = (int*)malloc( sizeof(int) * ( pHeader->size / 2 + 1 ) );
+        if( data == NULL || pDag->guess == NULL || pDag->bracketed == NULL || pDag->first == NULL || pDag->parents == NULL
+            || pDag->mark == NULL || pDag->child == NULL )
+        {
+            fprintf( pRepo->err, "Failed to allocate arrays in readDag\n" );
+            free( data );
+            return -1;
+        }
+        if( fread( data, 1, pHeader->size, pRepo->fp ) != pHeader->size )
+            reason = "is cut short";
+        else if( cacheChecksum( data, pHeader->size ) != pHeader->checksum )
+            reason = "is corrupt (its checksum is wrong)";
+        else
+            reason = decodeNodes( pDag, data );
+    }
+    free( data );
+
+    if( reason != NULL )
+    {
+        fprintf( pRepo->err, "Strategy file %s %s\n", pRepo->baseName, reason );
+        return -1;
+    }
+
+    // Every node but the root should be some node's child
+    for( n = 0; n + 1 < (int)pHeader->nodes; n++ )
+        if( pDag->parents[n] == 0 ) pDag->orphans += 1;
+
+    pRepo->pegs         = pHeader->pegs;
+    pRepo->colours      = pHeader->colours;
+    pRepo->codes        = pHeader->codes;
+    pRepo->markStrategy = MARKS_SCORE;
+    selectKernel( pRepo );
+    rc = setupCodeDefs( pRepo );                       // For showing codes not solved
+    return rc == 0 ? 0 : -1;
+}
+
+// Unpack the nodes - returns why the file is bad, or NULL if every node is sound
+static const char* decodeNodes( Dag* pDag, const unsigned char* data )
+{
+    DagHeader* pHeader = &pDag->header;
+    uint64_t   pos     = 0;
+    uint64_t   value   = 0;
+    int        links   = 0;
+    int        last    = 0;
+    int        mark    = 0;
+    int        kids    = 0;
+    int        n       = 0;
+    int        k       = 0;
+
+    for( n = 0; n < (int)pHeader->nodes; n++ )
+    {
+        if( ! getVarint( data, pHeader->size, &pos, &value ) ) return "is cut short";
+        if( value / 2 >= pHeader->codes ) return "has a guess that is not a code";
+        pDag->guess[n]     = (int)( value / 2 );
+        pDag->bracketed[n] = ( value & 1 ) != 0;
+
+        if( pos >= pHeader->size ) return "is cut short";
+        kids           = data[pos++];
+        pDag->first[n] = links;
+        for( last = -1, k = 0; k < kids; k++ )
+        {
+            if( pos >= pHeader->size ) return "is cut short";
+            mark = data[pos++];
+            if( mark <= last || mark >= (int)pHeader->marks - 1 ) return "has a child for a mark out of order, or not a mark";
+            if( ! getVarint( data, pHeader->size, &pos, &value ) ) return "is cut short";
+            if( value < 1 || value > (uint64_t)n ) return "has a child that is not an earlier node";
+
+            pDag->mark[links]  = mark;
+            pDag->child[links] = n - (int)value;
+            pDag->parents[n - value] += 1;
+            links += 1;
+            last   = mark;
+        }
+    }
+    pDag->first[pHeader->nodes] = links;
+
+    if( pos != pHeader->size ) return "has more after its last node";
+    return NULL;
+}
+
+// Walk the strategy from the root, with every code possible there
+int walkDag( Repo* pRepo )
+{
+    Dag* pDag  = pRepo->dag;
+    int  codes = pRepo->codes;
+    int  code  = 0;
+    int  w     = 0;
+
+    pDag->cands  = (int*)malloc( sizeof(int) * ( codes + 1 ) );
+    pDag->spare  = (int*)malloc( sizeof(int) * ( codes + 1 ) );
+    pDag->marks  = (char*)malloc( codes + 1 );
+    pDag->solved = (uint64_t*)calloc( bitmapWords( codes ) + 1, sizeof(uint64_t) );
+    if( pDag->cands == NULL || pDag->spare == NULL || pDag->marks == NULL || pDag->solved == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate arrays in walkDag\n" );
+        return -1;
+    }
+
+    for( code = 0; code < codes; code++ ) pDag->cands[code] = code;
+    if( pDag->header.nodes > 0 ) walkNode( pRepo, pDag, pDag->header.nodes - 1, 0, codes, 0 );
+
+    pDag->unsolved = codes;
+    for( w = 0; w < bitmapWords( codes ); w++ ) pDag->unsolved -= __builtin_popcountll( pDag->solved[w] );
+    return 0;
+}
+
+// Visit a node with the codes still possible there (cands lo to hi) - each is marked against the guess once, and the
+// codes are then grouped by mark, so each child is visited with its own codes next to each other
+// Codes given a mark the node has no child for are left unsolved
+void walkNode( Repo* pRepo, Dag* pDag, int node, int lo, int hi, int depth )
+{
+    int  start[DAG_MAX_MARKS+1];
+    int  count[DAG_MAX_MARKS];
+    int  marks    = pDag->header.marks;
+    int  allBlack = marks - 1;
+    int  guess    = pDag->guess[node];
+    int  link     = 0;
+    int  c        = 0;
+    int  m        = 0;
+
+    if( depth >= DAG_MAX_DEPTH )
+    {
+        pDag->tooDeep = true;
+        return;
+    }
+
+    memset( count, 0, sizeof(int) * marks );
+    for( c = lo; c < hi; c++ )
+    {
+        pDag->marks[c] = scoreCodes( pRepo, guess, pDag->cands[c] );
+        count[(int)pDag->marks[c]] += 1;
+    }
+
+    // The guess solves the code if it is still possible - and should be bracketed if it isn't
+    if( count[allBlack] > 0 )
+    {
+        setBit( pDag->solved, guess );
+        pDag->TTTS += depth + 1;
+        if( depth + 1 > pDag->worst ) pDag->worst = depth + 1;
+    }
+    if( ( pRepo->checks & CHECK_FEASIBILITY ) && pDag->bracketed[node] == ( count[allBlack] > 0 ) )
+        pDag->wrongBrackets += 1;
+
+    // Group the codes by mark (keeping their order within each mark)
+    start[0] = lo;
+    for( m = 0; m < marks; m++ ) start[m+1] = start[m] + count[m];
+    for( c = lo; c < hi; c++ ) pDag->spare[start[(int)pDag->marks[c]]++] = pDag->cands[c];
+    memcpy( pDag->cands + lo, pDag->spare + lo, sizeof(int) * ( hi - lo ) );
+    for( m = marks; m > 0; m-- ) start[m] = start[m-1];
+    start[0] = lo;
+
+    for( link = pDag->first[node]; link < pDag->first[node+1]; link++ )
+    {
+        m = pDag->mark[link];
+        if( count[m] == 0 )
+            pDag->unreachable += 1;
+        else
+            walkNode( pRepo, pDag, pDag->child[link], start[m], start[m] + count[m], depth + 1 );
+    }
+}
+
+// Report on the strategy, as report does for a solution
+int reportDag( Repo* pRepo )
+{
+    Dag* pDag = pRepo->dag;
+
+    say( pRepo, "\nAnalysis of %s:   ", pRepo->baseName );
+    if( pDag->unsolved == 0 && pDag->unreachable == 0 && pDag->wrongBrackets == 0 && pDag->orphans == 0 )
+    {
+        say( pRepo, "No errors found.  TTTS = %lld\n", pDag->TTTS );
+        say( pRepo, "Strategy of %u nodes in %llu bytes - every code solved in at most %d guesses\n\n",
+             pDag->header.nodes, (unsigned long long)( sizeof(DagHeader) + pDag->header.size ), pDag->worst );
+        return 0;
+    }
+
+    say( pRepo, "\n" );
+    if( pDag->unsolved > 0 )
+    {
+        say( pRepo, "The following code(s) are not solved by the strategy\n" );
+        listCodes( pRepo, pDag->solved, true );
+        if( pDag->tooDeep )
+            say( pRepo, "(Codes more than %d guesses down the strategy are not followed)\n", DAG_MAX_DEPTH );
+    }
+    if( pDag->unreachable > 0 )
+        say( pRepo, "%d branch(es) follow a mark that none of the codes still possible could be given\n", pDag->unreachable );
+    if( pDag->wrongBrackets > 0 )
+        say( pRepo, "%d guess(es) bracketed wrongly\n", pDag->wrongBrackets );
+    if( pDag->orphans > 0 )
+        say( pRepo, "%d node(s) not reached from the root\n", pDag->orphans );
+    say( pRepo, "\n" );
+
+    return 0;
+}
+
+// Release a strategy read from its file
+void freeDag( Repo* pRepo )
+{
+    Dag* pDag = pRepo->dag;
+
+    if( pDag == NULL ) return;
+    free( pDag->guess );
+    free( pDag->bracketed );
+    free( pDag->first );
+    free( pDag->mark );
+    free( pDag->child );
+    free( pDag->parents );
+    free( pDag->cands );
+    free( pDag->spare );
+    free( pDag->marks );
+    free( pDag->solved );
+    free( pDag );
+    pRepo->dag = NULL;
+}
+
+// Write the strategy of the solution just checked as a strategy file (--export-dag)
+// Only a solution with every pass checked, and no errors found, is exported - as for --export-table
+// The tree is walked depth first, and each node written once its children have been
+int exportDag( Repo* pRepo )
+{
+    Tree           tree;
+    DagHeader      header;
+    unsigned char* data   = NULL;
+    unsigned char* bigger = NULL;
+    int*           id     = NULL;                      // Position in the file of each tree node (-1 until written)
+    int*           stack  = NULL;                      // Path from the root to the node being visited
+    int*           cursor = NULL;                      // Next mark to look at below each node on the path
+    size_t         room   = 0;
+    size_t         size   = 0;
+    size_t         kids   = 0;
+    Node*          pNode  = NULL;
+    int            depth  = 0;
+    int            node   = 0;
+    int            child  = 0;
+    int            nodes  = 0;
+    int            m      = 0;
+    int            rc     = 0;
+
+    if( ( pRepo->checks & CHECK_DEFAULT ) != CHECK_DEFAULT )
+    {
+        fprintf( pRepo->err, "Not exporting %s - only a solution with every pass checked can be exported\n", pRepo->dagName );
+        return -1;
+    }
+    if( ! solutionValid( pRepo ) )
+    {
+        fprintf( pRepo->err, "Not exporting %s - the solution has errors\n", pRepo->dagName );
+        return -1;
+    }
+
+    rc = buildTree( pRepo, &tree ); if( rc ) return rc;
+    room   = (size_t)tree.nodes * 4 + 64;
+    data   = (unsigned char*)malloc( room );
+    id     = (int*)malloc( sizeof(int) * tree.nodes );
+    stack  = (int*)malloc( sizeof(int) * tree.nodes );
+    cursor = (int*)malloc( sizeof(int) * tree.nodes );
+    if( data == NULL || id == NULL || stack == NULL || cursor == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate arrays in exportDag\n" );
+        rc = -1;
+    }
+
+    memset( &header, 0, sizeof(header) );
+    if( rc == 0 && tree.node[0].guess != -1 )
+    {
+        stack[depth++] = 0;
+        cursor[0]      = 0;
+    }
+    while( rc == 0 && depth > 0 )
+    {
+        node = stack[depth-1];
+
+        // Go down to the next child not yet written
+        for( m = cursor[node]; m < tree.marks; m++ )
+        {
+            child = tree.child[node * tree.marks + m];
+            if( child != -1 && tree.node[child].guess != -1 ) break;
+        }
+        if( m < tree.marks )
+        {
+            cursor[node]   = m + 1;
+            cursor[child]  = 0;
+            stack[depth++] = child;
+            continue;
+        }
+
+        // Every child is written, so this node can be
+        if( room - size < 16 + (size_t)tree.marks * 6 )
+        {
+            room   = room * 2 + (size_t)tree.marks * 6;
+            bigger = (unsigned char*)realloc( data, room );
+            if( bigger == NULL )
+            {
+                fprintf( pRepo->err, "Failed to grow strategy in exportDag\n" );
+                rc = -1;
+                break;
+            }
+            data = bigger;
+        }
+        pNode = &tree.node[node];
+        size += putVarint( data + size, (uint64_t)pNode->guess * 2 + pRepo->data[pNode->line].turns[pNode->depth].bracketed );
+        kids  = size++;
+        data[kids] = 0;
+        for( m = 0; m < tree.marks; m++ )
+        {
+            child = tree.child[node * tree.marks + m];
+            if( child == -1 || tree.node[child].guess == -1 ) continue;
+            data[size++] = m;
+            size += putVarint( data + size, nodes - id[child] );
+            data[kids] += 1;
+        }
+        if( (uint32_t)pNode->depth + 1 > header.depth ) header.depth = pNode->depth + 1;
+        id[node] = nodes++;
+        depth   -= 1;
+    }
+
+    if( rc == 0 )
+    {
+        memcpy( header.magic, DAG_MAGIC, 8 );
+        header.version  = DAG_VERSION;
+        header.pegs     = pRepo->pegs;
+        header.colours  = pRepo->colours;
+        header.codes    = pRepo->codes;
+        header.marks    = tree.marks;
+        header.nodes    = nodes;
+        header.first    = tree.node[0].guess == -1 ? 0 : tree.node[0].guess;
+        header.size     = size;
+        header.checksum = cacheChecksum( data, size );
+        rc = writeDag( pRepo, pRepo->dagName, &header, data );
+    }
+    if( rc == 0 )
+        say( pRepo, "Strategy of %u nodes written to %s (%llu bytes)\n\n", header.nodes, pRepo->dagName,
+             (unsigned long long)( sizeof(DagHeader) + size ) );
+
+    free( data );
+    free( id );
+    free( stack );
+    free( cursor );
+    freeTree( &tree );
+    return rc;
+}
+
+// Read a number written 7 bits to a byte, lowest first, with the top bit set on every byte but the last
+// Returns false if the number runs past the end of the data, or is too long to be one written here
+static bool getVarint( const unsigned char* data, uint64_t size, uint64_t* pPos, uint64_t* pValue )
+{
+    uint64_t value = 0;
+    int      shift = 0;
+
+    for( shift = 0; shift < 35 && *pPos < size; shift += 7 )
+    {
+        value |= (uint64_t)( data[*pPos] & 0x7F ) << shift;
+        if( ( data[(*pPos)++] & 0x80 ) == 0 )
+        {
+            *pValue = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Write a number 7 bits to a byte (as getVarint reads it) - returns the bytes used
+static size_t putVarint( unsigned char* data, uint64_t value )
+{
+    size_t n = 0;
+
+    while( value >= 0x80 )
+    {
+        data[n++] = (unsigned char)( value | 0x80 );
+        value   >>= 7;
+    }
+    data[n++] = (unsigned char)value;
+    return n;
+}
+
+// Write the file under a temporary name which is then renamed, so it is never seen half written
+static int writeDag( Repo* pRepo, char* name, DagHeader* pHeader, unsigned char* data )
+{
+    char     temp[520];
+    uint64_t done    = 0;
+    ssize_t  written = 0;
+    int      fd      = -1;
+    int      rc      = 0;
+
+    snprintf( temp, sizeof(temp), "%s.XXXXXX", name );
+    fd = mkstemp( temp );
+    if( fd == -1 )
+    {
+        fprintf( pRepo->err, "Unable to write strategy %s (%s)\n", name, strerror( errno ) );
+        return -1;
+    }
+
+    if( write( fd, pHeader, sizeof(DagHeader) ) != sizeof(DagHeader) ) rc = -1;
+    while( rc == 0 && done < pHeader->size )
+    {
+        written = write( fd, data + done, pHeader->size - done );
+        if( written <= 0 ) rc = -1;
+        else done += written;
+    }
+    if( rc == 0 && fchmod( fd, 0644 ) != 0 ) rc = -1;
+    if( close( fd ) != 0 ) rc = -1;
+    if( rc == 0 && rename( temp, name ) != 0 ) rc = -1;
+
+    if( rc != 0 )
+    {
+        fprintf( pRepo->err, "Unable to write strategy %s (%s)\n", name, strerror( errno ) );
+        unlink( temp );
+    }
+    return rc;
+}
@@ -0,0 +1,77 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMDAG_H
+#define MMDAG_H
+
+#include "MMchk.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DAG_MAGIC              "MMchkDAG"
+#define DAG_VERSION            1                       // Change whenever the layout of the nodes changes
+#define DAG_MAX_MARKS          ( MAX_PEGS * ( MAX_PEGS + 3 ) / 2 )
+#define DAG_MAX_DEPTH          64                      // Deepest node walked - codes below it are taken as not solved
+
+// Start of a strategy file - the nodes follow straight after
+// Each node is: varint (guess * 2 + 1 if bracketed), a byte giving its number of children, then for each child (in
+// mark order) a byte for the mark and a varint for how many nodes back the child is
+// Children always come before their parent, so the root is the last node and there can be no loops
+// A child may be shared by more than one parent (a DAG) - it is walked from each, with that parent's candidates
+typedef struct DagHeader
+{
+    char     magic[8];                                 // DAG_MAGIC
+    uint32_t version;                                  // DAG_VERSION
+    uint32_t pegs;
+    uint32_t colours;
+    uint32_t codes;
+    uint32_t marks;                                    // Possible marks, the last being all-black
+    uint32_t nodes;
+    uint32_t depth;                                    // Most guesses taken by any code
+    uint32_t first;                                    // Guess made at the root
+    uint64_t size;                                     // Bytes of nodes following the header
+    uint64_t checksum;                                 // Of the nodes, to catch a corrupt file
+    uint8_t  spare[8];                                 // Pad to 64 bytes
+} DagHeader;
+
+// A strategy read from its file, and what walking it found
+typedef struct Dag
+{
+    DagHeader  header;
+    int*       guess;                                  // Guess made at each node
+    bool*      bracketed;                              // Is the guess shown in brackets (as not a possible code)?
+    int*       first;                                  // Each node's first child in mark[] and child[] (first[nodes] ends the last)
+    uint8_t*   mark;                                   // Mark leading to each child
+    int*       child;                                  // Node each child is
+    int*       parents;                                // Number of nodes each node is a child of
+    int*       cands;                                  // Codes still possible, shared out between the children going down
+    int*       spare;                                  // Room to share them out in
+    char*      marks;                                  // Mark of each candidate against the guess at its node
+    uint64_t*  solved;                                 // Bitmap of the codes solved
+    long long  TTTS;
+    int        worst;                                  // Most guesses taken by any code
+    int        unsolved;                               // Codes the strategy doesn't solve
+    int        unreachable;                            // Children for marks no remaining code can give
+    int        wrongBrackets;                          // Guesses bracketed when they could be the code, or not when they can't
+    int        orphans;                                // Nodes that aren't reached from the root
+    bool       tooDeep;                                // Some codes are more than DAG_MAX_DEPTH guesses down
+} Dag;
+
+bool isDag( Repo* pRepo );
+int  dagCheck( Repo* pRepo );
+int  readDag( Repo* pRepo );
+int  walkDag( Repo* pRepo );
+void walkNode( Repo* pRepo, Dag* pDag, int node, int lo, int hi, int depth );
+int  reportDag( Repo* pRepo );
+void freeDag( Repo* pRepo );
+int  exportDag( Repo* pRepo );
+
+#endif  /* MMDAG_H */
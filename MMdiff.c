@@ -0,0 +1,248 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Structural diff of two solutions - where do their strategy trees differ, and what does it cost?
+// Each tree gets a hash for every subtree, so the walk over the two trees skips any subtree that is the same in both
+//
+#include "MMdiff.h"
+#include "MMchk.h"
+#include "MMparams.h"
+#include "MMutility.h"
+#include "MMtree.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DIFF_PATH_LEN          1024                    // Room for the guesses and marks leading to a node
+
+// Compare the solution in pRepo with the one named by --diff, and report where the strategies differ
+int diffSolutions( Repo* pRepo )
+{
+    Repo  other;
+    Diff  diff;
+    char  path[DIFF_PATH_LEN];
+    int   rc    = 0;
+
+    memset( &diff, 0, sizeof(diff) );
+    diff.pRepoA = pRepo;
+    diff.pRepoB = &other;
+
+    // The second solution gets a repository of its own, with the same options
+    initRepo( &other );
+    other.threads = pRepo->threads;
+    other.out     = pRepo->out;
+    rc = openSolution( &other, pRepo->diffName ); if( rc ) return rc;
+
+    rc = loadTree( pRepo, &diff.treeA );
+    if( rc == 0 ) rc = loadTree( &other, &diff.treeB );
+    if( rc == 0 && ( pRepo->pegs != other.pegs || pRepo->colours != other.colours ) )
+    {
+        fprintf( pRepo->err, "Can't compare solutions for different puzzles (%d,%d) and (%d,%d)\n", pRepo->pegs, pRepo->colours, other.pegs, other.colours );
+        rc = -1;
+    }
+    if( rc == 0 ) rc = summariseTree( pRepo, &diff.treeA, &diff.subA );
+    if( rc == 0 ) rc = summariseTree( &other, &diff.treeB, &diff.subB );
+
+    if( rc == 0 )
+    {
+        say( pRepo, "\nDifferences between %s and %s:\n", pRepo->baseName, other.baseName );
+        path[0] = '\0';
+        diffNodes( &diff, 0, 0, path );
+
+        if( diff.differences == 0 )
+            say( pRepo, "  The strategies are the same\n" );
+        say( pRepo, "  Overall: TTTS %ld -> %ld (%+ld), worst case %d -> %d, %d subtree(s) differ\n\n",
+             diff.subA[0].TTTS, diff.subB[0].TTTS, diff.subB[0].TTTS - diff.subA[0].TTTS,
+             diff.subA[0].worst, diff.subB[0].worst, diff.differences );
+    }
+
+    free( diff.subA );
+    free( diff.subB );
+    freeTree( &diff.treeA );
+    freeTree( &diff.treeB );
+    freeRepo( &other );
+    return rc;
+}
+
+// Read a solution and build its strategy tree
+// The file is read twice, as when checking it: the lines must be counted to know the number of colours (when the name
+// doesn't give it) before any code can be parsed.  The tree is then built from the parsed lines, without the file
+int loadTree( Repo* pRepo, Tree* pTree )
+{
+    int rc = 0;
+
+    rc = parseHeader( pRepo );       if( rc ) return rc;    // Check header and find max number of guesses
+    rc = countPegs( pRepo );         if( rc ) return rc;    // Return the number of pegs in each code
+    rc = countCodes( pRepo );        if( rc ) return rc;    // Return the number of codes listed in the solution file
+    rc = parseFile( pRepo );         if( rc ) return rc;    // Read the whole file into data structures
+    rc = setupCodeDefs( pRepo );     if( rc ) return rc;    // Needed to print codes
+    rc = checkCounts( pRepo );       if( rc ) return rc;    // Find how many turns each line really takes
+
+    return buildTree( pRepo, pTree );
+}
+
+// Work out the hash, number of codes, TTTS and worst case of every subtree
+// Children are always added after their parents, so working back from the last node sees every child before its parent
+int summariseTree( Repo* pRepo, Tree* pTree, Subtree** pSub )
+{
+    Solution* pSoln    = NULL;
+    Subtree*  sub      = NULL;
+    int       allBlack = pTree->marks - 1;
+    int       node     = 0;
+    int       child    = 0;
+    int       turns    = 0;
+    int       m        = 0;
+    int       i        = 0;
+    int       g        = 0;
+
+    sub = (Subtree*)calloc( pTree->nodes, sizeof(Subtree) );
+    if( sub == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate array in summariseTree\n" );
+        return -1;
+    }
+
+    // Find the node where each line's code is resolved
+    for( i = 0; i < pRepo->actualCodes; i++ )
+    {
+        pSoln = &pRepo->data[i];
+        node  = 0;
+        for( g = 0; g < pSoln->actualNoTurns && g < pRepo->guesses && node != -1; g++ )
+        {
+            if( pTree->node[node].guess != pSoln->turns[g].guess || pSoln->turns[g].mark < 0 ) break;
+            if( pSoln->turns[g].mark == allBlack )
+            {
+                turns = g + 1;
+                sub[node].codes += 1;
+                sub[node].TTTS  += turns;
+                if( turns > sub[node].worst ) sub[node].worst = turns;
+                break;
+            }
+            node = pTree->child[node * pTree->marks + pSoln->turns[g].mark];
+        }
+    }
+
+    // Now roll everything up the tree
+    for( node = pTree->nodes - 1; node >= 0; node-- )
+    {
+        sub[node].hash = mixHash( mixHash( 0, pTree->node[node].guess + 1 ), sub[node].codes );
+        for( m = 0; m < pTree->marks; m++ )
+        {
+            child = pTree->child[node * pTree->marks + m];
+            if( child == -1 ) continue;
+            sub[node].hash   = mixHash( mixHash( sub[node].hash, m ), sub[child].hash );
+            sub[node].codes += sub[child].codes;
+            sub[node].TTTS  += sub[child].TTTS;
+            if( sub[child].worst > sub[node].worst ) sub[node].worst = sub[child].worst;
+        }
+    }
+
+    *pSub = sub;
+    return 0;
+}
+
+// Compare node a of the first tree with node b of the second
+// Identical subtrees are skipped, a different guess is a changed subtree, otherwise look at where each mark leads
+void diffNodes( Diff* pDiff, int a, int b, char* path )
+{
+    Tree* pA     = &pDiff->treeA;
+    Tree* pB     = &pDiff->treeB;
+    char  code[MAX_PEGS+3];
+    char  mark[MAX_PEGS+2];
+    int   len    = strlen( path );
+    int   childA = 0;
+    int   childB = 0;
+    int   before = pDiff->differences;
+    int   m      = 0;
+
+    if( pDiff->subA[a].hash == pDiff->subB[b].hash ) return;
+
+    if( pA->node[a].guess != pB->node[b].guess )
+    {
+        reportSubtree( pDiff, "Changed", path, a, b );
+        return;
+    }
+
+    for( m = 0; m < pA->marks; m++ )
+    {
+        childA = pA->child[a * pA->marks + m];
+        childB = pB->child[b * pB->marks + m];
+        if( childA == -1 && childB == -1 ) continue;
+
+        snprintf( path + len, DIFF_PATH_LEN - len, "%s%s %s", len > 0 ? ", " : "",
+                  printGuess( pDiff->pRepoA, pA->node[a].guess, code ), printMark( pDiff->pRepoA, m, mark ) );
+        if( childB == -1 )
+            reportSubtree( pDiff, "Removed", path, childA, -1 );
+        else if( childA == -1 )
+            reportSubtree( pDiff, "Added", path, -1, childB );
+        else
+            diffNodes( pDiff, childA, childB, path );
+    }
+    path[len] = '\0';
+
+    // Same guess and the same subtrees below - so the difference is in whether the guess resolves a code here
+    if( pDiff->differences == before )
+        reportSubtree( pDiff, "Changed", path, a, b );
+}
+
+// Report one subtree that differs (a or b is -1 if the subtree is only in one of the solutions)
+void reportSubtree( Diff* pDiff, char* change, char* path, int a, int b )
+{
+    Repo* pRepo = pDiff->pRepoA;
+    char  codeA[MAX_PEGS+3];
+    char  codeB[MAX_PEGS+3];
+    char* where = path[0] != '\0' ? path : "the first guess";
+
+    if( pDiff->differences == 0 )
+        say( pRepo, "  First difference after: %s\n", where );
+    pDiff->differences += 1;
+
+    if( a != -1 && b != -1 )
+        say( pRepo, "  %-8s after %s: guess %s -> %s, %d -> %d codes, TTTS %ld -> %ld (%+ld), worst %d -> %d\n",
+             change, where,
+             printGuess( pRepo, pDiff->treeA.node[a].guess, codeA ), printGuess( pRepo, pDiff->treeB.node[b].guess, codeB ),
+             pDiff->subA[a].codes, pDiff->subB[b].codes,
+             pDiff->subA[a].TTTS, pDiff->subB[b].TTTS, pDiff->subB[b].TTTS - pDiff->subA[a].TTTS,
+             pDiff->subA[a].worst, pDiff->subB[b].worst );
+    else if( b != -1 )
+        say( pRepo, "  %-8s after %s: guess %s, %d codes, TTTS %ld, worst %d\n",
+             change, where, printGuess( pRepo, pDiff->treeB.node[b].guess, codeB ),
+             pDiff->subB[b].codes, pDiff->subB[b].TTTS, pDiff->subB[b].worst );
+    else
+        say( pRepo, "  %-8s after %s: guess %s, %d codes, TTTS %ld, worst %d\n",
+             change, where, printGuess( pRepo, pDiff->treeA.node[a].guess, codeA ),
+             pDiff->subA[a].codes, pDiff->subA[a].TTTS, pDiff->subA[a].worst );
+}
+
+// Construct the string for the guess made at a node - or "-" if no guess is made there
+// (A line that stops before all-black still leaves a node for the mark it stopped on)
+char* printGuess( Repo* pRepo, int guess, char* buffer )
+{
+    if( guess < 0 )
+    {
+        strcpy( buffer, "-" );
+        return buffer;
+    }
+    return printCode( pRepo, guess, true, buffer );
+}
+
+// Fold a value into a hash (the splitmix64 finaliser)
+uint64_t mixHash( uint64_t hash, uint64_t value )
+{
+    hash ^= value + 0x9e3779b97f4a7c15ULL + ( hash << 6 ) + ( hash >> 2 );
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
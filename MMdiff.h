@@ -0,0 +1,47 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMDIFF_H
+#define MMDIFF_H
+
+#include "MMchk.h"
+
+#include <stdint.h>
+
+// Summary of the subtree below a node of a strategy tree
+typedef struct Subtree
+{
+    uint64_t hash;                              // Hash of the guesses made throughout the subtree
+    int      codes;                             // Number of codes resolved in the subtree
+    long     TTTS;                              // Total turns to solve those codes
+    int      worst;                             // Most turns taken by any of them
+} Subtree;
+
+// The two solutions being compared
+typedef struct Diff
+{
+    Repo*    pRepoA;
+    Repo*    pRepoB;
+    Tree     treeA;
+    Tree     treeB;
+    Subtree* subA;
+    Subtree* subB;
+    int      differences;                       // Number of subtrees found to differ
+} Diff;
+
+int  diffSolutions( Repo* pRepo );
+int  loadTree( Repo* pRepo, Tree* pTree );
+int  summariseTree( Repo* pRepo, Tree* pTree, Subtree** pSub );
+void diffNodes( Diff* pDiff, int a, int b, char* path );
+void reportSubtree( Diff* pDiff, char* change, char* path, int a, int b );
+char* printGuess( Repo* pRepo, int guess, char* buffer );
+uint64_t mixHash( uint64_t hash, uint64_t value );
+
+#endif  /* MMDIFF_H */
@@ -0,0 +1,264 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Feasibility check (--feasibility) - is each guess bracketed exactly when it can no longer be the code?
+// The set of codes still possible is carried down the strategy tree as a bitset. At each node every candidate
+// is marked against the guess once, and dropped straight into the bitset of the child for its mark.
+// As a by-product the size of the candidate set at each node is written to an _NODES.csv file
+//
+#include "MMfeasible.h"
+#include "MMchk.h"
+#include "MMtree.h"
+#include "MMutility.h"
+#include "MMformat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Build the strategy tree, then work out the candidates at each node and check the brackets against them
+int checkFeasibility( Repo* pRepo )
+{
+    Feasible* pFeas      = NULL;
+    bool*     consistent = NULL;
+    int       codes      = pRepo->codes;
+    int       code       = 0;
+    int       rc         = 0;
+    int       i          = 0;
+
+    freeFeasible( pRepo );
+    pFeas = (Feasible*)calloc( 1, sizeof(Feasible) );
+    if( pFeas == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate feasibility check\n" );
+        return -1;
+    }
+    pRepo->feasible = pFeas;
+
+    // Building the tree flags lines that leave it, but consistency is checkGuesses' job - so keep its flags as they were
+    pFeas->pTree = (Tree*)calloc( 1, sizeof(Tree) );
+    consistent   = (bool*)malloc( sizeof(bool) * ( pRepo->actualCodes + 1 ) );
+    if( pFeas->pTree == NULL || consistent == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate feasibility check\n" );
+        free( consistent );
+        return -1;
+    }
+    for( i = 0; i < pRepo->actualCodes; i++ ) consistent[i] = pRepo->data[i].guessConsistant;
+    rc = buildTree( pRepo, pFeas->pTree );
+    for( i = 0; i < pRepo->actualCodes; i++ ) pRepo->data[i].guessConsistant = consistent[i];
+    free( consistent );
+    if( rc ) return rc;
+
+    pFeas->words      = bitmapWords( codes );
+    pFeas->depths     = pRepo->guesses + 1;
+    pFeas->marks      = pFeas->pTree->marks;
+    pFeas->cands      = (uint64_t*)calloc( pFeas->words, sizeof(uint64_t) );
+    pFeas->split      = (uint64_t*)malloc( sizeof(uint64_t) * pFeas->words * pFeas->marks * pFeas->depths );
+    pFeas->size       = (int*)calloc( pFeas->pTree->nodes, sizeof(int) );
+    pFeas->feasible   = (bool*)calloc( pFeas->pTree->nodes, sizeof(bool) );
+    pFeas->nodes      = (int*)calloc( pFeas->depths, sizeof(int) );
+    pFeas->total      = (long*)calloc( pFeas->depths, sizeof(long) );
+    pFeas->most       = (int*)calloc( pFeas->depths, sizeof(int) );
+    pFeas->singletons = (int*)calloc( pFeas->depths, sizeof(int) );
+    if( pFeas->cands == NULL || pFeas->split == NULL || pFeas->size == NULL || pFeas->feasible == NULL
+        || pFeas->nodes == NULL || pFeas->total == NULL || pFeas->most == NULL || pFeas->singletons == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate arrays in checkFeasibility\n" );
+        return -1;
+    }
+
+    // Every code is a candidate at the root
+    for( code = 0; code < codes; code++ ) setBit( pFeas->cands, code );
+    if( pFeas->pTree->node[0].guess != -1 ) feasibleNode( pRepo, pFeas, 0, 0, pFeas->cands, codes, codes + 1 );
+
+    checkBrackets( pRepo, pFeas );
+    return writeNodes( pRepo, pFeas );
+}
+
+// Visit a node with its candidates (size of them) - then share them out between the children and visit each
+// Each candidate is marked against the guess once, and set in the bitset of the child for its mark (if there is one)
+void feasibleNode( Repo* pRepo, Feasible* pFeas, int node, int depth, uint64_t* cands, int size, int parentSize )
+{
+    Tree*     pTree = pFeas->pTree;
+    uint64_t* split = pFeas->split + (size_t)pFeas->words * pFeas->marks * depth;
+    uint64_t  bits  = 0;
+    int       count[pFeas->marks];
+    int       child[pFeas->marks];
+    int       guess = pTree->node[node].guess;
+    int       code  = 0;
+    int       mark  = 0;
+    int       m     = 0;
+    int       w     = 0;
+
+    pFeas->size[node]     = size;
+    pFeas->feasible[node] = guess >= 0 && guess < pRepo->codes && testBit( cands, guess );
+    if( ! pFeas->feasible[node] ) pFeas->infeasible += 1;
+    pFeas->nodes[depth]  += 1;
+    pFeas->total[depth]  += size;
+    if( size > pFeas->most[depth] ) pFeas->most[depth] = size;
+    if( size == 1 && parentSize > 1 ) pFeas->singletons[depth] += 1;
+
+    if( guess < 0 || guess >= pRepo->codes || depth + 1 >= pFeas->depths ) return;
+
+    // Only the bitsets of marks that lead somewhere are cleared and filled
+    for( m = 0; m < pFeas->marks; m++ )
+    {
+        count[m] = 0;
+        child[m] = pTree->child[node * pTree->marks + m];
+        if( child[m] != -1 ) memset( split + (size_t)pFeas->words * m, 0, sizeof(uint64_t) * pFeas->words );
+    }
+
+    for( w = 0; w < pFeas->words; w++ )
+        for( bits = cands[w]; bits != 0; bits &= bits - 1 )
+        {
+            code = w * 64 + __builtin_ctzll( bits );
+            mark = marking( pRepo, guess, code );
+            if( mark < 0 || mark >= pFeas->marks || child[mark] == -1 ) continue;
+            split[(size_t)pFeas->words * mark + w] |= bits & -bits;
+            count[mark] += 1;
+        }
+
+    for( m = 0; m < pFeas->marks; m++ )
+        if( child[m] != -1 )
+            feasibleNode( pRepo, pFeas, child[m], depth + 1, split + (size_t)pFeas->words * m, count[m], size );
+}
+
+// Walk each line down the tree, checking its brackets against the candidates at each node it reaches
+// A line stops where it leaves the tree (an inconsistent guess, already reported as such)
+void checkBrackets( Repo* pRepo, Feasible* pFeas )
+{
+    Tree*     pTree    = pFeas->pTree;
+    Solution* pSoln    = NULL;
+    int       allBlack = pTree->marks - 1;
+    int       node     = 0;
+    int       mark     = 0;
+    int       i        = 0;
+    int       g        = 0;
+
+    for( i = 0; i < pRepo->actualCodes; i++ )
+    {
+        pSoln = &pRepo->data[i];
+        node  = 0;
+        for( g = 0; g < pSoln->actualNoTurns && g < pRepo->guesses && node != -1; g++ )
+        {
+            if( pTree->node[node].guess != pSoln->turns[g].guess ) break;
+
+            if( pSoln->turns[g].guessOK && pSoln->turns[g].bracketed == pFeas->feasible[node] )
+            {
+                pSoln->turns[g].bracketOK = false;
+                pSoln->bracketsOK         = false;
+                pFeas->wrong             += 1;
+            }
+
+            mark = pSoln->turns[g].mark;
+            if( mark < 0 || mark >= allBlack ) break;
+            node = pTree->child[node * pTree->marks + mark];
+        }
+    }
+}
+
+// Write the candidates at each node to an _NODES.csv file alongside the solution
+// Nothing is written if files are not to be written alongside the solution (as with the _ERRORS.csv file)
+int writeNodes( Repo* pRepo, Feasible* pFeas )
+{
+    Tree*  pTree = pFeas->pTree;
+    OutBuf out;
+    FILE*  fpo   = NULL;
+    int    len   = 0;
+    int    n     = 0;
+    int    rc    = 0;
+
+    if( ! pRepo->errorsFile ) return 0;
+    snprintf( pFeas->nodesName, 256, "%s", pRepo->filename );
+    len = strlen( pFeas->nodesName );
+    if( len >= 4 && strcmp( pFeas->nodesName + len - 4, ".csv" ) == 0 ) len -= 4;
+    snprintf( pFeas->nodesName + len, 256 - len, "_NODES.csv" );
+
+    fpo = fopen( pFeas->nodesName, "w" );
+    if( fpo == NULL )
+    {
+        fprintf( pRepo->err, "Unable to open file: %s\n", pFeas->nodesName );
+        return -1;
+    }
+
+    if( openOut( &out, pRepo, fpo ) )
+    {
+        fclose( fpo );
+        return -1;
+    }
+
+    // Guesses are shown as they should be - in brackets if they can't be the code
+    putString( &out, "Node,Turn,Line,Guess,Candidates\n" );
+    for( n = 0; n < pTree->nodes; n++ )
+    {
+        if( pTree->node[n].guess < 0 || pTree->node[n].guess >= pRepo->codes ) continue;
+        putNumber( &out, n );
+        putChar( &out, ',' );
+        putNumber( &out, pTree->node[n].depth + 1 );
+        putChar( &out, ',' );
+        putNumber( &out, pTree->node[n].line + 2 );
+        putChar( &out, ',' );
+        putCode( &out, pTree->node[n].guess, pFeas->feasible[n] );
+        putChar( &out, ',' );
+        putNumber( &out, pFeas->size[n] );
+        putChar( &out, '\n' );
+    }
+    rc = closeOut( &out );
+    if( fclose( fpo ) != 0 ) rc = -1;
+    if( rc ) fprintf( pRepo->err, "Unable to write all of %s\n", pFeas->nodesName );
+    return rc;
+}
+
+// Summarise the candidate sets, depth by depth - after the main report
+int reportFeasibility( Repo* pRepo )
+{
+    Feasible* pFeas = pRepo->feasible;
+    int       d     = 0;
+
+    if( pFeas == NULL ) return 0;
+
+    say( pRepo, "Feasibility:   %d of %d guesses could not be the code, ", pFeas->infeasible, pFeas->pTree->nodes );
+    if( pFeas->wrong == 0 )
+        say( pRepo, "all bracketed correctly\n" );
+    else
+        say( pRepo, "%d guess(es) bracketed wrongly\n", pFeas->wrong );
+    say( pRepo, "Turn    Nodes   Mean candidates   Most candidates   Singletons\n" );
+    for( d = 0; d < pFeas->depths; d++ )
+        if( pFeas->nodes[d] > 0 )
+            say( pRepo, "%4d %8d %17.1f %17d %12d\n", d + 1, pFeas->nodes[d], (double)pFeas->total[d] / pFeas->nodes[d],
+                 pFeas->most[d], pFeas->singletons[d] );
+    if( pFeas->nodesName[0] != '\0' )
+        say( pRepo, "Candidates at each node are in %s\n", pFeas->nodesName );
+    say( pRepo, "\n" );
+
+    return 0;
+}
+
+// Release the feasibility check
+void freeFeasible( Repo* pRepo )
+{
+    Feasible* pFeas = pRepo->feasible;
+
+    if( pFeas == NULL ) return;
+    if( pFeas->pTree != NULL ) freeTree( pFeas->pTree );
+    free( pFeas->pTree );
+    free( pFeas->cands );
+    free( pFeas->split );
+    free( pFeas->size );
+    free( pFeas->feasible );
+    free( pFeas->nodes );
+    free( pFeas->total );
+    free( pFeas->most );
+    free( pFeas->singletons );
+    free( pFeas );
+    pRepo->feasible = NULL;
+}
@@ -0,0 +1,45 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMFEASIBLE_H
+#define MMFEASIBLE_H
+
+#include "MMchk.h"
+
+#include <stdint.h>
+
+// Candidate sets down the strategy tree, and what was found in them
+typedef struct Feasible
+{
+    struct Tree* pTree;
+    int          words;                                // Words in each candidate bitset
+    int          depths;                               // Deepest level of the tree, plus one
+    int          marks;                                // Possible marks (children per node)
+    uint64_t*    cands;                                // Candidate bitset at the root (every code)
+    uint64_t*    split;                                // Candidates of each child, by mark, of the node visited at each depth
+    int*         size;                                 // Number of candidates at each node
+    bool*        feasible;                             // Could the guess at each node be the code?
+    int*         nodes;                                // Nodes at each depth
+    long*        total;                                // Total candidates over the nodes at each depth
+    int*         most;                                 // Most candidates at any node at each depth
+    int*         singletons;                           // Nodes at each depth where the candidates first come down to one
+    int          infeasible;                           // Nodes whose guess can't be the code
+    int          wrong;                                // Turns with brackets that don't match the candidates
+    char         nodesName[256];                       // File the candidates at each node were written to
+} Feasible;
+
+int  checkFeasibility( Repo* pRepo );
+void feasibleNode( Repo* pRepo, Feasible* pFeas, int node, int depth, uint64_t* cands, int size, int parentSize );
+void checkBrackets( Repo* pRepo, Feasible* pFeas );
+int  writeNodes( Repo* pRepo, Feasible* pFeas );
+int  reportFeasibility( Repo* pRepo );
+void freeFeasible( Repo* pRepo );
+
+#endif  /* MMFEASIBLE_H */
@@ -0,0 +1,141 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Bulk output - the missing code lists, the _ERRORS.csv and _NODES.csv files, and anything else with a line (or a
+// code) for every code in the puzzle.  Codes are written from a table of peg letters, numbers from a table of digit
+// pairs, and everything is gathered into a large buffer which is written a buffer at a time
+//
+#include "MMformat.h"
+#include "MMchk.h"
+#include "MMutility.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Every pair of decimal digits, so numbers are written two digits to a division
+static const char digitPairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Fill the table of peg letters - as many pegs to an entry as keep it within FORMAT_CODES entries
+void initFormat( CodeFormat* pFormat, int pegs, int colours )
+{
+    int entry = 0;
+    int value = 0;
+    int i     = 0;
+
+    pFormat->pegs       = pegs;
+    pFormat->chunk      = 1;
+    pFormat->chunkCodes = colours;
+    while( pFormat->chunk < pegs && pFormat->chunk < FORMAT_WIDTH && pFormat->chunkCodes * colours <= FORMAT_CODES )
+    {
+        pFormat->chunk      += 1;
+        pFormat->chunkCodes *= colours;
+    }
+
+    for( entry = 0; entry < pFormat->chunkCodes; entry++ )
+    {
+        for( value = entry, i = FORMAT_WIDTH - 1; i >= FORMAT_WIDTH - pFormat->chunk; i-- )
+        {
+            pFormat->table[entry][i] = 'A' + value % colours;
+            value /= colours;
+        }
+    }
+}
+
+// Start gathering output for fp, with codes written for the puzzle in pRepo
+int openOut( OutBuf* pOut, Repo* pRepo, FILE* fp )
+{
+    pOut->fp     = fp;
+    pOut->used   = 0;
+    pOut->failed = false;
+    pOut->data   = (char*)malloc( OUT_BUFFER );
+    if( pOut->data == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate output buffer\n" );
+        return -1;
+    }
+    initFormat( &pOut->format, pRepo->pegs, pRepo->colours );
+    return 0;
+}
+
+// Write out what has been gathered so far
+int flushOut( OutBuf* pOut )
+{
+    if( pOut->used > 0 && fwrite( pOut->data, 1, pOut->used, pOut->fp ) != pOut->used ) pOut->failed = true;
+    pOut->used = 0;
+    return pOut->failed ? -1 : 0;
+}
+
+// Write out the rest and release the buffer (the file is left open) - returns -1 if any of it could not be written
+int closeOut( OutBuf* pOut )
+{
+    int rc = 0;
+
+    if( pOut->data == NULL ) return -1;
+    rc = flushOut( pOut );
+    free( pOut->data );
+    pOut->data = NULL;
+    return rc;
+}
+
+// Write a number in decimal
+void putNumber( OutBuf* pOut, long long value )
+{
+    char               digits[24];
+    char*              p    = digits + sizeof(digits);
+    unsigned long long left = value < 0 ? -(unsigned long long)value : (unsigned long long)value;
+
+    while( left >= 100 )
+    {
+        p    -= 2;
+        memcpy( p, digitPairs + ( left % 100 ) * 2, 2 );
+        left /= 100;
+    }
+    if( left >= 10 )
+    {
+        p -= 2;
+        memcpy( p, digitPairs + left * 2, 2 );
+    }
+    else
+        *--p = '0' + left;
+    if( value < 0 ) *--p = '-';
+
+    putText( pOut, p, digits + sizeof(digits) - p );
+}
+
+// Say the codes whose bits are set in the bitmap (or clear, if clear is given), eg "  AAB,ACC" - on one line
+void listCodes( Repo* pRepo, const uint64_t* map, bool clear )
+{
+    OutBuf   out;
+    uint64_t bits  = 0;
+    int      words = bitmapWords( pRepo->codes );
+    int      w     = 0;
+    int      j     = 0;
+
+    if( pRepo->out == NULL ) return;
+    if( openOut( &out, pRepo, pRepo->out ) ) return;
+
+    for( w = 0; w < words; w++ )
+    {
+        bits = clear ? ~map[w] : map[w];
+        if( w == words - 1 && pRepo->codes % 64 != 0 ) bits &= ( 1ULL << ( pRepo->codes % 64 ) ) - 1;
+        for( ; bits != 0; bits &= bits - 1, j++ )
+        {
+            putText( &out, j == 0 ? "  " : ",", j == 0 ? 2 : 1 );
+            putCode( &out, w * 64 + __builtin_ctzll( bits ), true );
+        }
+    }
+    putChar( &out, '\n' );
+    closeOut( &out );
+}
@@ -0,0 +1,110 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMFORMAT_H
+#define MMFORMAT_H
+
+#include "MMchk.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef OUT_BUFFER
+#define OUT_BUFFER             ( 1 << 20 )             // Bytes of output gathered before each write (can be set when building)
+#endif
+#define FORMAT_CODES           4096                    // Most entries in the table of peg letters
+#define FORMAT_WIDTH           8                       // Most pegs looked up at once
+
+// Peg letters for every value of the lowest few pegs of a code - a code is written a chunk of pegs at a time from
+// the right, each chunk being one lookup (and one division), rather than a division for every peg
+typedef struct CodeFormat
+{
+    int   pegs;
+    int   chunk;                                       // Pegs in each entry of the table
+    int   chunkCodes;                                  // Entries in the table - colours ^ chunk
+    char  table[FORMAT_CODES][FORMAT_WIDTH];           // Letters of each entry, right aligned
+} CodeFormat;
+
+// Output gathered in a large buffer and written a buffer at a time, rather than a few bytes at a time through stdio
+typedef struct OutBuf
+{
+    FILE*      fp;
+    char*      data;
+    size_t     used;
+    bool       failed;                                 // Has a write failed?
+    CodeFormat format;
+} OutBuf;
+
+void  initFormat( CodeFormat* pFormat, int pegs, int colours );
+int   openOut( OutBuf* pOut, Repo* pRepo, FILE* fp );
+int   flushOut( OutBuf* pOut );
+int   closeOut( OutBuf* pOut );
+void  putNumber( OutBuf* pOut, long long value );
+void  listCodes( Repo* pRepo, const uint64_t* map, bool clear );
+
+// Write the letters of a code (in brackets if it is not feasible) - returns the number of characters written
+// NOTE - There MUST be Pegs+2 bytes space available in out (it is not terminated)
+static inline int formatCode( const CodeFormat* pFormat, int code, bool feasible, char* out )
+{
+    char* end  = out + pFormat->pegs + ( feasible ? 0 : 1 );
+    int   left = pFormat->pegs;
+    int   n    = 0;
+
+    if( ! feasible )
+    {
+        out[0] = '(';
+        end[0] = ')';
+    }
+    while( left > 0 )
+    {
+        n     = left < pFormat->chunk ? left : pFormat->chunk;
+        end  -= n;
+        memcpy( end, pFormat->table[code % pFormat->chunkCodes] + FORMAT_WIDTH - n, n );
+        code /= pFormat->chunkCodes;
+        left -= n;
+    }
+    return pFormat->pegs + ( feasible ? 0 : 2 );
+}
+
+// Make room for len more bytes - writing out what is held if need be
+static inline char* roomOut( OutBuf* pOut, size_t len )
+{
+    if( pOut->used + len > OUT_BUFFER ) flushOut( pOut );
+    return pOut->data + pOut->used;
+}
+
+static inline void putText( OutBuf* pOut, const char* text, size_t len )
+{
+    if( len > OUT_BUFFER )
+    {
+        flushOut( pOut );
+        if( fwrite( text, 1, len, pOut->fp ) != len ) pOut->failed = true;
+        return;
+    }
+    memcpy( roomOut( pOut, len ), text, len );
+    pOut->used += len;
+}
+
+static inline void putString( OutBuf* pOut, const char* text )    { putText( pOut, text, strlen( text ) ); }
+
+static inline void putChar( OutBuf* pOut, char c )
+{
+    *roomOut( pOut, 1 ) = c;
+    pOut->used += 1;
+}
+
+static inline void putCode( OutBuf* pOut, int code, bool feasible )
+{
+    pOut->used += formatCode( &pOut->format, code, feasible, roomOut( pOut, MAX_PEGS + 2 ) );
+}
+
+#endif  /* MMFORMAT_H */
@@ -0,0 +1,138 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Kernels specialised for the commonly checked numbers of pegs and colours
+// Each kernel calls the same inline bodies with constant pegs and colours, so the compiler can unroll the loops
+// and turn the divisions into multiplications - the generic code is still used for any other combination
+//
+#include "MMkernels.h"
+#include "MMchk.h"
+#include "MMutility.h"
+
+#include <stdio.h>
+
+// Score a guess against a solution, breaking each code down into its pegs as it goes
+static inline char scoreBody( int guess, int solution, const int pegs, const int colours )
+{
+    unsigned char guessColours[MAX_COLOURS]    = { 0 };
+    unsigned char solutionColours[MAX_COLOURS] = { 0 };
+    int           black    = 0;
+    int           total    = 0;
+    int           g        = 0;
+    int           s        = 0;
+    int           i        = 0;
+
+    for( i = 0; i < pegs; i++ )
+    {
+        g = guess % colours;
+        s = solution % colours;
+        black += ( g == s );
+        guessColours[g]++;
+        solutionColours[s]++;
+        guess /= colours;
+        solution /= colours;
+    }
+
+    for( i = 0; i < colours; i++ )
+        total += solutionColours[i] < guessColours[i] ? solutionColours[i] : guessColours[i];
+
+    return markTranslation[black][total-black];
+}
+
+// Mark every code up to and including row against the code row - ie one row of the (triangular) marking array
+static inline void markRowBody( CodeDef* codeDefs, int row, char* marks, const int pegs, const int colours )
+{
+    CodeDef*      pRow     = &codeDefs[row];
+    CodeDef*      pCode    = NULL;
+    int           black    = 0;
+    int           total    = 0;
+    int           code     = 0;
+    int           i        = 0;
+
+    for( code = 0; code <= row; code++ )
+    {
+        pCode = &codeDefs[code];
+        black = 0;
+        total = 0;
+        for( i = 0; i < pegs; i++ )
+            black += ( pRow->peg[i] == pCode->peg[i] );
+        for( i = 0; i < colours; i++ )
+            total += pRow->colourFrequency[i] < pCode->colourFrequency[i] ? pRow->colourFrequency[i] : pCode->colourFrequency[i];
+        marks[code] = markTranslation[black][total-black];
+    }
+}
+
+// Fill in the pegs (least significant first) and colour frequencies of a code
+static inline void decodeBody( int code, CodeDef* pDef, const int pegs, const int colours )
+{
+    int i = 0;
+
+    for( i = 0; i < colours; i++ ) pDef->colourFrequency[i] = 0;
+    for( i = 0; i < pegs; i++ )
+    {
+        pDef->peg[i] = code % colours;
+        pDef->colourFrequency[code % colours] += 1;
+        code /= colours;
+    }
+}
+
+// Turn a string of peg letters (most significant first) into a code
+static inline int parseBody( char* szCode, const int pegs, const int colours )
+{
+    int code = 0;
+    int i    = 0;
+
+    for( i = 0; i < pegs; i++ )
+        code = code * colours + ( szCode[i] - 'A' );
+
+    return code;
+}
+
+// Write the peg letters of a code, most significant first
+static inline void printBody( int code, char* buffer, const int pegs, const int colours )
+{
+    int i = 0;
+
+    for( i = pegs - 1; i >= 0; i-- )
+    {
+        buffer[i] = 'A' + code % colours;
+        code /= colours;
+    }
+}
+
+// Generate the functions for each kernel in the list
+#define KERNEL( P, C ) \
+    static char score_##P##_##C( int guess, int solution )             { return scoreBody( guess, solution, P, C ); } \
+    static void markRow_##P##_##C( CodeDef* codeDefs, int row, char* marks ) { markRowBody( codeDefs, row, marks, P, C ); } \
+    static void decode_##P##_##C( int code, CodeDef* pDef )            { decodeBody( code, pDef, P, C ); } \
+    static int  parse_##P##_##C( char* szCode )                        { return parseBody( szCode, P, C ); } \
+    static void print_##P##_##C( int code, char* buffer )              { printBody( code, buffer, P, C ); }
+MM_KERNEL_LIST
+#undef KERNEL
+
+static const Kernel kernels[] =
+{
+#define KERNEL( P, C )  { P, C, score_##P##_##C, markRow_##P##_##C, decode_##P##_##C, parse_##P##_##C, print_##P##_##C },
+    MM_KERNEL_LIST
+#undef KERNEL
+};
+
+// Pick the kernel for the numbers of pegs and colours being checked, if there is one
+// Called once the pegs and colours are known - if none matches, kernel is left NULL and the generic code is used
+void selectKernel( Repo* pRepo )
+{
+    int i = 0;
+
+    pRepo->kernel = NULL;
+    for( i = 0; i < (int)( sizeof(kernels) / sizeof(kernels[0]) ); i++ )
+        if( kernels[i].pegs == pRepo->pegs && kernels[i].colours == pRepo->colours )
+            pRepo->kernel = &kernels[i];
+}
@@ -0,0 +1,36 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMKERNELS_H
+#define MMKERNELS_H
+
+#include "MMchk.h"
+
+// The (pegs, colours) combinations that get kernels of their own - anything else uses the generic code
+// Can be overridden when building, eg -DMM_KERNEL_LIST="KERNEL(4,6) KERNEL(7,7)"
+#ifndef MM_KERNEL_LIST
+#define MM_KERNEL_LIST      KERNEL(4,6) KERNEL(5,8) KERNEL(6,9)
+#endif
+
+// Hot functions, compiled with the numbers of pegs and colours fixed
+typedef struct Kernel
+{
+    int    pegs;
+    int    colours;
+    char   (*score)( int guess, int solution );                  // Mark for a guess against a solution
+    void   (*markRow)( CodeDef* codeDefs, int row, char* marks ); // Marks for codes 0..row against code row
+    void   (*decode)( int code, CodeDef* pDef );                  // Pegs and colour frequencies of a code
+    int    (*parse)( char* szCode );                              // Code for a string of peg letters
+    void   (*print)( int code, char* buffer );                    // Peg letters for a code (not terminated)
+} Kernel;
+
+void selectKernel( Repo* pRepo );
+
+#endif  /* MMKERNELS_H */
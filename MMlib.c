@@ -0,0 +1,185 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Library entry points - validate a solution held in a file, a memory buffer or supplied row by row
+//
+#include "MMlib.h"
+#include "MMchk.h"
+#include "MMparams.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Create a repository for in-process validation
+// Defaults are as for the command line, except that nothing is written unless asked for
+Repo* mmchkNew( void )
+{
+    Repo* pRepo = (Repo*)malloc( sizeof(Repo) );
+
+    if( pRepo == NULL )
+    {
+        fprintf( stderr, "Failed to allocate repository\n" );
+        return NULL;
+    }
+    initRepo( pRepo );
+    pRepo->out        = NULL;
+    pRepo->errorsFile = false;
+    pRepo->filename   = "";
+    strcpy( pRepo->baseName, "solution" );
+
+    return pRepo;
+}
+
+// Finished with a repository
+void mmchkDelete( Repo* pRepo )
+{
+    if( pRepo == NULL ) return;
+    freeRepo( pRepo );
+    free( pRepo );
+}
+
+// Validate a solution file
+int mmchkValidateFile( Repo* pRepo, char* filename, MMresult* pResult )
+{
+    int rc = 0;
+
+    freeRepo( pRepo );
+    rc = openSolution( pRepo, filename ); if( rc ) return rc;
+
+    return mmchkValidateOpen( pRepo, pResult );
+}
+
+// Validate a solution held in memory, laid out exactly as the file would be
+// The name is optional - if given it is used in the same way as a filename (eg to check the numbers of pegs and colours)
+int mmchkValidateBuffer( Repo* pRepo, char* name, const char* buffer, size_t length, MMresult* pResult )
+{
+    int rc = 0;
+
+    freeRepo( pRepo );
+    if( length == 0 )
+    {
+        fprintf( pRepo->err, "Empty solution buffer\n" );
+        return -1;
+    }
+
+    pRepo->fp = fmemopen( (void*)buffer, length, "r" );
+    if( pRepo->fp == NULL )
+    {
+        fprintf( pRepo->err, "Unable to read solution buffer\n" );
+        return -1;
+    }
+    pRepo->filename = name != NULL ? name : "";
+    if( name != NULL )
+        nameSolution( pRepo, name );
+    else
+        strcpy( pRepo->baseName, "solution" );
+
+    rc = mmchkValidateOpen( pRepo, pResult );
+
+    // The buffer belongs to the caller, so don't hang on to it
+    fclose( pRepo->fp );
+    pRepo->fp = NULL;
+    return rc;
+}
+
+// Validate a solution supplied one row at a time - starting with the header row
+// The rows are gathered into memory and then validated as a buffer
+int mmchkValidateRows( Repo* pRepo, char* name, MMrowFn nextRow, void* user, MMresult* pResult )
+{
+    FILE*       fp     = NULL;
+    char*       buffer = NULL;
+    size_t      length = 0;
+    const char* row    = NULL;
+    int         rc     = 0;
+
+    fp = open_memstream( &buffer, &length );
+    if( fp == NULL )
+    {
+        fprintf( pRepo->err, "Unable to gather solution rows\n" );
+        return -1;
+    }
+    while( ( row = nextRow( user ) ) != NULL )
+        fprintf( fp, "%s\n", row );
+    fclose( fp );
+
+    rc = mmchkValidateBuffer( pRepo, name, buffer, length, pResult );
+
+    free( buffer );
+    return rc;
+}
+
+// Validate the solution already opened in the repository and fill in the results (if wanted)
+int mmchkValidateOpen( Repo* pRepo, MMresult* pResult )
+{
+    int rc = 0;
+
+    rc = validate( pRepo );
+    if( pResult != NULL )
+        summarise( pRepo, pResult );
+
+    return rc;
+}
+
+// Summarise the findings held in the repository
+// (After a --fail-fast or sampled run, only what was checked before stopping is counted)
+void summarise( Repo* pRepo, MMresult* pResult )
+{
+    Solution* pSoln  = NULL;
+    bool      wrong  = false;
+    bool      badFmt = false;
+    int       i      = 0;
+    int       j      = 0;
+
+    memset( pResult, 0, sizeof(MMresult) );
+    pResult->pegs           = pRepo->pegs;
+    pResult->colours        = pRepo->colours;
+    pResult->codes          = pRepo->codes;
+    pResult->actualCodes    = pRepo->actualCodes;
+    pResult->pegsOK         = pRepo->pegsOK;
+    pResult->coloursOK      = pRepo->coloursOK;
+    pResult->codesOK        = pRepo->codesOK;
+    pResult->firstErrorLine = -1;
+
+    pResult->missingCodes   = pRepo->missingCodes;
+
+    for( i = 0; pRepo->data != NULL && i < pRepo->actualCodes; i++ )
+    {
+        pSoln = &pRepo->data[i];
+        pResult->TTTS += pSoln->noTurns > 0 ? pSoln->noTurns : 0;
+        if( pSoln->noTurns > pResult->worstCase ) pResult->worstCase = pSoln->noTurns;
+
+        if( ! solutionFault( pRepo, pSoln ) ) continue;
+
+        wrong  = false;
+        badFmt = ! pSoln->guessesOK;
+        for( j = 0; j < pSoln->actualNoTurns && j < pRepo->guesses; j++ )
+        {
+            if( ! pSoln->turns[j].markOK )  wrong  = true;
+            if( ! pSoln->turns[j].guessOK ) badFmt = true;
+        }
+
+        pResult->errorLines += 1;
+        if( ! pSoln->codeOK )          pResult->badCodes      += 1;
+        if( pSoln->codeRepeated )      pResult->repeatedCodes += 1;
+        if( ! pSoln->turnsOK )         pResult->wrongTurns    += 1;
+        if( ! pSoln->resolved )        pResult->unresolved    += 1;
+        if( wrong || ! pSoln->marksOK )pResult->wrongMarks    += 1;
+        if( badFmt )                   pResult->badGuesses    += 1;
+        if( ! pSoln->guessConsistant ) pResult->inconsistent  += 1;
+        if( ! pSoln->bracketsOK )      pResult->wrongBrackets += 1;
+        if( pResult->firstErrorLine == -1 || pSoln->line < pResult->firstErrorLine )
+            pResult->firstErrorLine = pSoln->line;
+    }
+
+    pResult->valid = pResult->errorLines == 0 && pResult->missingCodes == 0
+                  && pRepo->pegsOK && pRepo->coloursOK && pRepo->codesOK && pRepo->data != NULL;
+}
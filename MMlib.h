@@ -0,0 +1,71 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// The mmchk library - validate Mastermind solutions in-process
+//
+// Each repository (Repo) is a self contained context - there is no global state - so separate repositories...
+// ..may be used on separate threads at the same time.  A repository can be reused for a series of solutions.
+//
+//     Repo*    pRepo = mmchkNew();
+//     MMresult result;
+//     pRepo->replay = true;                                   // Options may be set directly
+//     mmchkValidateBuffer( pRepo, "SolnMM(4,6)_x.csv", csv, len, &result );
+//     if( result.valid ) ...
+//     mmchkDelete( pRepo );
+//
+// By default no report is written and no _ERRORS.csv file is created - set pRepo->out and pRepo->errorsFile to get them
+// Problems running a check are written to pRepo->err (stderr unless it is set elsewhere)
+//
+#ifndef MMLIB_H
+#define MMLIB_H
+
+#include "MMchk.h"
+
+#include <stddef.h>
+
+// Results of a validation, for callers that want more than the text report
+typedef struct MMresult
+{
+    bool         valid;                         // No errors of any kind were found
+    int          pegs;                          // Number of pegs in each code
+    int          colours;                       // Number of colours
+    int          codes;                         // Expected number of codes
+    int          actualCodes;                   // Number of codes (lines) in the solution
+    bool         pegsOK;                        // Pegs consistent with the name given?
+    bool         coloursOK;                     // Colours consistent with the name given?
+    bool         codesOK;                       // Expected number of codes?
+    int          missingCodes;                  // Codes not shown in the solution
+    int          errorLines;                    // Lines with an error of any kind
+    int          badCodes;                      // Lines where the code and its representation don't match
+    int          repeatedCodes;                 // Lines repeating an earlier code
+    int          wrongTurns;                    // Lines where the number of turns is incorrect
+    int          unresolved;                    // Lines not ending in all-black
+    int          wrongMarks;                    // Lines with one or more wrong marks
+    int          badGuesses;                    // Lines with badly formed guesses or marks
+    int          inconsistent;                  // Lines with inconsistent guesses
+    int          wrongBrackets;                 // Lines with a guess bracketed wrongly (only checked if CHECK_FEASIBILITY is in checks)
+    int          firstErrorLine;                // First line (not counting the header) with an error, -1 if none
+    long         TTTS;                          // Total turns to solve
+    int          worstCase;                     // Most turns taken to solve any code
+} MMresult;
+
+// Supplies the solution one row at a time (without the new line) - returns NULL after the last row
+typedef const char* (*MMrowFn)( void* user );
+
+Repo* mmchkNew( void );
+void  mmchkDelete( Repo* pRepo );
+int   mmchkValidateFile( Repo* pRepo, char* filename, MMresult* pResult );
+int   mmchkValidateBuffer( Repo* pRepo, char* name, const char* buffer, size_t length, MMresult* pResult );
+int   mmchkValidateRows( Repo* pRepo, char* name, MMrowFn nextRow, void* user, MMresult* pResult );
+int   mmchkValidateOpen( Repo* pRepo, MMresult* pResult );
+void  summarise( Repo* pRepo, MMresult* pResult );
+
+#endif  /* MMLIB_H */
@@ -0,0 +1,32 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Main function to setup, launch and report on the checking of a Mastermind solution
+// All of the checking is done by the mmchk library - this is just the command line front end
+//
+#include "MMchk.h"
+#include "MMparams.h"
+#include "MMprogress.h"
+
+// Program entry point
+int main( int argc, char **argv )
+{
+    Repo         repo;
+    int          rc = 0;
+
+    // Use the parameters passed (or defaults) to define the puzzle that is to be solved
+    rc = setup( &repo, argc, argv ); if( rc ) return rc;    // Setup repository and access file for analysis
+    rc = startProgress( &repo );     if( rc ) return rc;    // Progress lines (--progress) and SIGUSR1 snapshots
+    rc = validate( &repo );                                 // Run the checks and report on them
+
+    freeRepo( &repo );
+    return rc;
+}
@@ -13,23 +13,328 @@
 //
 #include "MMparams.h"
 #include "MMchk.h"
+#include "MMutility.h"
+#include "MMthreads.h"
+#include "MMkernels.h"
+#include "MMcache.h"
+#include "MMperf.h"
+#include "MMprogress.h"
+#include "MMscan.h"
+#include "MMfeasible.h"
+#include "MMdaemon.h"
+#include "MMdag.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <limits.h>
+#include <unistd.h>
 
 // Set up processing from parameters that may be passed when invoking the program
 // See help text for details  (run MMopt -h)
 int setup( Repo* pRepo, int argc, char **argv )
 {
-    FILE* fp           = NULL;
-    int   p             = 0;
-    int   c             = 0;
-    int   i             = 0;
     int   rc            = 0;
 
+    initRepo( pRepo );
+    rc = parseOptions( pRepo, argc, argv ); if( rc ) return rc;
+
+    if( pRepo->clientName != NULL )
+    {
+        pRepo->clientArgs     = &argv[1];     // Passed on to the daemon
+        pRepo->clientArgCount = argc - 1;
+        return 0;
+    }
+    if( pRepo->daemonName != NULL )
+        return 0;                    // The daemon opens each solution as it is asked for it
+    if( pRepo->benchName != NULL )
+        return 0;                    // Benchmarking only reads the decision table
+    if( pRepo->mergeCount > 0 )
+        return 0;                    // Merging only reads partial results, so there is no solution file to open
+    if( pRepo->filename == NULL )
+        pRepo->filename = "/Users/brucetandy/Documents/Mastermind/Results/SolnMM(4,6)_mes_1.csv";  // DEBUG
+
+    return openSolution( pRepo, pRepo->filename );
+}
+
+// Apply the options given (and take the solution filename from among them) - argv[0] is not looked at
+// The daemon uses this too, for the options sent with each request
+int parseOptions( Repo* pRepo, int argc, char **argv )
+{
+    char* value        = NULL;
+    int   i             = 0;
+    bool  feasibility   = false;
+
+    // Expecting one parameter, which should be a filename, possibly with some options
+    for( i = 1; i < argc; i++ )
+    {
+        if( strcmp( argv[i], "--fail-fast" ) == 0 )
+        {
+            pRepo->failFast = true;
+        }
+        else if( isOption( argv[i], "--sample" ) )
+        {
+            value = optionValue( argc, argv, &i );
+            pRepo->sampleSize = value != NULL ? stringToInt( value ) : -1;
+            if( pRepo->sampleSize <= 0 )
+            {
+                fprintf( pRepo->err, "--sample needs a number of lines\n" );
+                return -1;
+            }
+        }
+        else if( isOption( argv[i], "--sample-rate" ) )
+        {
+            value = optionValue( argc, argv, &i );
+            pRepo->sampleRate = value != NULL ? atof( value ) : 0;
+            if( pRepo->sampleRate <= 0 || pRepo->sampleRate > 1 )
+            {
+                fprintf( pRepo->err, "--sample-rate needs a proportion of lines, greater than 0 and up to 1\n" );
+                return -1;
+            }
+        }
+        else if( isOption( argv[i], "--seed" ) )
+        {
+            value = optionValue( argc, argv, &i );
+            pRepo->seed = value != NULL ? strtoull( value, NULL, 10 ) : 0;
+        }
+        else if( strcmp( argv[i], "--replay" ) == 0 )
+        {
+            pRepo->replay = true;
+        }
+        else if( isOption( argv[i], "--threads" ) )
+        {
+            value = optionValue( argc, argv, &i );
+            pRepo->threads = value != NULL ? stringToInt( value ) : -1;
+            if( pRepo->threads < 1 || pRepo->threads > MAX_THREADS )
+            {
+                fprintf( pRepo->err, "--threads needs a number of threads from 1 to %d\n", MAX_THREADS );
+                return -1;
+            }
+        }
+        else if( isOption( argv[i], "--mark-cache" ) )
+        {
+            pRepo->markCache = optionValue( argc, argv, &i );
+            if( pRepo->markCache == NULL || strlen( pRepo->markCache ) == 0 )
+            {
+                fprintf( pRepo->err, "--mark-cache needs a directory\n" );
+                return -1;
+            }
+        }
+        else if( isOption( argv[i], "--max-memory" ) )
+        {
+            value = optionValue( argc, argv, &i );
+            pRepo->maxMemory = value != NULL ? stringToSize( value ) : -1;
+            if( pRepo->maxMemory <= 0 )
+            {
+                fprintf( pRepo->err, "--max-memory needs a number of bytes (which may end in K, M or G)\n" );
+                return -1;
+            }
+        }
+        else if( isOption( argv[i], "--diff" ) )
+        {
+            pRepo->filename = optionValue( argc, argv, &i );
+            pRepo->diffName = i + 1 < argc ? argv[++i] : NULL;
+            if( pRepo->filename == NULL || pRepo->diffName == NULL )
+            {
+                fprintf( pRepo->err, "--diff needs two solution files\n" );
+                return -1;
+            }
+        }
+        else if( isOption( argv[i], "--shard" ) )
+        {
+            value = optionValue( argc, argv, &i );
+            if( value == NULL || sscanf( value, "%d/%d", &pRepo->shard, &pRepo->shards ) != 2
+                || pRepo->shards < 1 || pRepo->shard < 1 || pRepo->shard > pRepo->shards )
+            {
+                fprintf( pRepo->err, "--shard needs the shard to check and the number of shards, eg 2/8\n" );
+                return -1;
+            }
+        }
+        else if( strcmp( argv[i], "--merge" ) == 0 )
+        {
+            // Every following argument, up to the next option, is a partial result
+            pRepo->mergeNames = &argv[i+1];
+            while( i + 1 < argc && strncmp( argv[i+1], "--", 2 ) != 0 )
+            {
+                pRepo->mergeCount += 1;
+                i++;
+            }
+            if( pRepo->mergeCount == 0 )
+            {
+                fprintf( pRepo->err, "--merge needs the partial results of every shard\n" );
+                return -1;
+            }
+        }
+        else if( isOption( argv[i], "--checks" ) )
+        {
+            value = optionValue( argc, argv, &i );
+            pRepo->checks = value != NULL ? parseChecks( pRepo, value ) : -1;
+            if( pRepo->checks < 0 )
+            {
+                fprintf( pRepo->err, "--checks needs a list of passes from codes,counts,consistency,marks,feasibility (or none)\n" );
+                return -1;
+            }
+        }
+        else if( isOption( argv[i], "--export-table" ) )
+        {
+            pRepo->tableName = optionValue( argc, argv, &i );
+            if( pRepo->tableName == NULL )
+            {
+                fprintf( pRepo->err, "--export-table needs the name of the decision table to write\n" );
+                return -1;
+            }
+        }
+        else if( isOption( argv[i], "--export-dag" ) )
+        {
+            pRepo->dagName = optionValue( argc, argv, &i );
+            if( pRepo->dagName == NULL )
+            {
+                fprintf( pRepo->err, "--export-dag needs the name of the strategy file to write\n" );
+                return -1;
+            }
+        }
+        else if( isOption( argv[i], "--bench-table" ) )
+        {
+            pRepo->benchName = optionValue( argc, argv, &i );
+            if( pRepo->benchName == NULL )
+            {
+                fprintf( pRepo->err, "--bench-table needs the name of a decision table\n" );
+                return -1;
+            }
+        }
+        else if( isOption( argv[i], "--daemon" ) )
+        {
+            pRepo->daemonName = optionValue( argc, argv, &i );
+            if( pRepo->daemonName == NULL )
+            {
+                fprintf( pRepo->err, "--daemon needs the name of the socket to listen on\n" );
+                return -1;
+            }
+        }
+        else if( isOption( argv[i], "--client" ) )
+        {
+            pRepo->clientName = optionValue( argc, argv, &i );
+            if( pRepo->clientName == NULL )
+            {
+                fprintf( pRepo->err, "--client needs the name of the daemon's socket\n" );
+                return -1;
+            }
+        }
+        else if( strcmp( argv[i], "--stream" ) == 0 )
+        {
+            pRepo->stream = true;
+        }
+        else if( strcmp( argv[i], "--feasibility" ) == 0 )
+        {
+            feasibility = true;     // Added to the passes once all the options are read, so it goes with any --checks list
+        }
+        else if( strcmp( argv[i], "--pipeline" ) == 0 )
+        {
+            pRepo->pipeline = true;
+        }
+        else if( strcmp( argv[i], "--perf-counters" ) == 0 )
+        {
+            pRepo->perfCounters = true;
+        }
+        else if( strcmp( argv[i], "--progress" ) == 0 )
+        {
+            pRepo->showProgress = true;
+        }
+        else if( strcmp( argv[i], "--out-of-core" ) == 0 )
+        {
+            pRepo->outOfCore = true;
+        }
+        else if( isOption( argv[i], "--scratch" ) )
+        {
+            pRepo->scratchDir = optionValue( argc, argv, &i );
+            if( pRepo->scratchDir == NULL )
+            {
+                fprintf( pRepo->err, "--scratch needs the name of a directory for the sorted runs\n" );
+                return -1;
+            }
+        }
+        else if( isOption( argv[i], "--scanner" ) )
+        {
+            value = optionValue( argc, argv, &i );
+            pRepo->scanner = value != NULL ? findScanner( value ) : NULL;
+            if( pRepo->scanner == NULL )
+            {
+                fprintf( pRepo->err, "--scanner needs one of auto, avx2, sse2 or scalar (that this processor can run)\n" );
+                return -1;
+            }
+        }
+        else if( strcmp( argv[i], "-h" ) == 0 || strcmp( argv[i], "--help" ) == 0 )
+        {
+            helpText( pRepo );
+            return -1;
+        }
+        else if( argv[i][0] == '-' && argv[i][1] == '-' )
+        {
+            fprintf( pRepo->err, "Unknown option %s\n", argv[i] );
+            helpText( pRepo );
+            return -1;
+        }
+        else if( strlen( argv[i] ) > 0 )
+        {
+            pRepo->filename = argv[i];
+        }
+    }
+    if( feasibility )
+        pRepo->checks |= CHECK_FEASIBILITY;
+    if( pRepo->outOfCore && pRepo->checks != CHECK_DEFAULT )
+    {
+        fprintf( pRepo->err, "--out-of-core only makes the default checks - --checks and --feasibility can't be used with it\n" );
+        return -1;
+    }
+    return 0;
+}
+
+// Put a repository into its initial state, with all of the default options
+// Nothing is allocated here, so a repository can be set up anywhere (including on the stack)
+void initRepo( Repo* pRepo )
+{
+    resetRepo( pRepo );
+
+    // Options
+    pRepo->failFast     = false;
+    pRepo->sampleSize   = 0;
+    pRepo->sampleRate   = 0;
+    pRepo->seed         = 0;
+    pRepo->replay       = false;
+    pRepo->threads      = defaultThreads();
+    pRepo->markCache    = NULL;
+    pRepo->diffName     = NULL;
+    pRepo->maxMemory    = 0;
+    pRepo->shard        = 0;
+    pRepo->shards       = 0;
+    pRepo->mergeNames   = NULL;
+    pRepo->mergeCount   = 0;
+    pRepo->checks       = CHECK_DEFAULT;
+    pRepo->tableName    = NULL;
+    pRepo->dagName      = NULL;
+    pRepo->benchName    = NULL;
+    pRepo->daemonName   = NULL;
+    pRepo->clientName   = NULL;
+    pRepo->clientArgs   = NULL;
+    pRepo->clientArgCount = 0;
+    pRepo->stream       = false;
+    pRepo->warm         = NULL;
+    pRepo->pipeline     = false;
+    pRepo->perfCounters = false;
+    pRepo->showProgress = false;
+    pRepo->outOfCore    = false;
+    pRepo->scratchDir   = NULL;
+    pRepo->scanner      = findScanner( "auto" );
+    // Output
+    pRepo->out          = stdout;    // Report to stdout, unless the caller wants it elsewhere (or not at all)
+    pRepo->err          = stderr;    // Likewise problems to stderr (a daemon sends them back with the report)
+    pRepo->errorsFile   = true;      // Write the _ERRORS.csv file if there are solution level errors (and any _NODES.csv file)
+}
+
+// Clear down everything found by a previous analysis - but not the options
+void resetRepo( Repo* pRepo )
+{
     // Initialise repository
     // Input file
     pRepo->filename     = NULL;
@@ -46,112 +351,246 @@ int setup( Repo* pRepo, int argc, char **argv )
     pRepo->codesOK      = false;     // We can always validate this, so take a pessimistic outlook
     // Sub structures
     pRepo->codeDefs     = NULL;
-    pRepo->marking      = NULL;
+    pRepo->markPacked   = false;
+    pRepo->markTable    = NULL;
+    pRepo->markMap      = NULL;
+    pRepo->markMapSize  = 0;
+    pRepo->markStrategy = MARKS_TABLE;
+    pRepo->guessMarks   = NULL;
+    pRepo->guessBlock   = NULL;
     pRepo->data         = NULL;
-    pRepo->missing      = NULL;
+    pRepo->seen         = NULL;
+    pRepo->repeat       = NULL;
+    pRepo->missingCodes = 0;
+    pRepo->tree         = NULL;
+    pRepo->kernel       = NULL;
+    pRepo->perf         = NULL;
+    pRepo->progress     = NULL;
+    pRepo->feasible     = NULL;
+    pRepo->dag          = NULL;
+}
+
+// Release everything allocated by an analysis and put the repository back ready for another
+// The options are kept, so the same repository can be used to validate a series of solutions
+void freeRepo( Repo* pRepo )
+{
+    int i = 0;
 
-    // Expecting one parameter, which should be a filename
-    if( argc == 2 && strlen( argv[1] ) > 0 )
-        pRepo->filename = argv[1];
+    stopProgress( pRepo );           // Before anything it watches goes
+    if( pRepo->data != NULL )
+    {
+        for( i = 0; i < pRepo->actualCodes; i++ )
+            free( pRepo->data[i].turns );
+        free( pRepo->data );
+    }
+    if( pRepo->warm != NULL )
+        warmRelease( pRepo );        // Tables borrowed from the daemon stay warm for the next solution
+    if( pRepo->markMap != NULL )
+        unmapMarkCache( pRepo );
     else
-        pRepo->filename = "/Users/brucetandy/Documents/Mastermind/Results/SolnMM(4,6)_mes_1.csv";  // DEBUG
+        free( pRepo->markTable );
+    free( pRepo->guessMarks );
+    free( pRepo->guessBlock );
+    free( pRepo->seen );
+    free( pRepo->repeat );
+    free( pRepo->codeDefs );
+    perfClose( pRepo );
+    freeFeasible( pRepo );
+    freeDag( pRepo );
+    if( pRepo->fp != NULL )
+        fclose( pRepo->fp );
+
+    resetRepo( pRepo );
+}
+
+// Open a solution file ready for analysis
+int openSolution( Repo* pRepo, char* filename )
+{
+    pRepo->filename = filename;
+    pRepo->fp = fopen( filename, "r" );
+    if( pRepo->fp == NULL )
+    {
+        fprintf( pRepo->err, "Filename \"%s\"is invalid", filename );
+        return -1;
+    }
+    nameSolution( pRepo, filename );
+    return 0;
+}
+
+// Work out the base name and directory of a solution
+// Also take the number of pegs and colours from the name if we can (eg SolnMM(4,6)_full_282970100085955.csv)
+void nameSolution( Repo* pRepo, char* name )
+{
+    int   p             = 0;
+
+    for( p = 0; p < 256; p++ )
+    {
+        pRepo->baseName[p] = '\0';   // fully clear the baseName
+        pRepo->dirName[p]  = '\0';   // and dirName
+    }
+    p = strlen( name ) - 1;
+    while( p >= 0 && name[p] != '/' ) p--;
+    if( p >= 0 && name[p] == '/' )
+    {
+        snprintf( pRepo->baseName, 256, "%s", &name[p+1] );
+        snprintf( pRepo->dirName,  256, "%.*s", p, name );
+    }
+    else
+    {
+        snprintf( pRepo->baseName, 256, "%s", name );
+        pRepo->dirName[0] = '\0';
+    }
 
-    if( pRepo->filename != NULL )
+    // A strategy file (--export-dag) gives the pegs and colours in its header, so its name can be anything
+    if( isDag( pRepo ) ) return;
+
+    // Parse the number of pegs and colours from the file name
+    // However, it's not a fatal error if the file has been renamed
+    if( pRepo->baseName[6] == '(' )
     {
-        pRepo->fp = fopen( pRepo->filename, "r" );
-        if( pRepo->fp != NULL )
+        if( pRepo->baseName[7] >= '0' && pRepo->baseName[7] <= '9' )
         {
-            for( p = 0; p < 256; p++ )
+            if( pRepo->baseName[8] == ',' )
             {
-                pRepo->baseName[p] = '\0';   // fully clear the baseName
-                pRepo->dirName[p]  = '\0';   // and dirName
+                pRepo->pegs = pRepo->baseName[7] - '0';
+                p = 9;
             }
-            p = strlen( pRepo->filename ) - 1;
-            while( p >= 0 && pRepo->filename[p] != '/' ) p--;
-            if( p >= 0 && pRepo->filename[p] == '/' )
+            else if( pRepo->baseName[8] >= '0' && pRepo->baseName[8] <= '9' && pRepo->baseName[9] == ',' )
             {
-                strcpy( pRepo->baseName, &pRepo->filename[p+1] );
-                strcpy( pRepo->dirName,  pRepo->filename );
-                pRepo->dirName[p] = '\0';
+                pRepo->pegs = ( pRepo->baseName[7] - '0' ) * 10 + pRepo->baseName[8] - '0';
+                p = 10;
             }
             else
             {
-                strcpy( pRepo->baseName, pRepo->filename );
-                pRepo->dirName[0] = '\0';
+                fprintf( pRepo->err, "Filename does not have the expected format: %s\n", pRepo->baseName );
+                fprintf( pRepo->err, "%52s\n", "^" );  // 44 + 8
             }
 
-            // Parse the number of pegs and colours from the file name
-            // However, it's not a fatal error if the file has been renamed
-            if( pRepo->baseName[6] == '(' )
+            if( pRepo->baseName[p] >= '0' && pRepo->baseName[p] <= '9' )
             {
-                if( pRepo->baseName[7] >= '0' && pRepo->baseName[7] <= '9' )
+                if( pRepo->baseName[p+1] == ')' )
+                {
+                    pRepo->colours = pRepo->baseName[p] - '0';
+                }
+                else if( pRepo->baseName[p+1] >= '0' && pRepo->baseName[p+1] <= '9' && pRepo->baseName[p+2] == ')' )
                 {
-                    if( pRepo->baseName[8] == ',' )
-                    {
-                        pRepo->pegs = pRepo->baseName[7] - '0';
-                        p = 9;
-                    }
-                    else if( pRepo->baseName[8] >= '0' && pRepo->baseName[8] <= '9' && pRepo->baseName[9] == ',' )
-                    {
-                        pRepo->pegs = ( pRepo->baseName[7] - '0' ) * 10 + pRepo->baseName[8] - '0';
-                        p = 10;
-                    }
-                    else
-                    {
-                        fprintf( stderr, "Filename does not have the expected format: %s\n", pRepo->baseName );
-                        fprintf( stderr, "%52s\n", "^" );  // 44 + 8
-                    }
-
-                    if( pRepo->baseName[p] >= '0' && pRepo->baseName[p] <= '9' )
-                    {
-                        if( pRepo->baseName[p+1] == ')' )
-                        {
-                            pRepo->colours = pRepo->baseName[p] - '0';
-                        }
-                        else if( pRepo->baseName[p+1] >= '0' && pRepo->baseName[p+1] <= '9' && pRepo->baseName[p+2] == ')' )
-                        {
-                            pRepo->colours = ( pRepo->baseName[p] - '0' ) * 10 + pRepo->baseName[p+1] - '0';
-                        }
-                        else
-                        {
-                            fprintf( stderr, "Filename does not have the expected format: %s\n", pRepo->baseName );
-                            fprintf( stderr, "%50s\n", "^" );  // 44 + 6
-                        }
-                    }
-                    else
-                    {
-                        fprintf( stderr, "Filename does not have the expected format: %s\n", pRepo->baseName );
-                        fprintf( stderr, "%50s\n", "^" );  // 44 + 6
-                    }
+                    pRepo->colours = ( pRepo->baseName[p] - '0' ) * 10 + pRepo->baseName[p+1] - '0';
                 }
                 else
                 {
-                    fprintf( stderr, "Filename does not have the expected format: %s\n", pRepo->baseName );
-                    fprintf( stderr, "%50s\n", "^" );  // 44 + 6
+                    fprintf( pRepo->err, "Filename does not have the expected format: %s\n", pRepo->baseName );
+                    fprintf( pRepo->err, "%50s\n", "^" );  // 44 + 6
                 }
             }
             else
             {
-                fprintf( stderr, "Filename does not have the expected format: %s\n", pRepo->baseName );
-                fprintf( stderr, "%50s\n", "^" );  // 44 + 6
+                fprintf( pRepo->err, "Filename does not have the expected format: %s\n", pRepo->baseName );
+                fprintf( pRepo->err, "%50s\n", "^" );  // 44 + 6
             }
         }
         else
         {
-            fprintf( stderr, "Filename \"%s\"is invalid", argv[1] );
-            return -1;
+            fprintf( pRepo->err, "Filename does not have the expected format: %s\n", pRepo->baseName );
+            fprintf( pRepo->err, "%50s\n", "^" );  // 44 + 6
         }
     }
     else
     {
-        helpText( pRepo );
-        return -1;
+        fprintf( pRepo->err, "Filename does not have the expected format: %s\n", pRepo->baseName );
+        fprintf( pRepo->err, "%50s\n", "^" );  // 44 + 6
     }
-    return 0;
+}
+
+// Is this parameter the named option?  (Either on its own, or in the form --option=value)
+bool isOption( char* arg, char* name )
+{
+    int len = strlen( name );
+
+    return strncmp( arg, name, len ) == 0 && ( arg[len] == '\0' || arg[len] == '=' );
+}
+
+// Return the value given for an option, either from --option=value or from the next parameter
+// Returns NULL if there is no value
+char* optionValue( int argc, char **argv, int* i )
+{
+    char* equals = strchr( argv[*i], '=' );
+
+    if( equals != NULL ) return equals + 1;
+    if( *i + 1 < argc )
+    {
+        *i += 1;
+        return argv[*i];
+    }
+    return NULL;
+}
+
+// The checking passes that can be chosen with --checks, in the order they are run
+static const struct { char* name; int flag; } passes[] =
+{
+    { "codes",       CHECK_CODES       },
+    { "counts",      CHECK_COUNTS      },
+    { "consistency", CHECK_CONSISTENCY },
+    { "marks",       CHECK_MARKS       },
+    { "feasibility", CHECK_FEASIBILITY },
+    { "none",        0                 }
+};
+
+// Turn a comma separated list of checking passes (eg codes,marks) into CHECK_... flags
+// Returns -1 if any name in the list is not a pass
+int parseChecks( Repo* pRepo, char* list )
+{
+    int   checks = 0;
+    char* name   = list;
+    int   len    = 0;
+    int   p      = 0;
+    int   count  = sizeof( passes ) / sizeof( passes[0] );
+
+    if( *list == '\0' ) return -1;
+    while( *name != '\0' )
+    {
+        len = strcspn( name, "," );
+        for( p = 0; p < count; p++ )
+        {
+            if( (int)strlen( passes[p].name ) == len && strncmp( name, passes[p].name, len ) == 0 )
+                break;
+        }
+        if( p == count )
+        {
+            fprintf( pRepo->err, "Unknown check '%.*s'\n", len, name );
+            return -1;
+        }
+        checks |= passes[p].flag;
+        name   += name[len] == ',' ? len + 1 : len;
+    }
+    return checks;
+}
+
+// Write the names of the passes in checks as a comma separated list (eg codes,marks) - or none
+// NOTE - There MUST be 64 bytes space available in buffer
+char* printChecks( int checks, char* buffer )
+{
+    int count = sizeof( passes ) / sizeof( passes[0] );
+    int len   = 0;
+    int p     = 0;
+
+    buffer[0] = '\0';
+    for( p = 0; p < count; p++ )
+        if( passes[p].flag & checks )
+            len += sprintf( buffer + len, "%s%s", len > 0 ? "," : "", passes[p].name );
+    if( len == 0 ) strcpy( buffer, "none" );
+    return buffer;
 }
 
 // Setup all of the possible codes including useful information about each - such as the colours in that code
+// A daemon keeps them warm for each puzzle, so they are only built for the first solution of that size
 int setupCodeDefs( Repo* pRepo )
+{
+    if( pRepo->warm != NULL ) return warmCodeDefs( pRepo );
+    return buildCodeDefs( pRepo );
+}
+
+// Build the code definitions for this repository
+int buildCodeDefs( Repo* pRepo )
 {
     unsigned char colour[pRepo->pegs];
     unsigned int  sel      = 0;
@@ -165,10 +604,18 @@ int setupCodeDefs( Repo* pRepo )
     pRepo->codeDefs = (CodeDef*)malloc(sizeof(CodeDef)*pRepo->codes);
     if( pRepo->codeDefs == NULL )
     {
-        fprintf( stderr, "Failed to allocate the codeDefs array\n" );
+        fprintf( pRepo->err, "Failed to allocate the codeDefs array\n" );
         return 1;
     }
 
+    // A specialised kernel can work out each code directly
+    if( pRepo->kernel != NULL )
+    {
+        for( sel = 0; sel < pRepo->codes; sel++ )
+            pRepo->kernel->decode( sel, &pRepo->codeDefs[sel] );
+        return 0;
+    }
+
     // Initialise the colours used in the first code
     for( p=0; p<pRepo->pegs; p++ ) colour[p] = 0;
 
@@ -201,7 +648,7 @@ int setupCodeDefs( Repo* pRepo )
 Work out every mark up front.
 This function sets up a global, 2 dimensional array.
 The 2 dimensions represent the guess and the code, the array contains the marking.
-(Marks are symetrical - so A vs B has the same marking as B vs A)
+(Marks are symetrical - so A vs B has the same marking as B vs A, and only the lower triangle is held)
 
 Note that each mark is given an integer value according to the markTranslation matrix
 This is a slightly odd ordering in order to achieve the following objectives:
@@ -213,104 +660,148 @@ This is a slightly odd ordering in order to achieve the following objectives:
 **********************************************************************************************************************/
 int setupMarks( Repo* pRepo )
 {
-    unsigned int  guess    = 0;
-    unsigned int  solution = 0;
-    unsigned char black    = 0;
-    unsigned char white    = 0;
-    unsigned char total    = 0;
-    unsigned int  i        = 0;
     int           rc       = 0;
-    unsigned char guessColours[pRepo->colours];
-    unsigned char solutionColours[pRepo->colours];
-
-                                                                        // Use a numbering scheme so that for each number of pegs, there is a contiguous range of marks
-    unsigned char markTranslation[MAX_PEGS+1][MAX_PEGS+1] = {           // Use  marking[black, white]
-                                                            {  0,  2,  3,  5,  9, 14, 20, 27, 35, 44, 54 }   // 0 black pegs; 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 and 10 white pegs
-                                                          , {  1,  6,  7, 10, 15, 21, 28, 36, 45, 55, XX }   // 1 black peg;  0, 1, 2, 3, 4, 5, 6, 7, 8 and 9 white pegs
-                                                          , {  4, 11, 12, 16, 22, 29, 37, 46, 56, XX, XX }   // 2 black pegs; 0, 1, 2, 3, 4, 5, 6, 7 and 8 white pegs
-                                                          , {  8, 17, 18, 23, 30, 38, 47, 57, XX, XX, XX }   // 3 black pegs; 0, 1, 2, 3, 4, 5, 6 and 7 white pegs
-                                                          , { 13, 24, 25, 31, 39, 48, 58, XX, XX, XX, XX }   // 4 black pegs; 0, 1, 2, 3, 4, 5 and 6 white pegs
-                                                          , { 19, 32, 33, 40, 49, 59, XX, XX, XX, XX, XX }   // 5 black pegs; 0, 1, 2, 3, 4 and 5 white pegs
-                                                          , { 26, 41, 42, 50, 60, XX, XX, XX, XX, XX, XX }   // 6 black pegs; 0, 1, 2, 3 and 4 white pegs
-                                                          , { 34, 51, 52, 61, XX, XX, XX, XX, XX, XX, XX }   // 7 black pegs; 0, 1, 2 and 3 white pegs
-                                                          , { 43, 62, 63, XX, XX, XX, XX, XX, XX, XX, XX }   // 8 black pegs; 0, 1 and 2 white pegs
-                                                          , { 53, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX }   // 9 black pegs; No white pags (can't have 9 black, 1 white)
-                                                          , { 64, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX }   // 10 black pegs
-                                                          };
-    // Setup global array indication the mark obtained when submitting each guess to each solution
-    pRepo->marking = (char**)malloc(sizeof(char*) * pRepo->codes);
-    if( pRepo->marking != NULL )
+
+    // The full table may not fit - if not, fall back to rows for each guess, or to scoring as we go
+    rc = chooseMarks( pRepo );         if( rc ) return rc;
+    if( pRepo->markStrategy == MARKS_ROWS )  return setupGuessMarks( pRepo );
+    if( pRepo->markStrategy == MARKS_SCORE ) return 0;
+    if( pRepo->warm != NULL ) return warmMarkTable( pRepo );
+
+    return buildMarkTable( pRepo );
+}
+
+// Set up the full mark table for this repository - from the cache if there is one, otherwise by working out every mark
+int buildMarkTable( Repo* pRepo )
+{
+    size_t        size     = 0;
+    int           rc       = 0;
+
+    // The triangle of marks is held in one aligned block, indexed directly (see markIndex) - so the whole table can be cached (and mapped back in) in one piece
+    // Up to 4 pegs every mark fits in 4 bits, so two marks are packed into each byte
+    pRepo->markPacked = ( pRepo->pegs <= MARK_PACK_PEGS );
+    if( pRepo->markCache != NULL && mapMarkCache( pRepo ) == 0 )
+        return 0;
+
+    size = markTableSize( pRepo );
+    if( posix_memalign( (void**)&pRepo->markTable, MARK_TABLE_ALIGN, ( size + MARK_TABLE_ALIGN - 1 ) / MARK_TABLE_ALIGN * MARK_TABLE_ALIGN ) != 0 )
     {
-        for( i = 0; i < pRepo->codes; i++ )
-        {
-            pRepo->marking[i] = malloc( sizeof(char) * ( i + 1 ) );
-            if( pRepo->marking[i] == NULL )
-            {
-                fprintf(stderr, "Failure whilst malloc'ing parts of glabal 'marking' array\n");
-                return 1;
-            }
-        }
+        pRepo->markTable = NULL;
+        fprintf(pRepo->err, "Failure whilst malloc'ing glabal 'marking' array\n");
+        return 1;
     }
-    else
+
+    rc = fillMarks( pRepo );
+    if( rc == 0 && pRepo->markCache != NULL )
+        saveMarkCache( pRepo );         // Not fatal if the cache can't be written - it will just be built again next time
+
+    return rc;
+}
+
+// Work out every entry in the marking array
+// The rows are split into blocks of (near enough) equal area, so each thread has the same share of the triangle to fill
+// Block boundaries fall on rows that start on a whole byte, so no two threads ever write to the same byte of a packed table
+int fillMarks( Repo* pRepo )
+{
+    MarkFill fill;
+    int      blocks = 0;
+    int      b      = 0;
+
+    blocks = pRepo->threads * MARK_FILL_BLOCKS;
+    if( blocks > pRepo->codes / 4 ) blocks = pRepo->codes / 4;
+    if( blocks < 1 ) blocks = 1;
+
+    fill.failed = false;
+    fill.bound  = (int*)malloc( sizeof(int) * ( blocks + 1 ) );
+    if( fill.bound == NULL )
     {
-        fprintf(stderr, "Failure whilst malloc'ing glabal 'marking' array\n");
+        fprintf( pRepo->err, "Failed to allocate array in fillMarks\n" );
         return 1;
     }
 
-    for( guess = 0; guess < pRepo->codes; guess++ )
+    // Rows [0, r) hold r(r+1)/2 marks, so r = codes * sqrt(b/blocks) gives each block the same share
+    // Rounding down to a multiple of 4 makes r(r+1)/2 even - so each block starts on a whole byte
+    fill.bound[0]      = 0;
+    fill.bound[blocks] = pRepo->codes;
+    for( b = 1; b < blocks; b++ )
+        fill.bound[b] = (int)( pRepo->codes * sqrt( (double)b / blocks ) ) / 4 * 4;
+
+    runParallel( pRepo, blocks, fillMarkRows, &fill );
+    free( fill.bound );
+
+    if( fill.failed )
     {
-        for( solution = guess; solution < pRepo->codes; solution++ )
-        {
-            // Clear counts from last time
-            black = white = 0;
+        fprintf( pRepo->err, "Error in function fillMarks() - a code could not be marked\n" );
+        return 1;
+    }
+    return 0;
+}
 
-            // Special case, if the guess and the solution are the same, we have an exact match, ie all black
-            if( guess == solution )
-            {
-                black = pRepo->pegs;
-            }
-            else
-            {
-                // We will count the number of times each colour appears in both the guess and the solution
-                // Here we initialise the arrays of counts
-                for(i=0; i<pRepo->colours; i++)
-                {
-                    guessColours[i] = 0;
-                    solutionColours[i] = 0;
-                }
+// Fill the rows of the marking array in blocks [from, to)
+// Each row is worked out in full (by the kernel if there is one), then stored - packing two marks to a byte if need be
+void fillMarkRows( Repo* pRepo, int from, int to, void* arg )
+{
+    MarkFill*      pFill  = (MarkFill*)arg;
+    char*          marks  = NULL;
+    unsigned char* packed = (unsigned char*)pRepo->markTable;
+    size_t         index  = 0;
+    int            row    = 0;
+    int            code   = 0;
 
-                // Find the number of exact matches (ie black marking pegs)
-                // Also count how many of each colour in both the guess and the solution
-                for(i=0; i<pRepo->pegs; i++)
-                {
-                    if(pRepo->codeDefs[guess].peg[i] == pRepo->codeDefs[solution].peg[i])
-                        black += 1;
-                    guessColours[ pRepo->codeDefs[guess].peg[i] ]++;
-                    solutionColours[ pRepo->codeDefs[solution].peg[i] ]++;
-                }
+    marks = (char*)malloc( pRepo->codes );
+    if( marks == NULL )
+    {
+        pFill->failed = true;
+        return;
+    }
 
-                // Work out the overlap of colours - irrespective of placement
-                // Then the number of white marker pegs must be the overlap less the black marker pegs
-                total = 0;
-                for(i=0; i<pRepo->colours; i++)
-                {
-                    total += solutionColours[i] < guessColours[i] ? solutionColours[i] : guessColours[i];
-                }
-                white = total - black;
-            }
+    for( row = pFill->bound[from]; row < pFill->bound[to]; row++ )
+    {
+        if( pRepo->kernel != NULL )
+            pRepo->kernel->markRow( pRepo->codeDefs, row, marks );
+        else
+            markRow( pRepo, row, marks );
 
-            // Set up marks in both dimensions of the array
-            pRepo->marking[solution][guess] = markTranslation[black][white];
+        if( memchr( marks, (char)XX, row + 1 ) != NULL ) pFill->failed = true;
 
-            if(pRepo->marking[solution][guess] == XX)
-            {
-                // This represents an error, print out the guess and solution that caused the problem and incrament the return code
-                fprintf(stderr, "Error in function mark() guess = %d, solution = %d\n", guess, solution);
-                return 1;
-            }
+        index = markIndex( row, 0 );
+        if( ! pRepo->markPacked )
+        {
+            memcpy( pRepo->markTable + index, marks, row + 1 );
+            continue;
+        }
+        for( code = 0; code <= row; code++, index++ )
+        {
+            if( index & 1 )
+                packed[index/2] = ( packed[index/2] & 0x0F ) | ( marks[code] << 4 );
+            else
+                packed[index/2] = marks[code] & 0x0F;
         }
     }
-    return rc;
+    free( marks );
+}
+
+// Mark every code up to and including row against the code row - the generic form of the kernels' markRow
+void markRow( Repo* pRepo, int row, char* marks )
+{
+    CodeDef* pRow  = &pRepo->codeDefs[row];
+    CodeDef* pCode = NULL;
+    int      black = 0;
+    int      total = 0;
+    int      code  = 0;
+    int      i     = 0;
+
+    for( code = 0; code <= row; code++ )
+    {
+        pCode = &pRepo->codeDefs[code];
+        black = 0;
+        total = 0;
+        for( i = 0; i < pRepo->pegs; i++ )
+            black += ( pRow->peg[i] == pCode->peg[i] );
+        for( i = 0; i < pRepo->colours; i++ )
+            total += pRow->colourFrequency[i] < pCode->colourFrequency[i] ? pRow->colourFrequency[i] : pCode->colourFrequency[i];
+        marks[code] = markTranslation[black][total-black];
+    }
 }
 
 void helpText( Repo* pRepo )
@@ -327,6 +818,191 @@ void helpText( Repo* pRepo )
     printf( "\n" );
     printf( "This program makes no statement or claim about whether a solution is optimal or not\n" );
     printf( "\n" );
+    printf( "Options:\n" );
+    printf( "  --fail-fast         Stop at the first error found and exit with status %d (for gating runs)\n", FAIL_FAST_RC );
+    printf( "                      The cheapest checks are run first and each line is checked as it is read\n" );
+    printf( "  --sample N          Check N randomly chosen lines only, and report the error rate this implies\n" );
+    printf( "  --sample-rate p     As --sample, but check a proportion p (0 to 1) of the lines\n" );
+    printf( "  --seed S            Seed used to choose the sample lines, so a sample can be repeated\n" );
+    printf( "  --replay            Check by playing every code through the strategy tree built from the file\n" );
+    printf( "                      (No sorting and no mark table - codes are played on parallel threads)\n" );
+    printf( "  --threads N         Number of threads for parallel checks (default is one per processor)\n" );
+    printf( "  --mark-cache DIR    Keep the mark table for each puzzle size in DIR, and map it in on later runs\n" );
+    printf( "                      (A cache from another version, or one that is corrupt, is simply rebuilt)\n" );
+    printf( "  --diff A B          Compare the strategies in two solution files, showing the subtrees that differ\n" );
+    printf( "                      and what each difference does to the TTTS and worst case\n" );
+    printf( "  --max-memory N      Memory to allow for the marks, eg 512M (default is half the memory fitted)\n" );
+    printf( "                      Beyond this, marks are kept only for the guesses made, or worked out as needed\n" );
+    printf( "  --shard i/n         Check only the i-th of n equal parts of the file, writing a partial result\n" );
+    printf( "                      alongside it (eg SolnMM(4,6)_x_SHARD2of8.part)\n" );
+    printf( "  --merge PART...     Merge the partial results of every shard into the report for the whole file\n" );
+    printf( "  --checks LIST       Run only the checking passes listed, eg --checks=codes,counts (default is\n" );
+    printf( "                      codes,counts,consistency,marks - feasibility can be added, or none for just the TTTS)\n" );
+    printf( "                      The report names the passes run, and the marks are only set up if they are checked\n" );
+    printf( "                      (Not used by --sample, --fail-fast or --shard, which make their own checks)\n" );
+    printf( "  --export-table FILE Once the solution is found to be valid, write its strategy to FILE as a decision table\n" );
+    printf( "                      (The next guess and node for each node and mark, for mapping in and looking up - see MMtable.h)\n" );
+    printf( "  --export-dag FILE   Once the solution is found to be valid, write its strategy to FILE as a compact strategy file\n" );
+    printf( "                      (Each node stored once - give the file to MMchk in place of a solution to check it)\n" );
+    printf( "  --bench-table FILE  Play every code through the decision table in FILE, and time the lookups\n" );
+    printf( "  --daemon SOCKET     Stay resident, checking the solutions sent to the Unix-domain socket SOCKET on --threads\n" );
+    printf( "                      workers - the code definitions and mark table for each puzzle size are kept warm\n" );
+    printf( "  --client SOCKET     Have the daemon on SOCKET check the solution and show its report (the daemon only accepts\n" );
+    printf( "                      --checks, --feasibility, --fail-fast, --sample, --sample-rate and --seed with it)\n" );
+    printf( "  --stream            With --client, send the solution itself rather than its path (a filename of - reads stdin)\n" );
+    printf( "  --feasibility       Check each guess is in brackets exactly when it can no longer be the code,\n" );
+    printf( "                      and write the number of codes still possible at each node to an _NODES.csv file\n" );
+    printf( "                      (The same as adding feasibility to --checks)\n" );
+    printf( "  --pipeline          Read, parse and check the lines on separate threads, each stage overlapping the next\n" );
+    printf( "                      (Needs the pegs and colours in the filename - marks are scored as needed)\n" );
+    printf( "  --perf-counters     Show the time, cycles, instructions per cycle, cache misses and branch misses\n" );
+    printf( "                      of each phase (Linux only - just the times if the counters are not available)\n" );
+    printf( "  --progress          Show the phase, lines done, lines/s, bytes read and an ETA on stderr every second\n" );
+    printf( "                      (Send SIGUSR1 at any time for a snapshot of the counts and problems found so far)\n" );
+    printf( "  --out-of-core       Check a file too large for memory: lines are read in chunks within --max-memory, and\n" );
+    printf( "                      sorted runs are spilled to disk then merged (The default checks only - not --checks or --feasibility)\n" );
+    printf( "  --scratch DIR       Directory for the runs spilled by --out-of-core (default is $TMPDIR, or /tmp)\n" );
+    printf( "  --scanner NAME      How the text is split into lines and fields: avx2, sse2 or scalar (x86 only for the\n" );
+    printf( "                      first two - default is auto, the fastest the processor can run)\n" );
+    printf( "\n" );
 
     return;
-}
\ No newline at end of file
+}
+// Choose how to find marks, from the number of codes, the number of distinct guesses made and the memory budget
+// The full table is quickest, then rows of marks for each guess made, then scoring each guess as it is checked
+// The choice is logged if it was constrained, or if a budget was given
+int chooseMarks( Repo* pRepo )
+{
+    long long budget  = pRepo->maxMemory > 0 ? pRepo->maxMemory : defaultMemory();
+    long long table   = 0;
+    long long rows    = 0;
+    int       guesses = 0;
+
+    guesses = countGuesses( pRepo, NULL );
+    if( guesses < 0 ) return -1;
+
+    table = (long long)markTableSize( pRepo );
+    rows  = (long long)guesses * pRepo->codes + (long long)pRepo->codes * sizeof(char*);
+
+    if( table <= budget )
+        pRepo->markStrategy = MARKS_TABLE;
+    else if( rows <= budget )
+        pRepo->markStrategy = MARKS_ROWS;
+    else
+        pRepo->markStrategy = MARKS_SCORE;
+
+    if( pRepo->maxMemory > 0 || pRepo->markStrategy != MARKS_TABLE )
+    {
+        if( pRepo->markStrategy == MARKS_TABLE )
+            fprintf( pRepo->err, "Marks: full table of %d codes, about %.1f MB (budget %.1f MB)\n", pRepo->codes, table / 1048576.0, budget / 1048576.0 );
+        else if( pRepo->markStrategy == MARKS_ROWS )
+            fprintf( pRepo->err, "Marks: rows for %d distinct guesses, about %.1f MB (budget %.1f MB, full table would be %.1f MB)\n",
+                     guesses, rows / 1048576.0, budget / 1048576.0, table / 1048576.0 );
+        else
+            fprintf( pRepo->err, "Marks: scored as needed, no extra memory (budget %.1f MB, rows for %d guesses would be %.1f MB)\n",
+                     budget / 1048576.0, guesses, rows / 1048576.0 );
+    }
+    return 0;
+}
+
+// Count the distinct (valid) guesses made in the solution, optionally listing them
+// A guess of the code itself is not counted - it always gets all black, so needs no row of marks
+// Returns -1 if the working bitmap can't be allocated
+int countGuesses( Repo* pRepo, int* list )
+{
+    uint64_t* made    = NULL;
+    int       guess   = 0;
+    int       count   = 0;
+    int       i       = 0;
+    int       g       = 0;
+
+    made = (uint64_t*)calloc( bitmapWords( pRepo->codes ), sizeof(uint64_t) );
+    if( made == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate bitmap in countGuesses\n" );
+        return -1;
+    }
+
+    for( i = 0; i < pRepo->actualCodes; i++ )
+    {
+        for( g = 0; g < pRepo->data[i].actualNoTurns && g < pRepo->guesses; g++ )
+        {
+            guess = pRepo->data[i].turns[g].guess;
+            if( guess < 0 || guess >= pRepo->codes || guess == pRepo->data[i].code || testBit( made, guess ) ) continue;
+            setBit( made, guess );
+            if( list != NULL ) list[count] = guess;
+            count += 1;
+        }
+    }
+
+    free( made );
+    return count;
+}
+
+// Set up a row of marks against every code, for each distinct guess made in the solution
+int setupGuessMarks( Repo* pRepo )
+{
+    int*  list    = NULL;
+    int   guesses = 0;
+    int   i       = 0;
+    int   rc      = 0;
+
+    list = (int*)malloc( sizeof(int) * pRepo->codes );
+    pRepo->guessMarks = (char**)calloc( pRepo->codes, sizeof(char*) );
+    if( list == NULL || pRepo->guessMarks == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate arrays in setupGuessMarks\n" );
+        free( list );
+        return -1;
+    }
+
+    guesses = countGuesses( pRepo, list );
+    pRepo->guessBlock = (char*)malloc( (size_t)( guesses > 0 ? guesses : 1 ) * pRepo->codes );
+    if( guesses < 0 || pRepo->guessBlock == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate rows in setupGuessMarks\n" );
+        free( list );
+        return -1;
+    }
+    for( i = 0; i < guesses; i++ )
+        pRepo->guessMarks[list[i]] = pRepo->guessBlock + (size_t)i * pRepo->codes;
+
+    rc = runParallel( pRepo, guesses, fillGuessMarks, list );
+
+    free( list );
+    return rc;
+}
+
+// Fill in the rows for guesses [from, to) of the list given
+void fillGuessMarks( Repo* pRepo, int from, int to, void* arg )
+{
+    int*  list  = (int*)arg;
+    char* row   = NULL;
+    int   code  = 0;
+    int   i     = 0;
+
+    for( i = from; i < to; i++ )
+    {
+        row = pRepo->guessMarks[list[i]];
+        for( code = 0; code < pRepo->codes; code++ )
+            row[code] = scoreCodes( pRepo, list[i], code );
+    }
+}
+
+// Memory budget if not told otherwise - half of the memory fitted
+long long defaultMemory( void )
+{
+    long pages    = sysconf( _SC_PHYS_PAGES );
+    long pageSize = sysconf( _SC_PAGESIZE );
+
+    if( pages <= 0 || pageSize <= 0 ) return LLONG_MAX;
+    return (long long)pages * pageSize / 2;
+}
+
+// Size in bytes of the (triangular) marking array - half a byte per mark if they are packed
+size_t markTableSize( Repo* pRepo )
+{
+    size_t marks = markIndex( pRepo->codes, 0 );
+
+    return pRepo->pegs <= MARK_PACK_PEGS ? ( marks + 1 ) / 2 : marks;
+}
@@ -13,9 +13,37 @@
 
 #include "MMchk.h"
 
+// Work shared out by fillMarks - the first row of each block, and whether any code could not be marked
+typedef struct MarkFill
+{
+    int*  bound;                                       // Block b is rows [bound[b], bound[b+1])
+    bool  failed;
+} MarkFill;
+
 int setup( Repo* pRepo, int argc, char **argv );
+int parseOptions( Repo* pRepo, int argc, char **argv );
+void initRepo( Repo* pRepo );
+void resetRepo( Repo* pRepo );
+int openSolution( Repo* pRepo, char* filename );
+void nameSolution( Repo* pRepo, char* name );
+void freeRepo( Repo* pRepo );
 int setupCodeDefs( Repo* pRepo );
+int buildCodeDefs( Repo* pRepo );
 int setupMarks( Repo* pRepo );
+int buildMarkTable( Repo* pRepo );
+int fillMarks( Repo* pRepo );
+void fillMarkRows( Repo* pRepo, int from, int to, void* arg );
+void markRow( Repo* pRepo, int row, char* marks );
+int chooseMarks( Repo* pRepo );
+int countGuesses( Repo* pRepo, int* list );
+int setupGuessMarks( Repo* pRepo );
+void fillGuessMarks( Repo* pRepo, int from, int to, void* arg );
+long long defaultMemory( void );
+size_t markTableSize( Repo* pRepo );
 void helpText( Repo* pRepo );
+bool isOption( char* arg, char* name );
+char* optionValue( int argc, char **argv, int* i );
+int parseChecks( Repo* pRepo, char* list );
+char* printChecks( int checks, char* buffer );
 
 #endif  /* MMPARAMS_H */
\ No newline at end of file
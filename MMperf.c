@@ -0,0 +1,172 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Optional hardware performance counters (--perf-counters) for each phase of a run
+// Cycles, instructions, last level cache misses and branch misses are counted with perf_event_open (Linux only)
+// Where the counters cannot be had - other systems, containers, a restrictive perf_event_paranoid - only wall time is given
+//
+#include "MMperf.h"
+#include "MMchk.h"
+#include "MMutility.h"
+#include "MMprogress.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// Run one phase of the checking - timed and counted if --perf-counters was given, and shown as under way by --progress
+int phase( Repo* pRepo, const char* name, PhaseFn fn )
+{
+    PerfPhase* pPhase = NULL;
+    double     before[PERF_EVENTS];
+    double     after[PERF_EVENTS];
+    double     start  = 0;
+    double     end    = 0;
+    int        rc     = 0;
+    int        e      = 0;
+
+    progressPhase( pRepo, name );
+    if( ! pRepo->perfCounters ) return fn( pRepo );
+    if( pRepo->perf == NULL && perfOpen( pRepo ) != 0 ) return fn( pRepo );
+
+    perfRead( pRepo->perf, before, &start );
+    rc = fn( pRepo );
+    perfRead( pRepo->perf, after, &end );
+
+    if( pRepo->perf->phases < PERF_PHASES )
+    {
+        pPhase = &pRepo->perf->phase[pRepo->perf->phases++];
+        pPhase->name = name;
+        pPhase->wall = end - start;
+        for( e = 0; e < PERF_EVENTS; e++ )
+            pPhase->count[e] = before[e] < 0 || after[e] < 0 ? -1 : after[e] - before[e];
+    }
+    return rc;
+}
+
+// Open the counters - they count this thread and any threads it starts (counted in as they finish)
+// If none can be opened the run goes on, with wall times only
+int perfOpen( Repo* pRepo )
+{
+    Perf* pPerf = NULL;
+    int   open  = 0;
+    int   e     = 0;
+#ifdef __linux__
+    struct perf_event_attr attr;
+    static const uint64_t  config[PERF_EVENTS] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                   PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+#endif
+
+    pPerf = (Perf*)calloc( 1, sizeof(Perf) );
+    if( pPerf == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate performance counters\n" );
+        return -1;
+    }
+
+    for( e = 0; e < PERF_EVENTS; e++ )
+    {
+        pPerf->fd[e] = -1;
+#ifdef __linux__
+        memset( &attr, 0, sizeof(attr) );
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.size           = sizeof(attr);
+        attr.config         = config[e];
+        attr.inherit        = 1;                     // Include the worker threads
+        attr.exclude_kernel = 1;                     // Allowed at the default perf_event_paranoid setting
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        pPerf->fd[e] = syscall( __NR_perf_event_open, &attr, 0, -1, -1, 0 );
+        if( pPerf->fd[e] != -1 ) open += 1;
+#endif
+    }
+    if( open == 0 )
+        fprintf( pRepo->err, "Performance counters are not available (%s) - timing phases only\n",
+#ifdef __linux__
+                 strerror( errno ) );
+#else
+                 "not supported on this system" );
+#endif
+
+    pRepo->perf = pPerf;
+    return 0;
+}
+
+// Read the counters (-1 for any that are not available) and the time
+// Counts are scaled up for any time the counter was not running, as happens when the kernel shares out too few counters
+void perfRead( Perf* pPerf, double* count, double* wall )
+{
+    struct timespec now;
+    uint64_t        value[3];
+    int             e = 0;
+
+    for( e = 0; e < PERF_EVENTS; e++ )
+    {
+        count[e] = -1;
+        if( pPerf->fd[e] == -1 ) continue;
+        if( read( pPerf->fd[e], value, sizeof(value) ) != sizeof(value) ) continue;
+        count[e] = value[2] == 0 ? 0 : (double)value[0] * ( (double)value[1] / value[2] );
+    }
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    *wall = now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Report what each phase used - IPC, and misses per thousand instructions
+void perfReport( Repo* pRepo )
+{
+    PerfPhase* pPhase = NULL;
+    char       cell[7][32];
+    double*    count  = NULL;
+    int        i      = 0;
+
+    if( pRepo->perf == NULL ) return;
+
+    say( pRepo, "%-16s %10s %14s %14s %6s %12s %6s %12s %6s\n", "Phase", "Wall ms", "Cycles", "Instructions",
+         "IPC", "LLC misses", "MPKI", "Br misses", "MPKI" );
+    for( i = 0; i < pRepo->perf->phases; i++ )
+    {
+        pPhase = &pRepo->perf->phase[i];
+        count  = pPhase->count;
+
+        snprintf( cell[0], 32, count[0] < 0 ? "-" : "%.0f", count[0] );
+        snprintf( cell[1], 32, count[1] < 0 ? "-" : "%.0f", count[1] );
+        snprintf( cell[2], 32, count[0] <= 0 || count[1] < 0 ? "-" : "%.2f", count[1] / count[0] );
+        snprintf( cell[3], 32, count[2] < 0 ? "-" : "%.0f", count[2] );
+        snprintf( cell[4], 32, count[2] < 0 || count[1] <= 0 ? "-" : "%.2f", 1000 * count[2] / count[1] );
+        snprintf( cell[5], 32, count[3] < 0 ? "-" : "%.0f", count[3] );
+        snprintf( cell[6], 32, count[3] < 0 || count[1] <= 0 ? "-" : "%.2f", 1000 * count[3] / count[1] );
+        say( pRepo, "%-16s %10.2f %14s %14s %6s %12s %6s %12s %6s\n", pPhase->name, 1000 * pPhase->wall,
+             cell[0], cell[1], cell[2], cell[3], cell[4], cell[5], cell[6] );
+    }
+    say( pRepo, "\n" );
+}
+
+// Close the counters
+void perfClose( Repo* pRepo )
+{
+    int e = 0;
+
+    if( pRepo->perf == NULL ) return;
+    for( e = 0; e < PERF_EVENTS; e++ )
+        if( pRepo->perf->fd[e] != -1 ) close( pRepo->perf->fd[e] );
+    free( pRepo->perf );
+    pRepo->perf = NULL;
+}
@@ -0,0 +1,45 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMPERF_H
+#define MMPERF_H
+
+#include "MMchk.h"
+
+#include <stdint.h>
+
+#define PERF_PHASES            16                      // Most phases a run can time
+#define PERF_EVENTS            4                       // Cycles, instructions, LLC misses, branch misses
+
+// Counts for one phase of a run
+typedef struct PerfPhase
+{
+    const char* name;
+    double      wall;                                  // Elapsed seconds
+    double      count[PERF_EVENTS];                    // Scaled for any time the counter was not running (-1 if unavailable)
+} PerfPhase;
+
+// Hardware counters for the run, and what each phase used
+typedef struct Perf
+{
+    int         fd[PERF_EVENTS];                       // Counter file descriptors (-1 if not available)
+    int         phases;
+    PerfPhase   phase[PERF_PHASES];
+} Perf;
+
+typedef int (*PhaseFn)( Repo* pRepo );
+
+int  phase( Repo* pRepo, const char* name, PhaseFn fn );
+int  perfOpen( Repo* pRepo );
+void perfRead( Perf* pPerf, double* count, double* wall );
+void perfReport( Repo* pRepo );
+void perfClose( Repo* pRepo );
+
+#endif  /* MMPERF_H */
@@ -0,0 +1,535 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Pipelined checking (--pipeline) - reading, parsing and checking the lines of a solution all overlap
+// The reader (the calling thread) reads large blocks of whole lines, hinting to the kernel to read ahead of it
+// Parser threads turn blocks into solutions, and checker threads run the per-line checks on them,
+// while later blocks are still being read. Stages are connected by bounded lock-free rings.
+// The checks needing every line (codes seen, consistency of guesses) run once the pipeline has drained.
+//
+#include "MMpipe.h"
+#include "MMchk.h"
+#include "MMutility.h"
+#include "MMkernels.h"
+#include "MMprogress.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+// The pipeline needs the number of colours before reading (from the filename) and a real file to read from
+bool canPipeline( Repo* pRepo )
+{
+    return pRepo->pipeline && ! pRepo->replay && pRepo->colours > 0 && pRepo->fp != NULL && fileno( pRepo->fp ) != -1;
+}
+
+// Read, parse and check every line of the solution, in overlapping stages
+// This takes the place of countCodes, parseFile, setupMarks, checkCounts and checkMarks (marks are scored as needed)
+int pipeCheck( Repo* pRepo )
+{
+    pthread_t tid[MAX_THREADS];
+    Pipe*     pPipe    = NULL;
+    Block*    pBlock   = NULL;
+    Block*    pNext    = NULL;
+    char*     buffer[PIPE_BUFFERS];
+    char      line[256];
+    int       parsers  = 0;
+    int       checkers = 0;
+    int       total    = 0;
+    int       threads  = 0;
+    int       colours  = 0;
+    int       t        = 0;
+    int       rc       = 0;
+
+    pPipe = (Pipe*)calloc( 1, sizeof(Pipe) );
+    if( pPipe == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate pipeline\n" );
+        return -1;
+    }
+    pPipe->pRepo = pRepo;
+    ringInit( &pPipe->toParse );
+    ringInit( &pPipe->toCheck );
+    ringInit( &pPipe->spare );
+
+    // Everything the stages need is fixed before they start
+    pRepo->codes        = round( pow( pRepo->colours, pRepo->pegs ) );
+    pRepo->markStrategy = MARKS_SCORE;
+    selectKernel( pRepo );
+    fseek( pRepo->fp, 0, SEEK_SET );
+    getLine( pRepo->fp, line, 256 );                      // Step over the header
+    pPipe->start = ftell( pRepo->fp );
+
+    for( t = 0; t < PIPE_BUFFERS; t++ )
+    {
+        buffer[t] = (char*)malloc( 2 * PIPE_BLOCK_SIZE + 2 );   // Room for a block plus a line carried over from the last one
+        if( buffer[t] == NULL ) rc = -1;
+        else ringPut( &pPipe->spare, buffer[t] );
+    }
+    if( rc != 0 )
+    {
+        fprintf( pRepo->err, "Failed to allocate read buffers in pipeCheck\n" );
+        while( ringTake( &pPipe->spare, (void**)&buffer[0] ) ) free( buffer[0] );
+        ringFree( &pPipe->toParse );
+        ringFree( &pPipe->toCheck );
+        ringFree( &pPipe->spare );
+        free( pPipe );
+        return -1;
+    }
+
+    // Checkers first, so parsers know how many there are - any stage without threads is run by the stage before
+    threads  = pRepo->threads > 1 ? pRepo->threads : 2;
+    parsers  = threads / 2;
+    checkers = threads - parsers;
+    for( t = 0; t < checkers; t++ )
+        if( pthread_create( &tid[pPipe->checkers], NULL, checkBlocks, pPipe ) == 0 ) pPipe->checkers += 1;
+    pPipe->parsing = parsers;
+    for( t = 0; t < parsers; t++ )
+        if( pthread_create( &tid[pPipe->checkers + pPipe->parsers], NULL, parseBlocks, pPipe ) == 0 ) pPipe->parsers += 1;
+    __atomic_fetch_sub( &pPipe->parsing, parsers - pPipe->parsers, __ATOMIC_ACQ_REL );
+
+    rc = readBlocks( pPipe );
+
+    // The parsers tell the checkers to stop once they have parsed everything - without parsers the reader does
+    for( t = 0; t < pPipe->parsers; t++ ) ringSend( &pPipe->toParse, NULL );
+    if( pPipe->parsers == 0 )
+        for( t = 0; t < pPipe->checkers; t++ ) ringSend( &pPipe->toCheck, NULL );
+    for( t = 0; t < pPipe->checkers + pPipe->parsers; t++ ) pthread_join( tid[t], NULL );
+    while( ringTake( &pPipe->spare, (void**)&buffer[0] ) ) free( buffer[0] );
+
+    // Gather the solutions together, in file order
+    for( pBlock = pPipe->first; pBlock != NULL; pBlock = pBlock->next ) total += pBlock->lines;
+    if( pPipe->failed ) rc = -1;                         // Whichever stage failed has said why
+    if( rc == 0 )
+    {
+        pRepo->data = (Solution*)malloc( sizeof(Solution) * ( total + 1 ) );
+        if( pRepo->data == NULL )
+        {
+            fprintf( pRepo->err, "Failed to create Solution array\n" );
+            rc = -1;
+        }
+    }
+    for( pBlock = pPipe->first; pBlock != NULL; pBlock = pNext )
+    {
+        pNext = pBlock->next;
+        if( rc == 0 )
+        {
+            memcpy( &pRepo->data[pRepo->actualCodes], pBlock->soln, sizeof(Solution) * pBlock->lines );
+            pRepo->actualCodes += pBlock->lines;
+        }
+        else if( pBlock->soln != NULL )
+        {
+            for( t = 0; t < pBlock->lines; t++ ) free( pBlock->soln[t].turns );
+        }
+        free( pBlock->soln );
+        free( pBlock );
+    }
+    free( pPipe->marks );
+    ringFree( &pPipe->toParse );
+    ringFree( &pPipe->toCheck );
+    ringFree( &pPipe->spare );
+    free( pPipe );
+    if( rc != 0 ) return rc;
+
+    // As countCodes - the colours implied by the number of codes should agree with the filename
+    colours = round( pow( pRepo->actualCodes, 1.0 / pRepo->pegs ) );
+    pRepo->coloursOK = ( pRepo->colours == colours );
+    pRepo->codesOK   = ( pRepo->codes == pRepo->actualCodes );
+
+    return 0;
+}
+
+// Read the file in blocks of whole lines, handing each on to be parsed
+// Any part line at the end of a block is carried over to the start of the next
+int readBlocks( Pipe* pPipe )
+{
+    Repo*   pRepo   = pPipe->pRepo;
+    Block*  pBlock  = NULL;
+    Block*  pLast   = NULL;
+    char*   buffer  = NULL;
+    char*   carried = NULL;
+    char*   cut     = NULL;
+    long    offset  = pPipe->start;
+    long    carry   = 0;
+    long    length  = 0;
+    ssize_t got     = 0;
+    int     line    = 0;
+    int     fd      = fileno( pRepo->fp );
+    int     rc      = 0;
+
+    carried = (char*)malloc( PIPE_BLOCK_SIZE + 1 );
+    if( carried == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate buffer in readBlocks\n" );
+        return -1;
+    }
+    posix_fadvise( fd, offset, 0, POSIX_FADV_SEQUENTIAL );
+
+    while( ! __atomic_load_n( &pPipe->failed, __ATOMIC_ACQUIRE ) )
+    {
+        buffer = (char*)ringWait( &pPipe->spare );
+        memcpy( buffer, carried, carry );
+
+        // Ask for the blocks after this one while this one is read, so the next read is (hopefully) from memory
+        posix_fadvise( fd, offset + PIPE_BLOCK_SIZE, (off_t)PIPE_BLOCK_SIZE * ( PIPE_BUFFERS / 2 ), POSIX_FADV_WILLNEED );
+        do got = pread( fd, buffer + carry, PIPE_BLOCK_SIZE, offset ); while( got == -1 && errno == EINTR );
+        if( got < 0 )
+        {
+            fprintf( pRepo->err, "Unable to read %s (%s)\n", pRepo->baseName, strerror( errno ) );
+            ringSend( &pPipe->spare, buffer );
+            rc = -1;
+            break;
+        }
+        offset += got;
+        length  = carry + got;
+        progressCount( pRepo, 0, got );
+
+        if( got == 0 )
+        {
+            // End of file - anything carried over is the last line, without its newline
+            if( length == 0 )
+            {
+                ringSend( &pPipe->spare, buffer );
+                break;
+            }
+            buffer[length++] = '\n';
+            carry = 0;
+        }
+        else
+        {
+            // A line longer than the whole block is simply split
+            for( cut = buffer + length; cut > buffer && cut[-1] != '\n'; cut-- );
+            if( cut == buffer ) cut = buffer + length;
+            carry = buffer + length - cut;
+            memcpy( carried, cut, carry );
+            length -= carry;
+        }
+
+        pBlock = (Block*)calloc( 1, sizeof(Block) );
+        if( pBlock == NULL )
+        {
+            fprintf( pRepo->err, "Failed to allocate block in readBlocks\n" );
+            ringSend( &pPipe->spare, buffer );
+            rc = -1;
+            break;
+        }
+        pBlock->text      = buffer;
+        pBlock->length    = length;
+        pBlock->firstLine = line;
+        pBlock->lines     = countLines( buffer, length );
+        line += pBlock->lines;
+        if( pLast == NULL ) pPipe->first = pBlock; else pLast->next = pBlock;
+        pLast = pBlock;
+
+        sendBlock( pPipe, pBlock );
+        if( got == 0 ) break;
+    }
+
+    if( rc != 0 ) pipeFail( pPipe, NULL );
+    free( carried );
+    return rc;
+}
+
+// Pass a block read on to the parsers - or parse and check it here if there are no parser threads
+void sendBlock( Pipe* pPipe, Block* pBlock )
+{
+    int rc = 0;
+
+    if( pPipe->parsers > 0 )
+    {
+        ringSend( &pPipe->toParse, pBlock );
+        return;
+    }
+    if( pPipe->marks == NULL ) pPipe->marks = (uint32_t*)malloc( sizeof(uint32_t) * PIPE_MARKS );
+    rc = parseBlock( pPipe->pRepo, pBlock, pPipe->marks );
+    if( rc != 0 ) pipeFail( pPipe, rc > 0 ? "More guesses than expected" : NULL );
+    ringSend( &pPipe->spare, pBlock->text );
+    pBlock->text = NULL;
+    if( pPipe->checkers > 0 )
+        ringSend( &pPipe->toCheck, pBlock );
+    else
+        checkBlock( pPipe->pRepo, pBlock );
+}
+
+// Parser thread - parse blocks until told to stop, handing the text back to the reader and the solutions on to the checkers
+// The last parser to stop tells the checkers to stop
+void* parseBlocks( void* arg )
+{
+    Pipe*     pPipe  = (Pipe*)arg;
+    Block*    pBlock = NULL;
+    uint32_t* marks  = (uint32_t*)malloc( sizeof(uint32_t) * PIPE_MARKS );
+    int       rc     = 0;
+    int       t      = 0;
+
+    while( ( pBlock = (Block*)ringWait( &pPipe->toParse ) ) != NULL )
+    {
+        rc = parseBlock( pPipe->pRepo, pBlock, marks );
+        if( rc != 0 ) pipeFail( pPipe, rc > 0 ? "More guesses than expected" : NULL );
+        ringSend( &pPipe->spare, pBlock->text );
+        pBlock->text = NULL;
+        if( pPipe->checkers > 0 )
+            ringSend( &pPipe->toCheck, pBlock );
+        else
+            checkBlock( pPipe->pRepo, pBlock );
+    }
+
+    if( __atomic_sub_fetch( &pPipe->parsing, 1, __ATOMIC_ACQ_REL ) == 0 )
+        for( t = 0; t < pPipe->checkers; t++ ) ringSend( &pPipe->toCheck, NULL );
+    free( marks );
+    return NULL;
+}
+
+// Parse the lines of a block into solutions - lines are split as getLine splits them
+// The structural characters of the whole block are found first (into marks, which has room for PIPE_MARKS), then
+// each plain line is split into its fields from them
+// Returns 1 if a line has more guesses than the header allows for, or -1 (already reported) if the block can't be parsed
+int parseBlock( Repo* pRepo, Block* pBlock, uint32_t* marks )
+{
+    ScanLine line;
+    char*    text   = pBlock->text;
+    long     start  = 0;
+    long     eol    = 0;
+    long     next   = 0;
+    long     count  = 0;
+    long     len    = 0;
+    int      crs    = 0;
+    int      rc     = 0;
+    int      k      = 0;
+
+    pBlock->soln = NULL;
+    if( marks != NULL ) pBlock->soln = (Solution*)malloc( sizeof(Solution) * ( pBlock->lines + 1 ) );
+    if( pBlock->soln == NULL || initSolutions( pRepo, pBlock->soln, pBlock->lines ) != 0 )
+    {
+        fprintf( pRepo->err, "Failed to create Solution array for a block\n" );
+        free( pBlock->soln );
+        pBlock->soln  = NULL;
+        pBlock->lines = 0;
+        return -1;
+    }
+
+    count = pRepo->scanner->scan( text, pBlock->length, marks );
+    for( k = 0; start < pBlock->length && k < pBlock->lines; start = eol + 1 )
+    {
+        eol = findLineEnd( text, start, pBlock->length, marks, count, &next, &line, &len, &crs );
+        if( len == 0 ) continue;                          // Blank lines are ignored
+
+        // Any \r at the end of the line is dropped - a line with others, or too long to keep, is left whole
+        if( line.split )
+        {
+            splitLine( &line, text + start, len );
+        }
+        else if( len < SCAN_LINE )
+        {
+            memcpy( line.line, text + start, len );
+            line.line[len] = '\0';
+        }
+        else
+        {
+            line.line[0] = '\0';
+        }
+
+        pBlock->soln[k].line = pBlock->firstLine + k;
+        if( parseScanned( pRepo, &pBlock->soln[k], &line ) != 0 ) rc = 1;
+        k += 1;
+    }
+    return rc;
+}
+
+// Stop the pipeline - only the first stage to fail says why (there is nothing to say if it has been reported already)
+void pipeFail( Pipe* pPipe, const char* reason )
+{
+    if( __atomic_exchange_n( &pPipe->failed, 1, __ATOMIC_ACQ_REL ) == 0 && reason != NULL )
+        fprintf( pPipe->pRepo->err, "%s\n", reason );
+}
+
+// Checker thread - check blocks of solutions until told to stop
+void* checkBlocks( void* arg )
+{
+    Pipe*  pPipe  = (Pipe*)arg;
+    Block* pBlock = NULL;
+
+    while( ( pBlock = (Block*)ringWait( &pPipe->toCheck ) ) != NULL )
+        checkBlock( pPipe->pRepo, pBlock );
+    return NULL;
+}
+
+// The checks that only need the line itself - as checkCounts and checkMarks
+void checkBlock( Repo* pRepo, Block* pBlock )
+{
+    Solution* pSoln    = NULL;
+    int       problems = 0;
+    int       k        = 0;
+    int       g        = 0;
+
+    for( k = 0; k < pBlock->lines; k++ )
+    {
+        pSoln = &pBlock->soln[k];
+        countTurns( pRepo, pSoln );
+        problems += ! pSoln->codeOK + ! pSoln->guessesOK + ! pSoln->turnsOK + ! pSoln->resolved;
+        for( g = 0; g < pSoln->actualNoTurns; g++ )
+            if( pSoln->turns[g].mark == marking( pRepo, pSoln->code, pSoln->turns[g].guess ) )
+                pSoln->turns[g].markOK = true;
+            else
+                problems += 1;
+    }
+    progressCount( pRepo, pBlock->lines, 0 );
+    progressProblems( pRepo, problems );
+}
+
+// Count the lines in a block, ignoring blank lines (as getLine does)
+int countLines( char* text, long length )
+{
+    char* end   = text + length;
+    char* eol   = NULL;
+    long  len   = 0;
+    int   lines = 0;
+
+    for( ; text < end; text = eol + 1 )
+    {
+        eol = memchr( text, '\n', end - text );
+        if( eol == NULL ) eol = end;
+        for( len = eol - text; len > 0 && text[len-1] == '\r'; len-- );
+        if( len > 0 ) lines += 1;
+    }
+    return lines;
+}
+
+// Set up an empty ring - each slot's sequence number is the position it is next filled at
+void ringInit( Ring* pRing )
+{
+    size_t i = 0;
+
+    for( i = 0; i < PIPE_RING; i++ )
+    {
+        pRing->slot[i].seq  = i;
+        pRing->slot[i].item = NULL;
+    }
+    pRing->head     = 0;
+    pRing->tail     = 0;
+    pRing->sleepers = 0;
+    pthread_mutex_init( &pRing->lock, NULL );
+    pthread_cond_init( &pRing->changed, NULL );
+}
+
+// Release the ring's lock and condition (the items are the caller's)
+void ringFree( Ring* pRing )
+{
+    pthread_cond_destroy( &pRing->changed );
+    pthread_mutex_destroy( &pRing->lock );
+}
+
+// Wake any threads asleep waiting for the ring to change
+// Sleepers are counted before they look at the ring a last time, so one that missed this change is seen here
+void ringWake( Ring* pRing )
+{
+    __atomic_thread_fence( __ATOMIC_SEQ_CST );
+    if( __atomic_load_n( &pRing->sleepers, __ATOMIC_RELAXED ) == 0 ) return;
+    pthread_mutex_lock( &pRing->lock );
+    pthread_cond_broadcast( &pRing->changed );
+    pthread_mutex_unlock( &pRing->lock );
+}
+
+// Put an item in the ring, if there is room - any number of threads may put and take at once
+bool ringPut( Ring* pRing, void* item )
+{
+    RingSlot* pSlot = NULL;
+    size_t    pos   = __atomic_load_n( &pRing->tail, __ATOMIC_RELAXED );
+    long      dif   = 0;
+
+    for( ;; )
+    {
+        pSlot = &pRing->slot[pos % PIPE_RING];
+        dif   = (long)( __atomic_load_n( &pSlot->seq, __ATOMIC_ACQUIRE ) - pos );
+        if( dif == 0 && __atomic_compare_exchange_n( &pRing->tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+            break;                                        // Slot claimed
+        if( dif < 0 ) return false;                       // Full
+        if( dif > 0 ) pos = __atomic_load_n( &pRing->tail, __ATOMIC_RELAXED );
+    }
+    pSlot->item = item;
+    __atomic_store_n( &pSlot->seq, pos + 1, __ATOMIC_RELEASE );
+    return true;
+}
+
+// Take the oldest item from the ring, if there is one
+bool ringTake( Ring* pRing, void** pItem )
+{
+    RingSlot* pSlot = NULL;
+    size_t    pos   = __atomic_load_n( &pRing->head, __ATOMIC_RELAXED );
+    long      dif   = 0;
+
+    for( ;; )
+    {
+        pSlot = &pRing->slot[pos % PIPE_RING];
+        dif   = (long)( __atomic_load_n( &pSlot->seq, __ATOMIC_ACQUIRE ) - ( pos + 1 ) );
+        if( dif == 0 && __atomic_compare_exchange_n( &pRing->head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+            break;                                        // Item claimed
+        if( dif < 0 ) return false;                       // Empty
+        if( dif > 0 ) pos = __atomic_load_n( &pRing->head, __ATOMIC_RELAXED );
+    }
+    *pItem = pSlot->item;
+    __atomic_store_n( &pSlot->seq, pos + PIPE_RING, __ATOMIC_RELEASE );
+    return true;
+}
+
+// Put an item in the ring, waiting for room if need be - briefly yielding, then asleep until an item is taken
+// (Threads only wait through ringSend and ringWait, so only they need to wake the others)
+void ringSend( Ring* pRing, void* item )
+{
+    int spins = 0;
+
+    while( ! ringPut( pRing, item ) )
+    {
+        if( ++spins < PIPE_SPINS )
+        {
+            sched_yield();
+            continue;
+        }
+        pthread_mutex_lock( &pRing->lock );
+        __atomic_fetch_add( &pRing->sleepers, 1, __ATOMIC_RELAXED );
+        __atomic_thread_fence( __ATOMIC_SEQ_CST );         // Counted before the last look, as ringWake expects
+        while( ! ringPut( pRing, item ) ) pthread_cond_wait( &pRing->changed, &pRing->lock );
+        __atomic_fetch_sub( &pRing->sleepers, 1, __ATOMIC_RELAXED );
+        pthread_mutex_unlock( &pRing->lock );
+        break;
+    }
+    ringWake( pRing );
+}
+
+// Take an item from the ring, waiting for one if need be - briefly yielding, then asleep until an item is put
+void* ringWait( Ring* pRing )
+{
+    void* item  = NULL;
+    int   spins = 0;
+
+    while( ! ringTake( pRing, &item ) )
+    {
+        if( ++spins < PIPE_SPINS )
+        {
+            sched_yield();
+            continue;
+        }
+        pthread_mutex_lock( &pRing->lock );
+        __atomic_fetch_add( &pRing->sleepers, 1, __ATOMIC_RELAXED );
+        __atomic_thread_fence( __ATOMIC_SEQ_CST );         // Counted before the last look, as ringWake expects
+        while( ! ringTake( pRing, &item ) ) pthread_cond_wait( &pRing->changed, &pRing->lock );
+        __atomic_fetch_sub( &pRing->sleepers, 1, __ATOMIC_RELAXED );
+        pthread_mutex_unlock( &pRing->lock );
+        break;
+    }
+    ringWake( pRing );
+    return item;
+}
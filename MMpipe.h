@@ -0,0 +1,97 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMPIPE_H
+#define MMPIPE_H
+
+#include "MMchk.h"
+#include "MMscan.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#ifndef PIPE_BLOCK_SIZE
+#define PIPE_BLOCK_SIZE        ( 1 << 20 )             // Bytes read from the file at a time (can be set when building)
+#endif
+#define PIPE_BUFFERS           8                       // Blocks of text in flight - bounds the memory used for reading ahead
+#define PIPE_RING              16                      // Slots in each ring (a power of two, more than PIPE_BUFFERS plus threads)
+#define PIPE_SPINS             64                      // Tries at a full or empty ring before sleeping until it changes
+#define PIPE_MARKS             ( 2 * PIPE_BLOCK_SIZE + 2 )   // Most structural characters a block can have (one per byte)
+
+// A block of whole lines from the solution file, and the solutions parsed from it
+typedef struct Block
+{
+    char*         text;                                // The lines (NULL once parsed)
+    long          length;
+    int           firstLine;                           // Index of the first line in the file (not counting the header)
+    int           lines;
+    Solution*     soln;                                // Parsed solutions for the lines
+    struct Block* next;                                // Blocks are kept in file order
+} Block;
+
+// Slot of a ring - the sequence number says whether it is ready to fill or ready to take
+typedef struct RingSlot
+{
+    size_t        seq;
+    void*         item;
+} RingSlot;
+
+// Bounded lock-free ring, connecting one stage of the pipeline to the next
+// The head and tail are kept on separate cache lines, so producers and consumers do not slow each other down
+// A thread that has waited a while for room (or an item) sleeps on the condition, and is woken by the next put or take
+typedef struct Ring
+{
+    RingSlot      slot[PIPE_RING];
+    char          pad1[64];
+    size_t        head;                                // Next slot to take from
+    char          pad2[64];
+    size_t        tail;                                // Next slot to fill
+    char          pad3[64];
+    int           sleepers;                            // Threads asleep (or about to be) on changed
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;                           // Signalled when an item is put or taken while any are asleep
+} Ring;
+
+// Shared state of the pipeline
+typedef struct Pipe
+{
+    Repo*         pRepo;
+    long          start;                               // Offset of the first line after the header
+    Ring          toParse;                             // Blocks read, waiting to be parsed
+    Ring          toCheck;                             // Blocks parsed, waiting to be checked
+    Ring          spare;                               // Text buffers free for the reader
+    Block*        first;                               // Every block, in file order
+    int           parsers;                             // Parser threads running (0 to parse on the reader)
+    int           checkers;                            // Checker threads running (0 to check on the parsers)
+    int           parsing;                             // Parsers yet to finish
+    int           failed;                              // Set if any stage fails
+    uint32_t*     marks;                               // Marks for blocks parsed by the reader (if there are no parser threads)
+} Pipe;
+
+bool  canPipeline( Repo* pRepo );
+int   pipeCheck( Repo* pRepo );
+int   readBlocks( Pipe* pPipe );
+void  sendBlock( Pipe* pPipe, Block* pBlock );
+void* parseBlocks( void* arg );
+int   parseBlock( Repo* pRepo, Block* pBlock, uint32_t* marks );
+void  pipeFail( Pipe* pPipe, const char* reason );
+void* checkBlocks( void* arg );
+void  checkBlock( Repo* pRepo, Block* pBlock );
+int   countLines( char* text, long length );
+void  ringInit( Ring* pRing );
+void  ringFree( Ring* pRing );
+void  ringWake( Ring* pRing );
+bool  ringPut( Ring* pRing, void* item );
+bool  ringTake( Ring* pRing, void** pItem );
+void  ringSend( Ring* pRing, void* item );
+void* ringWait( Ring* pRing );
+
+#endif  /* MMPIPE_H */
@@ -0,0 +1,261 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Progress of a run, written with the errors (stderr) - a line a second with --progress, and a snapshot whenever SIGUSR1 is received
+// The checks count lines, bytes and problems into per-thread slots as they go, with a relaxed atomic add
+// A monitor thread adds the slots up only when something is to be shown, so counting costs next to nothing
+// (The signal handler only notes the request - the monitor, which is not in a signal handler, writes the snapshot)
+//
+#include "MMprogress.h"
+#include "MMchk.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/stat.h>
+
+static volatile sig_atomic_t snapshotWanted = 0;       // Set by SIGUSR1
+static int                   nextSlot       = 0;       // Slot for the next thread to count
+static __thread int          threadSlot     = -1;      // This thread's slot (-1 until it first counts)
+
+// Start watching the run - the monitor always takes snapshots, and with --progress shows a line a second too
+// Not for the daemon or its clients, which have many runs (or none) of their own
+int startProgress( Repo* pRepo )
+{
+    Progress*        pProgress = NULL;
+    struct sigaction action;
+    struct stat      info;
+
+    if( pRepo->daemonName != NULL || pRepo->clientName != NULL ) return 0;
+
+    if( posix_memalign( (void**)&pProgress, 64, sizeof(Progress) ) != 0 )
+    {
+        fprintf( pRepo->err, "Failed to allocate progress counters\n" );
+        return -1;
+    }
+    memset( pProgress, 0, sizeof(Progress) );
+    pthread_mutex_init( &pProgress->lock, NULL );
+    pthread_cond_init( &pProgress->wake, NULL );
+    pProgress->periodic = pRepo->showProgress;
+    pProgress->start    = progressClock();
+    pProgress->lastTime = pProgress->start;
+    if( pRepo->fp != NULL && fstat( fileno( pRepo->fp ), &info ) == 0 && S_ISREG( info.st_mode ) )
+        pProgress->fileSize = info.st_size;
+
+    pRepo->progress = pProgress;
+    if( pthread_create( &pProgress->thread, NULL, progressMonitor, pRepo ) != 0 )
+    {
+        // No monitor, so nothing to count for
+        pRepo->progress = NULL;
+        pthread_mutex_destroy( &pProgress->lock );
+        pthread_cond_destroy( &pProgress->wake );
+        free( pProgress );
+        return 0;
+    }
+
+    memset( &action, 0, sizeof(action) );
+    action.sa_handler = snapshotSignal;
+    action.sa_flags   = SA_RESTART;
+    sigemptyset( &action.sa_mask );
+    sigaction( SIGUSR1, &action, &pProgress->oldAction );
+
+    return 0;
+}
+
+// Stop the monitor, and put SIGUSR1 back as it was
+void stopProgress( Repo* pRepo )
+{
+    Progress* pProgress = pRepo->progress;
+
+    if( pProgress == NULL ) return;
+
+    pthread_mutex_lock( &pProgress->lock );
+    pProgress->stop = true;
+    pthread_cond_signal( &pProgress->wake );
+    pthread_mutex_unlock( &pProgress->lock );
+    pthread_join( pProgress->thread, NULL );
+    sigaction( SIGUSR1, &pProgress->oldAction, NULL );
+
+    pthread_mutex_destroy( &pProgress->lock );
+    pthread_cond_destroy( &pProgress->wake );
+    free( pProgress );
+    pRepo->progress = NULL;
+}
+
+// A new phase of the run is starting
+void progressPhase( Repo* pRepo, const char* name )
+{
+    Progress* pProgress = pRepo->progress;
+    long long problems  = 0;
+
+    if( pProgress == NULL ) return;
+
+    pthread_mutex_lock( &pProgress->lock );
+    pProgress->phase      = name;
+    pProgress->phaseStart = progressClock();
+    pProgress->total      = pRepo->actualCodes;
+    progressTotals( pProgress, &pProgress->phaseLines, &pProgress->phaseBytes, &problems );
+    pthread_mutex_unlock( &pProgress->lock );
+}
+
+// Count into this thread's slot
+// Threads are given slots in turn, so only threads more than PROGRESS_SLOTS apart can share one - the adds are atomic
+// in case they do
+void progressAdd( Progress* pProgress, long long lines, long long bytes, long long problems )
+{
+    ProgressSlot* pSlot = NULL;
+
+    if( threadSlot < 0 )
+        threadSlot = __atomic_fetch_add( &nextSlot, 1, __ATOMIC_RELAXED ) % PROGRESS_SLOTS;
+    pSlot = &pProgress->slot[threadSlot];
+
+    if( lines != 0 )    __atomic_fetch_add( &pSlot->lines, lines, __ATOMIC_RELAXED );
+    if( bytes != 0 )    __atomic_fetch_add( &pSlot->bytes, bytes, __ATOMIC_RELAXED );
+    if( problems != 0 ) __atomic_fetch_add( &pSlot->problems, problems, __ATOMIC_RELAXED );
+}
+
+// Add up the slots
+void progressTotals( Progress* pProgress, long long* pLines, long long* pBytes, long long* pProblems )
+{
+    int s = 0;
+
+    *pLines    = 0;
+    *pBytes    = 0;
+    *pProblems = 0;
+    for( s = 0; s < PROGRESS_SLOTS; s++ )
+    {
+        *pLines    += __atomic_load_n( &pProgress->slot[s].lines, __ATOMIC_RELAXED );
+        *pBytes    += __atomic_load_n( &pProgress->slot[s].bytes, __ATOMIC_RELAXED );
+        *pProblems += __atomic_load_n( &pProgress->slot[s].problems, __ATOMIC_RELAXED );
+    }
+}
+
+// Monitor thread - wakes every PROGRESS_POLL_MS to look for a snapshot request, or for a progress line being due
+void* progressMonitor( void* arg )
+{
+    Repo*           pRepo     = (Repo*)arg;
+    Progress*       pProgress = pRepo->progress;
+    struct timespec until;
+    double          now       = 0;
+
+    pthread_mutex_lock( &pProgress->lock );
+    while( ! pProgress->stop )
+    {
+        clock_gettime( CLOCK_REALTIME, &until );
+        until.tv_nsec += PROGRESS_POLL_MS * 1000000L;
+        until.tv_sec  += until.tv_nsec / 1000000000L;
+        until.tv_nsec %= 1000000000L;
+        pthread_cond_timedwait( &pProgress->wake, &pProgress->lock, &until );
+        if( pProgress->stop ) break;
+
+        now = progressClock();
+        if( snapshotWanted )
+        {
+            snapshotWanted = 0;
+            progressSnapshot( pRepo, now );
+        }
+        if( pProgress->periodic && pProgress->phase != NULL && now - pProgress->lastTime >= PROGRESS_INTERVAL )
+            progressLine( pRepo, now );
+    }
+    pthread_mutex_unlock( &pProgress->lock );
+
+    return NULL;
+}
+
+// One line of progress - the phase, lines done (of how many, if known), rates since the last line and an ETA
+// The ETA is for the phase under way - from the lines still to do, or if the lines are still being counted the bytes
+void progressLine( Repo* pRepo, double now )
+{
+    Progress* pProgress = pRepo->progress;
+    long long lines     = 0;
+    long long bytes     = 0;
+    long long problems  = 0;
+    long long done      = 0;
+    double    interval  = now - pProgress->lastTime;
+    double    elapsed   = now - pProgress->phaseStart;
+    double    eta       = -1;
+
+    progressTotals( pProgress, &lines, &bytes, &problems );
+    done = lines - pProgress->phaseLines;
+
+    fprintf( pRepo->err, "progress: %-14s %7.1fs  %lld", pProgress->phase, now - pProgress->start, done );
+    if( pProgress->total > 0 )
+    {
+        fprintf( pRepo->err, " of %lld lines (%.0f%%)", pProgress->total, 100.0 * done / pProgress->total );
+        if( done > 0 && done <= pProgress->total )
+            eta = ( pProgress->total - done ) * elapsed / done;
+    }
+    else
+    {
+        fprintf( pRepo->err, " lines" );
+        if( pProgress->fileSize > 0 && bytes > pProgress->phaseBytes )
+            eta = ( pProgress->fileSize - ( bytes - pProgress->phaseBytes ) ) * elapsed / ( bytes - pProgress->phaseBytes );
+    }
+    fprintf( pRepo->err, "  %.0f lines/s  %.1f MB read  %.1f MB/s  %lld problems",
+             ( lines - pProgress->lastLines ) / interval, bytes / 1e6, ( bytes - pProgress->lastBytes ) / 1e6 / interval, problems );
+    if( eta >= 0 )
+        fprintf( pRepo->err, "  ETA %.0fs", eta );
+    fprintf( pRepo->err, "\n" );
+
+    pProgress->lastTime  = now;
+    pProgress->lastLines = lines;
+    pProgress->lastBytes = bytes;
+}
+
+// Everything counted so far, with what each slot has counted
+void progressSnapshot( Repo* pRepo, double now )
+{
+    Progress* pProgress = pRepo->progress;
+    long long lines     = 0;
+    long long bytes     = 0;
+    long long problems  = 0;
+    int       s         = 0;
+
+    progressTotals( pProgress, &lines, &bytes, &problems );
+
+    fprintf( pRepo->err, "Status of %s after %.1fs\n", pRepo->baseName, now - pProgress->start );
+    if( pProgress->phase != NULL )
+        fprintf( pRepo->err, "  Phase           %s (for %.1fs, %lld lines)\n", pProgress->phase, now - pProgress->phaseStart,
+                 lines - pProgress->phaseLines );
+    else
+        fprintf( pRepo->err, "  Phase           starting\n" );
+    fprintf( pRepo->err, "  Lines handled   %lld", lines );
+    if( pProgress->total > 0 ) fprintf( pRepo->err, " over all phases (%lld in the file)", pProgress->total );
+    fprintf( pRepo->err, "\n  Bytes read      %lld", bytes );
+    if( pProgress->fileSize > 0 ) fprintf( pRepo->err, " (%lld in the file)", pProgress->fileSize );
+    fprintf( pRepo->err, "\n  Problems found  %lld\n", problems );
+    for( s = 0; s < PROGRESS_SLOTS; s++ )
+    {
+        lines    = __atomic_load_n( &pProgress->slot[s].lines, __ATOMIC_RELAXED );
+        bytes    = __atomic_load_n( &pProgress->slot[s].bytes, __ATOMIC_RELAXED );
+        problems = __atomic_load_n( &pProgress->slot[s].problems, __ATOMIC_RELAXED );
+        if( lines != 0 || bytes != 0 || problems != 0 )
+            fprintf( pRepo->err, "  Slot %-2d         %lld lines, %lld bytes, %lld problems\n", s, lines, bytes, problems );
+    }
+}
+
+// SIGUSR1 - ask the monitor for a snapshot
+void snapshotSignal( int sig )
+{
+    (void)sig;
+    snapshotWanted = 1;
+}
+
+// Seconds on the monotonic clock
+double progressClock( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
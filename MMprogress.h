@@ -0,0 +1,77 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMPROGRESS_H
+#define MMPROGRESS_H
+
+#include "MMchk.h"
+
+#include <pthread.h>
+#include <signal.h>
+
+#define PROGRESS_SLOTS         16                      // Counters are spread over this many cache lines, a thread to each
+#define PROGRESS_INTERVAL      1.0                     // Seconds between progress lines (--progress)
+#define PROGRESS_POLL_MS       100                     // How often the monitor looks for a snapshot request (SIGUSR1)
+
+// Counters for the threads using one slot - on a cache line of their own, so threads don't share lines as they count
+typedef struct ProgressSlot
+{
+    long long   lines;                                 // Lines parsed or checked
+    long long   bytes;                                 // Bytes read
+    long long   problems;                              // Problems found (a line with several counts for each)
+    char        pad[40];
+} __attribute__(( aligned( 64 ) )) ProgressSlot;
+
+// Progress of a run, watched by a monitor thread
+typedef struct Progress
+{
+    ProgressSlot    slot[PROGRESS_SLOTS];              // Only added up when progress is shown
+    pthread_t       thread;
+    pthread_mutex_t lock;                              // Guards everything below
+    pthread_cond_t  wake;
+    bool            stop;
+    bool            periodic;                          // A line every PROGRESS_INTERVAL, not just snapshots
+    const char*     phase;                             // Phase under way (NULL before the first)
+    double          start;
+    double          phaseStart;
+    long long       phaseLines;                        // Lines counted before the phase started
+    long long       phaseBytes;
+    long long       total;                             // Lines in the file (0 until they have been counted)
+    long long       fileSize;                          // Bytes in the file (0 if not known, eg a pipe)
+    double          lastTime;                          // When the last progress line was shown
+    long long       lastLines;
+    long long       lastBytes;
+    struct sigaction oldAction;                        // SIGUSR1 as it was before the run, put back when it ends
+} Progress;
+
+int   startProgress( Repo* pRepo );
+void  stopProgress( Repo* pRepo );
+void  progressPhase( Repo* pRepo, const char* name );
+void  progressAdd( Progress* pProgress, long long lines, long long bytes, long long problems );
+void  progressTotals( Progress* pProgress, long long* pLines, long long* pBytes, long long* pProblems );
+void* progressMonitor( void* arg );
+void  progressLine( Repo* pRepo, double now );
+void  progressSnapshot( Repo* pRepo, double now );
+void  snapshotSignal( int sig );
+double progressClock( void );
+
+// Count lines parsed or checked, and bytes read - nothing is counted unless progress is being watched
+static inline void progressCount( Repo* pRepo, long long lines, long long bytes )
+{
+    if( pRepo->progress != NULL ) progressAdd( pRepo->progress, lines, bytes, 0 );
+}
+
+// Count problems found
+static inline void progressProblems( Repo* pRepo, long long problems )
+{
+    if( pRepo->progress != NULL && problems > 0 ) progressAdd( pRepo->progress, 0, 0, problems );
+}
+
+#endif  /* MMPROGRESS_H */
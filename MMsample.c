@@ -0,0 +1,267 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Statistical sampling of a solution file
+// Rather than checking every line, a random subset of lines is checked - so the time taken depends on the...
+// ..size of the sample and not on the size of the file
+//
+#include "MMsample.h"
+#include "MMchk.h"
+#include "MMutility.h"
+#include "MMsortfns.h"
+#include "MMkernels.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define MAX_LISTED             20                      // Most sampled errors to list in the report
+
+// Check a random sample of the lines in a solution file
+// Marks, turn counts and resolution are checked for each line sampled
+// Consistency of guesses is checked between the sampled lines (each being a random root-to-leaf path)
+// Completeness cannot be checked from a sample - that needs the full run
+int sampleCheck( Repo* pRepo )
+{
+    char   line[256];
+    long*  offsets    = NULL;
+    long   dataStart  = 0;
+    long   fileSize   = 0;
+    double lines      = 0;
+    int    fields     = 0;
+    int    colours    = 0;
+    int    wanted     = 0;
+    int    found      = 0;
+    int    i          = 0;
+    int    g          = 0;
+    int    rc         = 0;
+
+    rc = parseHeader( pRepo );       if( rc ) return rc;    // Check header and find max number of guesses
+    rc = countPegs( pRepo );         if( rc ) return rc;    // Return the number of pegs in each code
+
+    // Find where the solutions start and how big the file is
+    fseek( pRepo->fp, 0, SEEK_SET );
+    getLine( pRepo->fp, line, 256 );
+    dataStart = ftell( pRepo->fp );
+    fields = getLine( pRepo->fp, line, 256 );
+    fseek( pRepo->fp, 0, SEEK_END );
+    fileSize = ftell( pRepo->fp );
+    if( fields == EOF || pRepo->pegs == 0 )
+    {
+        fprintf( pRepo->err, "No solutions in file to sample\n" );
+        return -1;
+    }
+
+    // Estimate how many lines there are, without reading them all
+    // If we know the number of colours from the filename this is easy, otherwise estimate from the length of the first line
+    if( pRepo->colours > 0 )
+        lines = pow( pRepo->colours, pRepo->pegs );
+    else
+        lines = (double)( fileSize - dataStart ) / ( strlen( line ) + 1 );
+
+    if( pRepo->sampleRate > 0 )
+        wanted = (int)ceil( pRepo->sampleRate * lines );
+    else
+        wanted = pRepo->sampleSize;
+    if( wanted > lines ) wanted = (int)lines;
+    if( wanted < 1 ) wanted = 1;
+
+    offsets = (long*)malloc( sizeof(long) * wanted );
+    if( offsets == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate sample offsets\n" );
+        return -1;
+    }
+    if( pRepo->seed == 0 ) pRepo->seed = (unsigned long long)time( NULL );
+    found = sampleLines( pRepo, dataStart, fileSize, wanted, offsets );
+
+    // If the filename did not tell us the number of colours, use the highest colour seen in the sampled codes
+    if( pRepo->colours == 0 )
+    {
+        for( i = 0; i < found; i++ )
+        {
+            readLineAt( pRepo, offsets[i], line, 256 );
+            for( g = 0; line[g] != ',' && line[g] != '\0'; g++ );
+            if( line[g] == ',' ) g++;
+            for( ; line[g] != ',' && line[g] != '\0'; g++ )
+                if( line[g] >= 'A' && line[g] - 'A' + 1 > colours ) colours = line[g] - 'A' + 1;
+        }
+        pRepo->colours = colours;
+        lines = pow( pRepo->colours, pRepo->pegs );
+    }
+    pRepo->codes = round( pow( pRepo->colours, pRepo->pegs ) );
+    selectKernel( pRepo );
+    pRepo->actualCodes = found;
+
+    // Parse and check each sampled line on its own
+    rc = newSolutions( pRepo, found ); if( rc ) return rc;
+    for( i = 0; i < found; i++ )
+    {
+        fields = readLineAt( pRepo, offsets[i], line, 256 );
+        pRepo->data[i].line = i;                                 // Index into the sample offsets
+        if( parseLine( pRepo, &pRepo->data[i], line, fields ) != 0 )
+            continue;                                            // More guesses than expected - left unresolved
+        countTurns( pRepo, &pRepo->data[i] );
+        for( g = 0; g < pRepo->data[i].actualNoTurns && g < pRepo->guesses; g++ )
+            if( pRepo->data[i].code >= 0 && pRepo->data[i].code < pRepo->codes && pRepo->data[i].turns[g].guess >= 0 )
+                pRepo->data[i].turns[g].markOK = ( pRepo->data[i].turns[g].mark == scoreCodes( pRepo, pRepo->data[i].turns[g].guess, pRepo->data[i].code ) );
+    }
+
+    // Consistency between the sampled paths through the strategy
+    rc = checkGuesses( pRepo );      if( rc ) return rc;
+
+    rc = reportSample( pRepo, offsets, lines );
+
+    free( offsets );
+    return rc;
+}
+
+// Pick lines at random from the file, by picking random byte offsets and finding the line around each one
+// Longer lines would be picked more often, so each is accepted with a probability inversely proportional to its length
+// This keeps the sample uniform over lines
+// Returns the number of (distinct) lines found, their starting offsets are in order
+int sampleLines( Repo* pRepo, long dataStart, long fileSize, int wanted, long* offsets )
+{
+    unsigned long long state    = 0;
+    char               window[512];
+    long               start    = 0;
+    long               offset   = 0;
+    long               draws    = 0;
+    int                minLen   = 0;
+    int                len      = 0;
+    int                found    = 0;
+    int                unique   = 0;
+    int                b        = 0;
+    int                e        = 0;
+    int                i        = 0;
+
+    state = pRepo->seed ^ 0x9E3779B97F4A7C15ULL;          // Never zero for any sensible seed
+
+    // The shortest possible line - eg "0,AAAA,1,AAAA,bbbb" - plus its new line
+    minLen = 3 * pRepo->pegs + 7;
+
+    while( unique < wanted && draws < (long)wanted * 50 )
+    {
+        for( found = unique; found < wanted && draws < (long)wanted * 50; draws++ )
+        {
+            offset = dataStart + (long)( nextRandom( &state ) % (unsigned long long)( fileSize - dataStart ) );
+            start  = offset - 255 > dataStart ? offset - 255 : dataStart;
+            fseek( pRepo->fp, start, SEEK_SET );
+            len = fread( window, 1, 512, pRepo->fp );
+
+            // Find the start and end of the line containing this offset
+            for( b = offset - start; b > 0 && window[b-1] != '\n'; b-- );
+            if( b == 0 && start != dataStart ) continue;        // Line too long to be valid - try again
+            for( e = b; e < len && window[e] != '\n'; e++ );
+            if( e == b || ( e == b + 1 && window[b] == '\r' ) ) continue;   // Blank line
+
+            if( (double)( nextRandom( &state ) % 1000000 ) / 1000000.0 < (double)minLen / ( e - b + 1 ) )
+                offsets[found++] = start + b;
+        }
+
+        // Drop any line picked more than once
+        qsort( offsets, found, sizeof(long), cmpOffsetOrder );
+        for( unique = 0, i = 0; i < found; i++ )
+            if( unique == 0 || offsets[i] != offsets[unique-1] ) offsets[unique++] = offsets[i];
+    }
+    return unique;
+}
+
+// Read a line starting at the given offset of the file
+// Returns the number of fields in the line, as getLine does
+int readLineAt( Repo* pRepo, long offset, char* line, int maxLen )
+{
+    fseek( pRepo->fp, offset, SEEK_SET );
+    return getLine( pRepo->fp, line, maxLen );
+}
+
+// Describe the first problem with a sampled solution, or NULL if it looks good
+char* sampleFault( Repo* pRepo, Solution* pSoln )
+{
+    char* fault = NULL;
+    int   j     = 0;
+
+    fault = lineFault( pRepo, pSoln );
+    if( fault != NULL ) return fault;
+
+    for( j = 0; j < pSoln->actualNoTurns; j++ )
+        if( ! pSoln->turns[j].markOK ) return "Mark(s) wrong";
+
+    if( ! pSoln->guessConsistant ) return "Inconsistent guesses";
+
+    return NULL;
+}
+
+// Report on a sample, including the bound on the error rate that the sample size allows
+int reportSample( Repo* pRepo, long* offsets, double lines )
+{
+    char   line[256];
+    char*  fault    = NULL;
+    double rate     = 0;
+    double low      = 0;
+    double high     = 0;
+    double z        = 1.96;                 // 95% confidence
+    double n        = pRepo->actualCodes;
+    long   turns    = 0;
+    int    errors   = 0;
+    int    listed   = 0;
+    int    i        = 0;
+
+    say( pRepo, "\nAnalysis of %s:   Sample of %d lines from about %.0f (seed %llu)\n", pRepo->baseName, pRepo->actualCodes, lines, pRepo->seed );
+
+    // Data will have been sorted by checkGuesses, the line number is the index into the offsets
+    for( i = 0; i < pRepo->actualCodes; i++ )
+    {
+        turns += pRepo->data[i].noTurns > 0 ? pRepo->data[i].noTurns : 0;
+        fault = sampleFault( pRepo, &pRepo->data[i] );
+        if( fault != NULL )
+        {
+            errors += 1;
+            if( listed < MAX_LISTED )
+            {
+                readLineAt( pRepo, offsets[pRepo->data[i].line], line, 256 );
+                say( pRepo, "  Byte offset %ld: %s\n    %s\n", offsets[pRepo->data[i].line], fault, line );
+                listed += 1;
+            }
+        }
+    }
+    if( errors > listed )
+        say( pRepo, "  (and %d more)\n", errors - listed );
+
+    if( errors == 0 )
+    {
+        // No failures in n trials - the upper bound p satisfies (1-p)^n = 0.05
+        high = 1.0 - pow( 0.05, 1.0 / n );
+        say( pRepo, "No errors found in sample.  With 95%% confidence fewer than %.3f%% of lines (about %.0f) are in error\n", high * 100.0, ceil( high * lines ) );
+    }
+    else
+    {
+        // Wilson score interval for the proportion of lines in error
+        rate = errors / n;
+        low  = ( rate + z*z/(2*n) - z * sqrt( rate*(1-rate)/n + z*z/(4*n*n) ) ) / ( 1 + z*z/n );
+        high = ( rate + z*z/(2*n) + z * sqrt( rate*(1-rate)/n + z*z/(4*n*n) ) ) / ( 1 + z*z/n );
+        say( pRepo, "Errors found in %d of %d sampled lines.  With 95%% confidence %.3f%% to %.3f%% of lines are in error\n", errors, pRepo->actualCodes, low * 100.0, high * 100.0 );
+    }
+    say( pRepo, "Estimated TTTS = %.0f   (Completeness is not checked when sampling)\n\n", turns / n * lines );
+
+    return 0;
+}
+
+// Simple xorshift* random number generator - good enough for picking lines, and repeatable for a given seed
+unsigned long long nextRandom( unsigned long long* state )
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
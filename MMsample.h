@@ -0,0 +1,23 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMSAMPLE_H
+#define MMSAMPLE_H
+
+#include "MMchk.h"
+
+int   sampleCheck( Repo* pRepo );
+int   sampleLines( Repo* pRepo, long dataStart, long fileSize, int wanted, long* offsets );
+int   readLineAt( Repo* pRepo, long offset, char* line, int maxLen );
+char* sampleFault( Repo* pRepo, Solution* pSoln );
+int   reportSample( Repo* pRepo, long* offsets, double lines );
+unsigned long long nextRandom( unsigned long long* state );
+
+#endif  /* MMSAMPLE_H */
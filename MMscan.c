@@ -0,0 +1,350 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Structural scanning of the solution text - finding every comma, newline, \r and \0 in a buffer in one pass
+// With AVX2 or SSE2 this is 64 bytes at a time: each byte is compared with the four characters at once, and the
+// matches gathered into a 64 bit mask whose set bits are the offsets.  The scanner is chosen when the program starts,
+// from what the processor has (or by --scanner), with a plain loop for any other processor
+// Lines are then split into fields from the offsets found, without looking at each byte again
+// Anything unusual about a line (\r or \0 in it, or too long to keep) and it is handed back as getLine would return it,
+// to be parsed by parseLine as before - so the checks see exactly what they would have seen
+//
+#include "MMscan.h"
+#include "MMchk.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#define SCAN_X86
+#endif
+
+// Record the offset of each set bit of a 64 bit mask of the bytes from base
+static inline long emitMarks( uint32_t* marks, long count, long base, uint64_t bits )
+{
+    while( bits != 0 )
+    {
+        marks[count++] = (uint32_t)( base + __builtin_ctzll( bits ) );
+        bits &= bits - 1;
+    }
+    return count;
+}
+
+// Scan the bytes from i to length one at a time - all of the scalar scanner, and the tail of the others
+static inline long scanTail( const char* text, long i, long length, uint32_t* marks, long count )
+{
+    for( ; i < length; i++ )
+        if( text[i] == ',' || text[i] == '\n' || text[i] == '\r' || text[i] == '\0' )
+            marks[count++] = (uint32_t)i;
+    return count;
+}
+
+static long scanScalar( const char* text, long length, uint32_t* marks )
+{
+    return scanTail( text, 0, length, marks, 0 );
+}
+
+static bool usableScalar( void )
+{
+    return true;
+}
+
+#ifdef SCAN_X86
+// Bytes of a 16 byte vector that are structural, as a mask of 16 bits
+__attribute__(( target( "sse2" ) ))
+static inline uint64_t structural128( const char* p )
+{
+    __m128i v = _mm_loadu_si128( (const __m128i*)p );
+    __m128i s = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( v, _mm_set1_epi8( ',' ) ), _mm_cmpeq_epi8( v, _mm_set1_epi8( '\n' ) ) ),
+                              _mm_or_si128( _mm_cmpeq_epi8( v, _mm_set1_epi8( '\r' ) ), _mm_cmpeq_epi8( v, _mm_setzero_si128() ) ) );
+
+    return (uint64_t)(uint16_t)_mm_movemask_epi8( s );
+}
+
+__attribute__(( target( "sse2" ) ))
+static long scanSSE2( const char* text, long length, uint32_t* marks )
+{
+    uint64_t bits  = 0;
+    long     count = 0;
+    long     i     = 0;
+
+    for( i = 0; i + 64 <= length; i += 64 )
+    {
+        bits = structural128( text + i ) | structural128( text + i + 16 ) << 16 |
+               structural128( text + i + 32 ) << 32 | structural128( text + i + 48 ) << 48;
+        count = emitMarks( marks, count, i, bits );
+    }
+    return scanTail( text, i, length, marks, count );
+}
+
+static bool usableSSE2( void )
+{
+    return __builtin_cpu_supports( "sse2" );
+}
+
+// Bytes of a 32 byte vector that are structural, as a mask of 32 bits
+__attribute__(( target( "avx2" ) ))
+static inline uint64_t structural256( const char* p )
+{
+    __m256i v = _mm256_loadu_si256( (const __m256i*)p );
+    __m256i s = _mm256_or_si256( _mm256_or_si256( _mm256_cmpeq_epi8( v, _mm256_set1_epi8( ',' ) ), _mm256_cmpeq_epi8( v, _mm256_set1_epi8( '\n' ) ) ),
+                                 _mm256_or_si256( _mm256_cmpeq_epi8( v, _mm256_set1_epi8( '\r' ) ), _mm256_cmpeq_epi8( v, _mm256_setzero_si256() ) ) );
+
+    return (uint64_t)(uint32_t)_mm256_movemask_epi8( s );
+}
+
+__attribute__(( target( "avx2" ) ))
+static long scanAVX2( const char* text, long length, uint32_t* marks )
+{
+    uint64_t bits  = 0;
+    long     count = 0;
+    long     i     = 0;
+
+    for( i = 0; i + 64 <= length; i += 64 )
+    {
+        bits  = structural256( text + i ) | structural256( text + i + 32 ) << 32;
+        count = emitMarks( marks, count, i, bits );
+    }
+    return scanTail( text, i, length, marks, count );
+}
+
+static bool usableAVX2( void )
+{
+    return __builtin_cpu_supports( "avx2" );
+}
+#endif
+
+// Fastest first - "auto" takes the first the processor can run
+static const Scanner scanners[] =
+{
+#ifdef SCAN_X86
+    { "avx2",   scanAVX2,   usableAVX2   },
+    { "sse2",   scanSSE2,   usableSSE2   },
+#endif
+    { "scalar", scanScalar, usableScalar },
+};
+
+// Find the scanner by name ("auto" for the fastest this processor can run)
+// Returns NULL if there is no such scanner, or the processor can't run it
+const Scanner* findScanner( const char* name )
+{
+    int i = 0;
+
+    for( i = 0; i < (int)( sizeof(scanners) / sizeof(scanners[0]) ); i++ )
+        if( ( strcmp( name, "auto" ) == 0 || strcmp( name, scanners[i].name ) == 0 ) && scanners[i].usable() )
+            return &scanners[i];
+    return NULL;
+}
+
+// Start reading the solution file from where it is now, a buffer at a time
+int openScan( ScanFile* pScan, Repo* pRepo )
+{
+    memset( pScan, 0, sizeof(ScanFile) );
+    pScan->fp      = pRepo->fp;
+    pScan->err     = pRepo->err;
+    pScan->scanner = pRepo->scanner != NULL ? pRepo->scanner : findScanner( "auto" );
+    pScan->size    = SCAN_BUFFER;
+    pScan->text    = (char*)malloc( pScan->size );
+    pScan->marks   = (uint32_t*)malloc( sizeof(uint32_t) * pScan->size );
+    if( pScan->text == NULL || pScan->marks == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate buffers in openScan\n" );
+        closeScan( pScan );
+        return -1;
+    }
+    return 0;
+}
+
+// Get the next line, as getLine would - blank lines are stepped over (but counted), and EOF is returned at the end of the file
+// Otherwise the number of fields is returned, and the line is split into them if it is plain
+int scanLine( ScanFile* pScan, ScanLine* pLine )
+{
+    long start  = 0;
+    long eol    = 0;
+    long next   = 0;
+    long len    = 0;
+    int  crs    = 0;
+    int  fields = 0;
+
+    for( ;; )
+    {
+        if( pScan->pos >= pScan->length && pScan->eof ) return EOF;
+
+        next = pScan->next;
+        eol  = findLineEnd( pScan->text, pScan->pos, pScan->length, pScan->marks, pScan->count, &next, pLine, &len, &crs );
+        if( eol == pScan->length && ! pScan->eof )
+        {
+            // The rest of the line is still to be read
+            if( refillScan( pScan ) != 0 ) return EOF;
+            continue;
+        }
+        start          = pScan->pos;
+        pScan->pos     = eol + 1;
+        pScan->next    = next;
+        pScan->lines  += 1;
+        pLine->number  = pScan->lines;
+
+        // getLine drops the \r of a \r\n ending, so a plain line may have one
+        if( pLine->split && crs <= 1 )
+        {
+            if( len == 0 ) continue;                   // Blank lines are ignored
+            splitLine( pLine, pScan->text + start, len );
+            return pLine->fields;
+        }
+
+        pLine->split = false;
+        fields = cleanLine( pScan->text + start, eol - start, pLine->line, SCAN_LINE );
+        if( fields == 0 ) continue;
+        pLine->fields = fields;
+        return fields;
+    }
+}
+
+// Move the part line left in the buffer to the start, read as much more as will fit, and find its structural characters
+// The buffer is doubled if the part line already fills it
+int refillScan( ScanFile* pScan )
+{
+    char*     text  = NULL;
+    uint32_t* marks = NULL;
+    long      carry = pScan->length > pScan->pos ? pScan->length - pScan->pos : 0;
+    size_t    got   = 0;
+
+    memmove( pScan->text, pScan->text + pScan->pos, carry );
+    pScan->length = carry;
+    pScan->pos    = 0;
+    if( pScan->length == pScan->size )
+    {
+        text  = (char*)realloc( pScan->text, pScan->size * 2 );
+        if( text != NULL ) pScan->text = text;
+        marks = (uint32_t*)realloc( pScan->marks, sizeof(uint32_t) * pScan->size * 2 );
+        if( marks != NULL ) pScan->marks = marks;
+        if( text == NULL || marks == NULL )
+        {
+            fprintf( pScan->err, "Failed to grow buffers in refillScan\n" );
+            return -1;
+        }
+        pScan->size *= 2;
+    }
+
+    got = fread( pScan->text + pScan->length, 1, pScan->size - pScan->length, pScan->fp );
+    if( got == 0 ) pScan->eof = true;
+    pScan->length += got;
+    pScan->count   = pScan->scanner->scan( pScan->text, pScan->length, pScan->marks );
+    pScan->next    = 0;
+    return 0;
+}
+
+void closeScan( ScanFile* pScan )
+{
+    free( pScan->text );
+    free( pScan->marks );
+    pScan->text  = NULL;
+    pScan->marks = NULL;
+}
+
+// Find the end of the line starting at start, from the marks from *pNext on
+// Returns the offset of the \n ending the line (or end, if there isn't one), and leaves *pNext at the mark after it
+// Counts the fields, noting where each starts in pLine->text, and sets pLine->split if the line is plain
+// *pLen is the length of the line without any \r at its end, and *pCRs the number of them
+long findLineEnd( const char* text, long start, long end, const uint32_t* marks, long count, long* pNext,
+                  ScanLine* pLine, long* pLen, int* pCRs )
+{
+    long m     = 0;
+    long eol   = end;
+    long len   = 0;
+    int  other = 0;                                    // \r and \0 in the line
+    int  crs   = 0;
+
+    pLine->fields = 1;
+    for( m = *pNext; m < count; m++ )
+    {
+        if( text[marks[m]] == '\n' )
+        {
+            eol = marks[m++];
+            break;
+        }
+        if( text[marks[m]] == ',' )
+        {
+            if( marks[m] - start < SCAN_LINE - 1 )
+                pLine->field[pLine->fields] = pLine->text + ( marks[m] - start ) + 1;
+            pLine->fields += 1;
+        }
+        else
+        {
+            other += 1;
+        }
+    }
+    *pNext = m;
+
+    for( len = eol - start; len > 0 && text[start+len-1] == '\r'; len-- ) crs += 1;
+    pLine->split = ( other == crs && len < SCAN_LINE );
+    *pLen = len;
+    *pCRs = crs;
+    return eol;
+}
+
+// Copy a plain line, and its fields (found by findLineEnd), ready to be parsed
+void splitLine( ScanLine* pLine, const char* text, long len )
+{
+    int f = 0;
+
+    memcpy( pLine->line, text, len );
+    pLine->line[len] = '\0';
+    memcpy( pLine->text, pLine->line, len + 1 );
+    pLine->field[0] = pLine->text;
+    for( f = 1; f < pLine->fields; f++ )
+        pLine->field[f][-1] = '\0';
+}
+
+// Make the line getLine would have made from the text of a line (without its \n) - for lines that aren't plain
+// Each \r is dropped, along with whatever it is followed by being taken as it is (as sgetc does)
+// Returns the number of fields, or 0 for a line that getLine would have skipped as blank
+int cleanLine( const char* text, long len, char* line, int maxLen )
+{
+    long i      = 0;
+    int  fields = 0;
+    int  n      = 0;
+    char ch     = 0;
+
+    line[0] = '\0';
+    for( i = 0; i < len; i++ )
+    {
+        ch = text[i];
+        if( ch == '\r' )
+        {
+            if( ++i == len ) break;                    // The \r of the \r\n ending
+            ch = text[i];
+        }
+        if( fields == 0 ) fields = 1;
+        if( n < maxLen - 1 )
+        {
+            line[n]   = ch;
+            line[n+1] = '\0';
+        }
+        else
+        {
+            line[0] = '\0';
+        }
+        n += 1;
+        if( ch == ',' ) fields += 1;
+    }
+    return fields;
+}
+
+// Parse a line from the scanner - from its fields if it was split, otherwise just as a line from getLine
+int parseScanned( Repo* pRepo, Solution* pSoln, ScanLine* pLine )
+{
+    if( pLine->split )
+        return parseFields( pRepo, pSoln, pLine->field, pLine->fields );
+    return parseLine( pRepo, pSoln, pLine->line, pLine->fields );
+}
@@ -0,0 +1,73 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMSCAN_H
+#define MMSCAN_H
+
+#include "MMchk.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef SCAN_BUFFER
+#define SCAN_BUFFER            ( 1 << 20 )             // Bytes read from the file at a time (can be set when building)
+#endif
+#define SCAN_LINE              256                     // Longest line kept, as getLine (longer lines are still counted)
+
+// A way of finding the structural characters (, \n \r and \0) in a buffer of text
+typedef struct Scanner
+{
+    const char* name;
+    long        (*scan)( const char* text, long length, uint32_t* marks );  // Offsets of each, in order - returns how many
+    bool        (*usable)( void );                                          // Does this processor have the instructions?
+} Scanner;
+
+// A line as getLine would return it - and, when the line is plain, split into its fields
+// A plain line fits in SCAN_LINE and has no \r or \0 in it (other than the \r of a \r\n ending)
+typedef struct ScanLine
+{
+    char        line[SCAN_LINE];                       // The line, as getLine would return it
+    int         fields;
+    bool        split;                                 // Is field[] set? (false if the line was not plain)
+    char        text[SCAN_LINE];                       // The line with each comma replaced by \0
+    char*       field[SCAN_LINE];                      // Start of each field in text
+    int         number;                                // Line number in the file (from 1, counting any blank lines)
+} ScanLine;
+
+// A solution file read a buffer at a time, with the structural characters of each buffer found as it is read
+typedef struct ScanFile
+{
+    FILE*          fp;
+    FILE*          err;                                // Where problems are reported (the repository's)
+    const Scanner* scanner;
+    char*          text;                               // Buffer of text read from the file
+    long           size;                               // Bytes allocated (grown if a line doesn't fit)
+    long           length;                             // Bytes in the buffer
+    long           pos;                                // Start of the next line
+    uint32_t*      marks;                              // Offsets of the structural characters in the buffer
+    long           count;                              // Number of marks
+    long           next;                               // First mark at or after pos
+    bool           eof;                                // Nothing more to read
+    int            lines;                              // Lines read so far, blank ones included
+} ScanFile;
+
+const Scanner* findScanner( const char* name );
+int   openScan( ScanFile* pScan, Repo* pRepo );
+int   scanLine( ScanFile* pScan, ScanLine* pLine );
+int   refillScan( ScanFile* pScan );
+void  closeScan( ScanFile* pScan );
+long  findLineEnd( const char* text, long start, long end, const uint32_t* marks, long count, long* pNext,
+                   ScanLine* pLine, long* pLen, int* pCRs );
+void  splitLine( ScanLine* pLine, const char* text, long len );
+int   cleanLine( const char* text, long len, char* line, int maxLen );
+int   parseScanned( Repo* pRepo, Solution* pSoln, ScanLine* pLine );
+
+#endif  /* MMSCAN_H */
@@ -0,0 +1,652 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Sharded validation - each shard checks its own byte range of a solution file and writes a partial result
+// Merging the partial results gives the final report, including the checks that need the whole file:
+// completeness, codes repeated in different shards, and guesses that are inconsistent between shards
+//
+#include "MMshard.h"
+#include "MMchk.h"
+#include "MMparams.h"
+#include "MMutility.h"
+#include "MMsortfns.h"
+#include "MMkernels.h"
+#include "MMdiff.h"
+#include "MMformat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Check one shard of a solution file and write its partial result
+int shardCheck( Repo* pRepo )
+{
+    char  line[256];
+    long* offsets  = NULL;
+    long  start    = 0;
+    long  end      = 0;
+    int   colours  = 0;
+    int   fields   = 0;
+    int   count    = 0;
+    int   i        = 0;
+    int   g        = 0;
+    int   rc       = 0;
+
+    rc = parseHeader( pRepo );       if( rc ) return rc;    // Check header and find max number of guesses
+    rc = countPegs( pRepo );         if( rc ) return rc;    // Return the number of pegs in each code
+    rc = shardRange( pRepo, &start, &end ); if( rc ) return rc;
+
+    // First pass - count the lines, and find the highest colour if the filename did not give the number of colours
+    while( shardLine( pRepo, end, line, NULL ) != EOF )
+    {
+        count += 1;
+        for( g = 0; line[g] != ',' && line[g] != '\0'; g++ );
+        if( line[g] == ',' ) g++;
+        for( ; line[g] != ',' && line[g] != '\0'; g++ )
+            if( line[g] >= 'A' && line[g] - 'A' + 1 > colours ) colours = line[g] - 'A' + 1;
+    }
+    if( pRepo->colours == 0 ) pRepo->colours = colours;
+    pRepo->codes       = round( pow( pRepo->colours, pRepo->pegs ) );
+    pRepo->actualCodes = count;
+    selectKernel( pRepo );
+
+    // Second pass - read the lines in, noting where each starts so lines with problems can be written out
+    offsets = (long*)malloc( sizeof(long) * ( count + 1 ) );
+    if( offsets == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate array in shardCheck\n" );
+        return -1;
+    }
+    rc = newSolutions( pRepo, count );
+    if( rc == 0 ) rc = shardRange( pRepo, &start, &end );
+    for( i = 0; i < count && rc == 0; i++ )
+    {
+        fields = shardLine( pRepo, end, line, &offsets[i] );
+        pRepo->data[i].line = i;
+        if( fields == EOF || parseLine( pRepo, &pRepo->data[i], line, fields ) != 0 )
+        {
+            fprintf( pRepo->err, "More guesses than expected\n" );
+            rc = -1;
+        }
+    }
+
+    // The checks that can be made on the shard's own lines
+    if( rc == 0 ) rc = setupCodeDefs( pRepo );
+    if( rc == 0 ) rc = checkCounts( pRepo );
+    if( rc == 0 ) rc = checkCodes( pRepo );
+    for( i = 0; i < count && rc == 0; i++ )
+        for( g = 0; g < pRepo->data[i].actualNoTurns && g < pRepo->guesses; g++ )
+            pRepo->data[i].turns[g].markOK = ( pRepo->data[i].turns[g].mark == marking( pRepo, pRepo->data[i].code, pRepo->data[i].turns[g].guess ) );
+
+    if( rc == 0 ) rc = writePart( pRepo, offsets );
+
+    free( offsets );
+    return rc;
+}
+
+// Find the byte range of the file for this shard, and position the file at its first line
+// A line belongs to the shard its first character falls in
+int shardRange( Repo* pRepo, long* pStart, long* pEnd )
+{
+    char line[256];
+    long dataStart = 0;
+    long fileSize  = 0;
+    int  ch        = 0;
+
+    fseek( pRepo->fp, 0, SEEK_SET );
+    getLine( pRepo->fp, line, 256 );                          // Step over the header
+    dataStart = ftell( pRepo->fp );
+    fseek( pRepo->fp, 0, SEEK_END );
+    fileSize = ftell( pRepo->fp );
+    if( dataStart < 0 || fileSize < dataStart )
+    {
+        fprintf( pRepo->err, "Unable to find the size of %s\n", pRepo->baseName );
+        return -1;
+    }
+
+    *pStart = dataStart + (long)( (double)( fileSize - dataStart ) * ( pRepo->shard - 1 ) / pRepo->shards );
+    *pEnd   = dataStart + (long)( (double)( fileSize - dataStart ) * pRepo->shard / pRepo->shards );
+
+    // Unless the range starts a line, the line under way belongs to the previous shard
+    fseek( pRepo->fp, *pStart > dataStart ? *pStart - 1 : *pStart, SEEK_SET );
+    if( *pStart > dataStart && fgetc( pRepo->fp ) != '\n' )
+        while( ( ch = fgetc( pRepo->fp ) ) != '\n' && ch != EOF );
+
+    return 0;
+}
+
+// Read the next line of the shard, optionally noting where it starts
+// Returns EOF once the next line starts beyond the end of the shard
+int shardLine( Repo* pRepo, long end, char* line, long* pOffset )
+{
+    int ch = 0;
+
+    do ch = fgetc( pRepo->fp ); while( ch == '\n' || ch == '\r' );
+    if( ch == EOF ) return EOF;
+    ungetc( ch, pRepo->fp );
+
+    if( ftell( pRepo->fp ) >= end ) return EOF;
+    if( pOffset != NULL ) *pOffset = ftell( pRepo->fp );
+
+    return getLine( pRepo->fp, line, 256 );
+}
+
+// Write the partial result for this shard - alongside the solution file, eg SolnMM(4,6)_x_SHARD2of8.part
+// Consistency of guesses can only be judged against the first line in the whole file to reach each point,
+// so rather than a strategy tree the shard records every distinct guess made at each point, with the first line making it
+int writePart( Repo* pRepo, long* offsets )
+{
+    PartHeader header;
+    PartError  error;
+    PartNode*  nodes   = NULL;
+    FILE*      fpo     = NULL;
+    int        words   = bitmapWords( pRepo->codes );
+    int        count   = 0;
+    int        len     = 0;
+    int        i       = 0;
+    int        j       = 0;
+
+    memset( &header, 0, sizeof(header) );
+    memcpy( header.magic, PART_MAGIC, 8 );
+    header.version   = PART_VERSION;
+    header.shard     = pRepo->shard;
+    header.shards    = pRepo->shards;
+    header.pegs      = pRepo->pegs;
+    header.colours   = pRepo->colours;
+    header.codes     = pRepo->codes;
+    header.guesses   = pRepo->guesses;
+    header.lines     = pRepo->actualCodes;
+    header.pegsOK    = pRepo->pegsOK;
+    header.coloursOK = pRepo->coloursOK;
+    snprintf( header.baseName, 256, "%s", pRepo->baseName );
+    for( i = 0; i < pRepo->actualCodes; i++ )
+    {
+        header.TTTS += pRepo->data[i].noTurns;
+        if( solutionFault( pRepo, &pRepo->data[i] ) ) header.errors += 1;
+    }
+
+    if( shardNodes( pRepo, &nodes, &count ) != 0 ) return -1;
+    header.nodes = count;
+
+    snprintf( pRepo->outputName, 256, "%s", pRepo->filename );
+    len = strlen( pRepo->outputName );
+    if( len >= 4 && strcmp( pRepo->outputName + len - 4, ".csv" ) == 0 ) len -= 4;
+    snprintf( pRepo->outputName + len, 256 - len, "_SHARD%dof%d.part", pRepo->shard, pRepo->shards );
+
+    fpo = fopen( pRepo->outputName, "wb" );
+    if( fpo == NULL )
+    {
+        fprintf( pRepo->err, "Unable to open file: %s\n", pRepo->outputName );
+        free( nodes );
+        return -1;
+    }
+
+    fwrite( &header, sizeof(header), 1, fpo );
+    fwrite( pRepo->seen, sizeof(uint64_t), words, fpo );
+    fwrite( pRepo->repeat, sizeof(uint64_t), words, fpo );
+    fwrite( nodes, sizeof(PartNode), count, fpo );
+
+    for( i = 0; i < pRepo->actualCodes; i++ )
+    {
+        if( ! solutionFault( pRepo, &pRepo->data[i] ) ) continue;
+        memset( &error, 0, sizeof(error) );
+        error.line  = i;
+        error.flags = lineFlags( &pRepo->data[i] );
+        for( j = 0; j < pRepo->data[i].actualNoTurns && j < 64; j++ )
+        {
+            if( ! pRepo->data[i].turns[j].guessOK ) error.guessProb |= 1ULL << j;
+            if( ! pRepo->data[i].turns[j].markOK )  error.markProb  |= 1ULL << j;
+        }
+        fseek( pRepo->fp, offsets[i], SEEK_SET );
+        getLine( pRepo->fp, error.text, 256 );
+        fwrite( &error, sizeof(error), 1, fpo );
+    }
+
+    free( nodes );
+    if( fclose( fpo ) != 0 || ferror( pRepo->fp ) )
+    {
+        fprintf( pRepo->err, "Unable to write file: %s\n", pRepo->outputName );
+        return -1;
+    }
+
+    say( pRepo, "\nShard %d of %d of %s:   %d lines checked, %u with errors - partial result in %s\n\n",
+         pRepo->shard, pRepo->shards, pRepo->baseName, pRepo->actualCodes, header.errors, pRepo->outputName );
+    return 0;
+}
+
+// Find every distinct guess made at each point of the strategy, with the first line making it
+// A point is known by a hash of the guesses and marks leading to it, so points match up between shards
+// Lines are walked as buildTree walks them, and the result is in PartNode order (see cmpPrefixOrder)
+int shardNodes( Repo* pRepo, PartNode** pNodes, int* pCount )
+{
+    PartNode* nodes    = NULL;
+    Solution* pSoln    = NULL;
+    uint64_t  prefix   = 0;
+    int       allBlack = ( pRepo->pegs * ( pRepo->pegs + 3 ) ) / 2 - 1;
+    int       total    = 0;
+    int       count    = 0;
+    int       mark     = 0;
+    int       i        = 0;
+    int       g        = 0;
+
+    for( i = 0; i < pRepo->actualCodes; i++ )
+        total += pRepo->data[i].actualNoTurns < pRepo->guesses ? pRepo->data[i].actualNoTurns : pRepo->guesses;
+
+    nodes = (PartNode*)malloc( sizeof(PartNode) * ( total + 1 ) );
+    if( nodes == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate array in shardNodes\n" );
+        return -1;
+    }
+
+    for( i = 0; i < pRepo->actualCodes; i++ )
+    {
+        pSoln  = &pRepo->data[i];
+        prefix = mixHash( 0, 0 );
+        for( g = 0; g < pSoln->actualNoTurns && g < pRepo->guesses; g++ )
+        {
+            memset( &nodes[count], 0, sizeof(PartNode) );
+            nodes[count].prefix = prefix;
+            nodes[count].guess  = pSoln->turns[g].guess;
+            nodes[count].line   = pSoln->line;
+            count += 1;
+
+            mark = pSoln->turns[g].mark;
+            if( mark < 0 || mark >= allBlack ) break;        // Resolved (or a bad mark)
+            prefix = mixHash( mixHash( prefix, pSoln->turns[g].guess + 1 ), mark );
+        }
+    }
+
+    // Keep only the first line making each guess at each point
+    qsort( nodes, count, sizeof(PartNode), cmpPrefixOrder );
+    for( total = count, count = 0, i = 0; i < total; i++ )
+        if( count == 0 || nodes[i].prefix != nodes[count-1].prefix || nodes[i].guess != nodes[count-1].guess )
+            nodes[count++] = nodes[i];
+
+    *pNodes = nodes;
+    *pCount = count;
+    return 0;
+}
+
+// Merge the partial results of every shard into the final report
+int mergeShards( Repo* pRepo )
+{
+    Part       part;
+    Part*      parts      = NULL;
+    PartNode*  nodes      = NULL;
+    PartError* errors     = NULL;
+    uint64_t*  across     = NULL;
+    long*      base       = NULL;
+    long       TTTS       = 0;
+    int        shards     = 0;
+    int        nodeCount  = 0;
+    int        errorCount = 0;
+    int        words      = 0;
+    int        first      = 0;
+    int        s          = 0;
+    int        i          = 0;
+    int        j          = 0;
+    int        k          = 0;
+    int        w          = 0;
+    int        rc         = 0;
+
+    // Read in every part, making sure they are all from the same run and that none are missing
+    rc = readPart( pRepo, pRepo->mergeNames[0], &part ); if( rc ) return rc;
+    shards = part.header.shards;
+    freePart( &part );
+
+    parts = (Part*)calloc( shards, sizeof(Part) );
+    base  = (long*)calloc( shards + 1, sizeof(long) );
+    if( parts == NULL || base == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate arrays in mergeShards\n" );
+        free( parts );
+        free( base );
+        return -1;
+    }
+    for( i = 0; i < pRepo->mergeCount && rc == 0; i++ )
+    {
+        rc = readPart( pRepo, pRepo->mergeNames[i], &part );
+        if( rc ) break;
+        s = part.header.shard - 1;
+        if( (int)part.header.shards != shards || s < 0 || s >= shards || parts[s].seen != NULL )
+        {
+            fprintf( pRepo->err, "Partial result %s does not belong with the others\n", pRepo->mergeNames[i] );
+            freePart( &part );
+            rc = -1;
+            break;
+        }
+        parts[s] = part;
+    }
+    for( s = 0; s < shards && rc == 0; s++ )
+    {
+        if( parts[s].seen == NULL )
+        {
+            fprintf( pRepo->err, "Partial result for shard %d of %d is missing\n", s + 1, shards );
+            rc = -1;
+        }
+        else if( parts[s].header.pegs != parts[0].header.pegs || parts[s].header.codes != parts[0].header.codes
+                 || parts[s].header.guesses != parts[0].header.guesses || strcmp( parts[s].header.baseName, parts[0].header.baseName ) != 0 )
+        {
+            fprintf( pRepo->err, "Partial result for shard %d of %d is for a different solution (or puzzle)\n", s + 1, shards );
+            rc = -1;
+        }
+    }
+
+    // The puzzle, as the shards saw it
+    if( rc == 0 )
+    {
+        snprintf( pRepo->baseName, 256, "%s", parts[0].header.baseName );
+        pRepo->pegs    = parts[0].header.pegs;
+        pRepo->colours = parts[0].header.colours;
+        pRepo->codes   = parts[0].header.codes;
+        pRepo->guesses = parts[0].header.guesses;
+        for( s = 0; s < shards; s++ )
+        {
+            pRepo->pegsOK       = pRepo->pegsOK && parts[s].header.pegsOK;
+            pRepo->coloursOK    = pRepo->coloursOK && parts[s].header.coloursOK;
+            pRepo->actualCodes += parts[s].header.lines;
+            base[s+1]           = base[s] + parts[s].header.lines;
+            TTTS               += parts[s].header.TTTS;
+            nodeCount          += parts[s].header.nodes;
+            errorCount         += parts[s].header.errors;
+        }
+        pRepo->codesOK = ( pRepo->codes == pRepo->actualCodes );
+        selectKernel( pRepo );
+        rc = setupCodeDefs( pRepo );
+    }
+
+    // Codes seen - and any seen by more than one shard
+    if( rc == 0 ) rc = newCodeMaps( pRepo );
+    if( rc == 0 )
+    {
+        words  = bitmapWords( pRepo->codes );
+        across = (uint64_t*)calloc( words, sizeof(uint64_t) );
+        nodes  = (PartNode*)malloc( sizeof(PartNode) * ( nodeCount + 1 ) );
+        errors = (PartError*)malloc( sizeof(PartError) * ( errorCount + nodeCount + 1 ) );
+        if( across == NULL || nodes == NULL || errors == NULL )
+        {
+            fprintf( pRepo->err, "Failed to allocate arrays in mergeShards\n" );
+            rc = -1;
+        }
+    }
+    if( rc == 0 )
+    {
+        for( s = 0; s < shards; s++ )
+        {
+            for( w = 0; w < words; w++ )
+            {
+                across[w]        |= pRepo->seen[w] & parts[s].seen[w];
+                pRepo->seen[w]   |= parts[s].seen[w];
+                pRepo->repeat[w] |= parts[s].repeat[w];
+            }
+        }
+        across[words-1] &= pRepo->codes % 64 != 0 ? ( 1ULL << ( pRepo->codes % 64 ) ) - 1 : ~0ULL;   // Every shard has the bits past the last code
+        pRepo->missingCodes = countMissing( pRepo );
+
+        // Every point in the strategy must have the same guess in every shard - the earliest line in the file sets it
+        // Each other guess made there is flagged at the first line making it
+        for( nodeCount = 0, s = 0; s < shards; s++ )
+        {
+            for( i = 0; i < (int)parts[s].header.nodes; i++ )
+            {
+                nodes[nodeCount]        = parts[s].nodes[i];
+                nodes[nodeCount].shard  = s;
+                nodes[nodeCount].line  += base[s];
+                nodeCount += 1;
+            }
+        }
+        qsort( nodes, nodeCount, sizeof(PartNode), cmpPrefixOrder );
+
+        for( errorCount = 0, s = 0; s < shards; s++ )
+        {
+            for( i = 0; i < (int)parts[s].header.errors; i++ )
+            {
+                errors[errorCount]       = parts[s].errors[i];
+                errors[errorCount].line += base[s];
+                errorCount += 1;
+            }
+        }
+        for( i = 0; i < nodeCount; i = j )
+        {
+            first = i;
+            for( j = i; j < nodeCount && nodes[j].prefix == nodes[i].prefix; j++ )
+                if( nodes[j].line < nodes[first].line ) first = j;
+            for( k = i; k < j; k++ )
+            {
+                if( nodes[k].guess == nodes[first].guess ) continue;
+                memset( &errors[errorCount], 0, sizeof(PartError) );
+                errors[errorCount].line  = nodes[k].line;
+                errors[errorCount].flags = PART_CONSISTENT;
+                errorCount += 1;
+            }
+        }
+
+        // Put the errors in line order, combining any found twice for the same line
+        qsort( errors, errorCount, sizeof(PartError), cmpPartErrorOrder );
+        for( i = 0, j = 0; i < errorCount; i++ )
+        {
+            if( j > 0 && errors[i].line == errors[j-1].line )
+            {
+                errors[j-1].flags |= errors[i].flags;
+                if( errors[j-1].text[0] == '\0' ) memcpy( errors[j-1].text, errors[i].text, 256 );
+            }
+            else
+            {
+                errors[j++] = errors[i];
+            }
+        }
+        errorCount = j;
+
+        rc = mergeReport( pRepo, errors, errorCount, across, TTTS );
+    }
+
+    for( s = 0; s < shards; s++ ) freePart( &parts[s] );
+    free( parts );
+    free( base );
+    free( nodes );
+    free( errors );
+    free( across );
+    return rc;
+}
+
+// Read a partial result back in
+int readPart( Repo* pRepo, char* name, Part* pPart )
+{
+    FILE*  fp    = NULL;
+    size_t words = 0;
+    bool   ok    = false;
+
+    memset( pPart, 0, sizeof(Part) );
+    fp = fopen( name, "rb" );
+    if( fp == NULL )
+    {
+        fprintf( pRepo->err, "Unable to open partial result %s\n", name );
+        return -1;
+    }
+
+    if( fread( &pPart->header, sizeof(PartHeader), 1, fp ) == 1
+        && memcmp( pPart->header.magic, PART_MAGIC, 8 ) == 0 && pPart->header.version == PART_VERSION
+        && pPart->header.shards > 0 && pPart->header.codes > 0 )
+    {
+        words          = bitmapWords( pPart->header.codes );
+        pPart->seen    = (uint64_t*)malloc( sizeof(uint64_t) * words );
+        pPart->repeat  = (uint64_t*)malloc( sizeof(uint64_t) * words );
+        pPart->nodes   = (PartNode*)malloc( sizeof(PartNode) * ( pPart->header.nodes + 1 ) );
+        pPart->errors  = (PartError*)malloc( sizeof(PartError) * ( pPart->header.errors + 1 ) );
+        ok = pPart->seen != NULL && pPart->repeat != NULL && pPart->nodes != NULL && pPart->errors != NULL
+             && fread( pPart->seen, sizeof(uint64_t), words, fp ) == words
+             && fread( pPart->repeat, sizeof(uint64_t), words, fp ) == words
+             && fread( pPart->nodes, sizeof(PartNode), pPart->header.nodes, fp ) == pPart->header.nodes
+             && fread( pPart->errors, sizeof(PartError), pPart->header.errors, fp ) == pPart->header.errors;
+    }
+    fclose( fp );
+
+    if( ! ok )
+    {
+        fprintf( pRepo->err, "%s is not a partial result from this version\n", name );
+        freePart( pPart );
+        return -1;
+    }
+    return 0;
+}
+
+// Release the memory held by a partial result
+void freePart( Part* pPart )
+{
+    free( pPart->seen );
+    free( pPart->repeat );
+    free( pPart->nodes );
+    free( pPart->errors );
+    pPart->seen   = NULL;
+    pPart->repeat = NULL;
+    pPart->nodes  = NULL;
+    pPart->errors = NULL;
+}
+
+// Report on the merged results, in the same way as an unsharded run
+// Lines with problems are written to an _ERRORS.csv file alongside the first partial result
+int mergeReport( Repo* pRepo, PartError* errors, int errorCount, uint64_t* across, long TTTS )
+{
+    char     issues[256];
+    OutBuf   out;
+    FILE*    fpo        = NULL;
+    bool     repeated   = false;
+    bool     fileError  = false;
+    int      len        = 0;
+    int      w          = 0;
+    int      i          = 0;
+    int      j          = 0;
+
+    for( w = 0; w < bitmapWords( pRepo->codes ); w++ )
+        if( across[w] != 0 ) repeated = true;
+
+    say( pRepo, "\nAnalysis of %s:   ", pRepo->baseName );
+
+    fileError = ! pRepo->pegsOK || ! pRepo->coloursOK || ! pRepo->codesOK || pRepo->missingCodes > 0 || repeated;
+    if( ! fileError && errorCount == 0 )
+    {
+        say( pRepo, "No errors found.  TTTS = %ld\n\n", TTTS );
+        return 0;
+    }
+
+    if( fileError )
+    {
+        say( pRepo, "\n" );
+        if( ! pRepo->pegsOK || ! pRepo->coloursOK )
+            say( pRepo, "Inconsistent numbers of Pegs/Colours between filename and solution (Ignoring filename)\n" );
+
+        if( ! pRepo->codesOK )
+        {
+            say( pRepo, "Unexpected number of codes shown in solution\n" );
+            say( pRepo, "Expecting %d codes, actually output %d codes\n", pRepo->codes, pRepo->actualCodes );
+        }
+
+        if( pRepo->missingCodes > 0 )
+        {
+            say( pRepo, "The following code(s) were not shown in the solution file\n" );
+            listCodes( pRepo, pRepo->seen, true );
+        }
+
+        if( repeated )
+        {
+            say( pRepo, "The following code(s) were shown in more than one shard\n" );
+            listCodes( pRepo, across, false );
+        }
+    }
+
+    if( errorCount > 0 && ! pRepo->errorsFile )
+    {
+        say( pRepo, "solution level errors\n" );
+    }
+    else if( errorCount > 0 )
+    {
+        // Output file goes alongside the first partial result, named after the solution
+        snprintf( pRepo->outputName, 256, "%s", pRepo->mergeNames[0] );
+        for( len = strlen( pRepo->outputName ); len > 0 && pRepo->outputName[len-1] != '/'; len-- );
+        snprintf( pRepo->outputName + len, 256 - len, "%s", pRepo->baseName );
+        len = strlen( pRepo->outputName );
+        if( len >= 4 && strcmp( pRepo->outputName + len - 4, ".csv" ) == 0 ) len -= 4;
+        snprintf( pRepo->outputName + len, 256 - len, "_ERRORS.csv" );
+
+        fpo = fopen( pRepo->outputName, "w" );
+        if( fpo == NULL )
+        {
+            fprintf( pRepo->err, "Unable to open file: %s\n", pRepo->outputName );
+            fprintf( pRepo->err, "Solution errors - but unable to output details\n" );
+            return -1;
+        }
+        say( pRepo, "solution level errors - details in %s\n", pRepo->outputName );
+        if( openOut( &out, pRepo, fpo ) )
+        {
+            fclose( fpo );
+            return -1;
+        }
+
+        // Only the lines with problems are known, so each is given with its line number in the solution file
+        putString( &out, "Line,Issues,Solution\n" );
+        for( i = 0; i < errorCount; i++ )
+        {
+            partIssues( errors[i].flags, issues );
+            putNumber( &out, errors[i].line + 2 );
+            putChar( &out, ',' );
+            putString( &out, issues );
+            putChar( &out, ',' );
+            putString( &out, errors[i].text );
+            putChar( &out, '\n' );
+            if( errors[i].guessProb != 0 || errors[i].markProb != 0 )
+            {
+                putText( &out, ",,,,,", 5 );  // Step over initial fields
+                for( j = 0; j < 64 && ( ( errors[i].guessProb | errors[i].markProb ) >> j ) != 0; j++ )
+                {
+                    if( errors[i].guessProb >> j & 1 ) putText( &out, "Prob,", 5 ); else putChar( &out, ',' );
+                    if( errors[i].markProb >> j & 1 )  putText( &out, "Prob,", 5 ); else putChar( &out, ',' );
+                }
+                putChar( &out, '\n' );
+            }
+        }
+        if( closeOut( &out ) ) fprintf( pRepo->err, "Unable to write all of %s\n", pRepo->outputName );
+        fclose( fpo );
+    }
+    say( pRepo, "\n" );
+
+    return 0;
+}
+
+// Pack the problems found on a line into PART_... flags
+uint32_t lineFlags( Solution* pSoln )
+{
+    uint32_t flags = 0;
+
+    if( ! pSoln->codeOK )           flags |= PART_CODE;
+    if( pSoln->codeRepeated )       flags |= PART_REPEATED;
+    if( ! pSoln->turnsOK )          flags |= PART_TURNS;
+    if( ! pSoln->resolved )         flags |= PART_RESOLVED;
+    if( ! pSoln->marksOK )          flags |= PART_MARKS;
+    if( ! pSoln->guessesOK )        flags |= PART_GUESSES;
+    if( ! pSoln->guessConsistant )  flags |= PART_CONSISTENT;
+
+    return flags;
+}
+
+// Describe the problems on a line, as in the _ERRORS.csv file of an unsharded run
+void partIssues( uint32_t flags, char* buffer )
+{
+    buffer[0] = '\0';
+    if( flags & PART_CODE )         strcat( buffer, "Code and Rep don't match " );
+    if( flags & PART_REPEATED )     strcat( buffer, "Repeated " );
+    if( flags & PART_TURNS )        strcat( buffer, "Turns incorrect " );
+    if( flags & PART_RESOLVED )     strcat( buffer, "Not resolved " );
+    if( flags & PART_MARKS )        strcat( buffer, "Mark(s) wrong " );
+    if( flags & PART_GUESSES )      strcat( buffer, "Guess/mark issue " );
+    if( flags & PART_CONSISTENT )   strcat( buffer, "Inconsistent guesses " );
+}
@@ -0,0 +1,92 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMSHARD_H
+#define MMSHARD_H
+
+#include "MMchk.h"
+
+#include <stdint.h>
+
+#define PART_MAGIC             "MMchkPRT"
+#define PART_VERSION           2                       // Change whenever the layout of a partial result changes
+
+// Problems found on a line - the flags of a Solution, packed so that 0 means all is well
+#define PART_CODE              0x01                    // Code and Rep don't match
+#define PART_REPEATED          0x02                    // Repeated
+#define PART_TURNS             0x04                    // Turns incorrect
+#define PART_RESOLVED          0x08                    // Not resolved
+#define PART_MARKS             0x10                    // Mark(s) wrong
+#define PART_GUESSES           0x20                    // Guess/mark issue
+#define PART_CONSISTENT        0x40                    // Inconsistent guesses
+
+// Start of a partial result file - followed by the seen and repeat bitmaps, then the nodes, then the errors
+typedef struct PartHeader
+{
+    char     magic[8];                                 // PART_MAGIC
+    uint32_t version;                                  // PART_VERSION
+    uint32_t shard;                                    // This shard (1 to shards)
+    uint32_t shards;
+    uint32_t pegs;
+    uint32_t colours;
+    uint32_t codes;
+    uint32_t guesses;
+    uint32_t lines;                                    // Lines checked by this shard
+    uint32_t nodes;                                    // Distinct guesses made at each point of the strategy
+    uint32_t errors;                                   // Lines with problems
+    uint32_t pegsOK;
+    uint32_t coloursOK;
+    int64_t  TTTS;                                     // Total turns to solve, over this shard's lines
+    char     baseName[256];                            // Solution file the shard was taken from
+} PartHeader;
+
+// A guess made at a point in the strategy - the point is a hash of the guesses and marks leading to it
+typedef struct PartNode
+{
+    uint64_t prefix;
+    int32_t  guess;
+    int32_t  line;                                     // First line making the guess there (in the shard, later in the whole file)
+    int32_t  shard;                                    // Only used when merging
+    int32_t  spare;
+} PartNode;
+
+// A line with problems
+typedef struct PartError
+{
+    int32_t  line;                                     // Line in the shard (later in the whole file)
+    uint32_t flags;                                    // PART_... flags
+    uint64_t guessProb;                                // Turns with a guess problem (bit per turn)
+    uint64_t markProb;                                 // Turns with a mark problem (bit per turn)
+    char     text[256];                                // The line itself (empty if not known)
+} PartError;
+
+// A partial result, read back in for merging
+typedef struct Part
+{
+    PartHeader header;
+    uint64_t*  seen;
+    uint64_t*  repeat;
+    PartNode*  nodes;
+    PartError* errors;
+} Part;
+
+int      shardCheck( Repo* pRepo );
+int      shardRange( Repo* pRepo, long* pStart, long* pEnd );
+int      shardLine( Repo* pRepo, long end, char* line, long* pOffset );
+int      writePart( Repo* pRepo, long* offsets );
+int      shardNodes( Repo* pRepo, PartNode** pNodes, int* pCount );
+int      mergeShards( Repo* pRepo );
+int      readPart( Repo* pRepo, char* name, Part* pPart );
+void     freePart( Part* pPart );
+int      mergeReport( Repo* pRepo, PartError* errors, int errorCount, uint64_t* across, long TTTS );
+uint32_t lineFlags( Solution* pSoln );
+void     partIssues( uint32_t flags, char* buffer );
+
+#endif  /* MMSHARD_H */
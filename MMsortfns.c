@@ -9,42 +9,122 @@
 //  I would be very interested to hear your feedback about this program and results you have obtained from it
 /******************************************************************************************************************/
 //
-// Comparison functions used by various qsort requests
+// Comparison functions used by various qsort requests, and radix sorts producing index arrays
 //
 #include "MMsortfns.h"
 #include "MMchk.h"
+#include "MMshard.h"
+#include "MMspill.h"
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-// Used by qsort to order into ascending order by code
-int cmpCodeOrder(const void* a, const void* b)
+// Used by qsort to order file offsets
+int cmpOffsetOrder(const void* a, const void* b)
 {
-   return ((Solution*)a)->code - ((Solution*)b)->code;
+   if( *(long*)a > *(long*)b ) return  1;
+   if( *(long*)a < *(long*)b ) return -1;
+   return 0;
 }
 
-// Used by qsort to order into the original order
-int cmpLineOrder(const void* a, const void* b)
+// Sort partial result nodes by their prefix, then guess, earliest line first
+int cmpPrefixOrder(const void* a, const void* b)
 {
-   return ((Solution*)a)->line - ((Solution*)b)->line;
+   const PartNode* pA = (const PartNode*)a;
+   const PartNode* pB = (const PartNode*)b;
+
+   if( pA->prefix > pB->prefix ) return  1;
+   if( pA->prefix < pB->prefix ) return -1;
+   if( pA->guess > pB->guess )   return  1;
+   if( pA->guess < pB->guess )   return -1;
+   if( pA->line > pB->line )     return  1;
+   if( pA->line < pB->line )     return -1;
+   return 0;
 }
 
-// Used by qsort to order into ascending order by marks at each level
-int cmpMarkOrder(const void* a, const void* b)
+// Sort partial result errors into line order
+int cmpPartErrorOrder(const void* a, const void* b)
 {
-   return cmpMarkLevel( ((Solution*)a)->turns, ((Solution*)b)->turns );
+   if( ((const PartError*)a)->line > ((const PartError*)b)->line ) return  1;
+   if( ((const PartError*)a)->line < ((const PartError*)b)->line ) return -1;
+   return 0;
 }
 
-// Used by qsort to order into ascending order by marks at each level
-int cmpMarkLevel( Turn* a, Turn* b )
+// Sort spilled records by their marks at each level, then line - the order sortByMarks gives
+// (Marks are -1 or a valid mark, so the order of the marks themselves is the order of their buckets there)
+int cmpSpillOrder(const void* a, const void* b)
 {
-   if( a->mark > b->mark ) return  1;
-   if( a->mark < b->mark ) return -1;
-   return cmpMarkLevel( ++a, ++b );
+   const SpillRecord* pA = (const SpillRecord*)a;
+   const SpillRecord* pB = (const SpillRecord*)b;
+   int                g  = 0;
+
+   for( g = 0; g < SPILL_MAX_GUESSES; g++ )
+   {
+      if( pA->mark[g] > pB->mark[g] ) return  1;
+      if( pA->mark[g] < pB->mark[g] ) return -1;
+   }
+   if( pA->line > pB->line ) return  1;
+   if( pA->line < pB->line ) return -1;
+   return 0;
 }
 
-int cmpAbsentOrder(const void* a, const void* b)
+// Order the solutions by their marks at each level, without moving the solutions themselves
+// order[] is filled with solution indexes, so solutions sharing the same marks up to any level are together
+// Marks are small dense integers, so this is a radix sort - a stable counting sort on each level, last level first
+int sortByMarks( Repo* pRepo, int* order )
 {
-   if(   ((Absent*)a)->codeMissing && ! ((Absent*)b)->codeMissing ) return -1;
-   if( ! ((Absent*)a)->codeMissing &&   ((Absent*)b)->codeMissing ) return  1;
-   return ((Absent*)a)->code - ((Absent*)b)->code;
-}
\ No newline at end of file
+    int  buckets = ( pRepo->pegs * ( pRepo->pegs + 3 ) ) / 2 + 1;     // Every mark, plus one for no mark
+    int* count   = NULL;
+    int* spare   = NULL;
+    int* from    = NULL;
+    int* to      = NULL;
+    int* swap    = NULL;
+    int  level   = 0;
+    int  key     = 0;
+    int  total   = 0;
+    int  i       = 0;
+
+    count = (int*)malloc( sizeof(int) * buckets );
+    spare = (int*)malloc( sizeof(int) * ( pRepo->actualCodes + 1 ) );
+    if( count == NULL || spare == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate arrays in sortByMarks\n" );
+        free( count );
+        free( spare );
+        return -1;
+    }
+
+    for( i = 0; i < pRepo->actualCodes; i++ ) order[i] = i;
+
+    from = order;
+    to   = spare;
+    for( level = pRepo->guesses - 1; level >= 0; level-- )
+    {
+        memset( count, 0, sizeof(int) * buckets );
+        for( i = 0; i < pRepo->actualCodes; i++ )
+            count[markKey( pRepo->data[from[i]].turns[level].mark, buckets )] += 1;
+
+        for( key = 0, total = 0; key < buckets; key++ )
+        {
+            total      += count[key];
+            count[key]  = total - count[key];
+        }
+
+        for( i = 0; i < pRepo->actualCodes; i++ )
+            to[count[markKey( pRepo->data[from[i]].turns[level].mark, buckets )]++] = from[i];
+
+        swap = from; from = to; to = swap;
+    }
+    if( from != order ) memcpy( order, from, sizeof(int) * pRepo->actualCodes );
+
+    free( count );
+    free( spare );
+    return 0;
+}
+
+// Bucket for a mark in sortByMarks - no mark (or one that could not be read) goes first
+int markKey( int mark, int buckets )
+{
+    return ( mark >= 0 && mark < buckets - 1 ) ? mark + 1 : 0;
+}
@@ -13,10 +13,11 @@
 
 #include "MMchk.h"
 
-int cmpCodeOrder(const void* a, const void* b);
-int cmpLineOrder(const void* a, const void* b);
-int cmpMarkOrder(const void* a, const void* b);
-int cmpMarkLevel( Turn* a, Turn* b );
-int cmpAbsentOrder(const void* a, const void* b);
+int cmpOffsetOrder(const void* a, const void* b);
+int cmpPrefixOrder(const void* a, const void* b);
+int cmpPartErrorOrder(const void* a, const void* b);
+int cmpSpillOrder(const void* a, const void* b);
+int sortByMarks( Repo* pRepo, int* order );
+int markKey( int mark, int buckets );
 
 #endif  /* MMSORTFNS_H */
\ No newline at end of file
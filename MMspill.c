@@ -0,0 +1,526 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Out-of-core validation (--out-of-core) - for solution files too large to hold in memory
+// The lines are read a chunk at a time, within the --max-memory budget, and each line is checked on its own as it is read
+// The path each line takes through the strategy is packed into a record, and each chunk's records are sorted and
+// spilled to a scratch file as a run.  Merging the runs gives every line in mark order, the same order checkGuesses
+// uses, so the consistency of the guesses can be checked with one sequential pass
+// Repeated codes only need the bitmaps of codes seen, which are small, so are found as the lines are read
+//
+#include "MMspill.h"
+#include "MMchk.h"
+#include "MMparams.h"
+#include "MMutility.h"
+#include "MMsortfns.h"
+#include "MMprogress.h"
+#include "MMformat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Check a solution file without holding it in memory
+// The report is the same as the one made by checking the file in memory (with the default checks)
+int spillCheck( Repo* pRepo )
+{
+    Spill  spill;
+    bool   fault = false;
+    int    TTTS  = 0;
+    int    rc    = 0;
+
+    memset( &spill, 0, sizeof(Spill) );
+    spill.pRepo = pRepo;
+    spill.dir   = pRepo->scratchDir;
+    if( spill.dir == NULL ) spill.dir = getenv( "TMPDIR" );
+    if( spill.dir == NULL ) spill.dir = "/tmp";
+
+    rc = parseHeader( pRepo );                  // Check header and find max number of guesses
+    if( rc == 0 ) rc = countPegs( pRepo );      // Return the number of pegs in each code
+    if( rc == 0 ) rc = countCodes( pRepo );     // Count the lines - nothing is kept
+    if( rc == 0 ) rc = setupCodeDefs( pRepo );  // Marks are scored as needed, so there is no mark table
+    if( rc == 0 ) rc = newCodeMaps( pRepo );
+    if( rc == 0 ) rc = spillBudget( &spill );
+
+    if( rc == 0 ) progressPhase( pRepo, "spillRuns" );
+    if( rc == 0 ) rc = spillRuns( &spill, &fault, &TTTS );
+    if( rc == 0 ) progressPhase( pRepo, "mergeRuns" );
+    if( rc == 0 ) rc = mergeAll( &spill );
+    if( rc == 0 )
+    {
+        progressPhase( pRepo, "spillReport" );
+        pRepo->missingCodes = countMissing( pRepo );
+        rc = spillReport( &spill, fault, TTTS );
+    }
+
+    freeSpill( &spill );
+    return rc;
+}
+
+// Share out the memory budget - the bitmaps are needed throughout, and the runs open while merging have buffers of
+// their own.  What is left holds the lines read into each run
+int spillBudget( Spill* pSpill )
+{
+    Repo*     pRepo   = pSpill->pRepo;
+    long long budget  = pRepo->maxMemory > 0 ? pRepo->maxMemory : defaultMemory();
+    long long perLine = sizeof(Solution) + sizeof(Turn) * pRepo->guesses + sizeof(SpillRecord);
+    long long perRun  = SPILL_BUFFER + sizeof(SpillRun) + sizeof(SpillRun*);
+    long long fixed   = 0;
+    long long merging = 0;
+    long long chunk   = 0;
+    long long runs    = 0;
+    long long size    = 0;
+    int       levels  = 1;
+    int       need    = 0;
+    int       pass    = 0;
+
+    if( pRepo->guesses > SPILL_MAX_GUESSES )
+    {
+        fprintf( pRepo->err, "Too many guesses for --out-of-core (at most %d)\n", SPILL_MAX_GUESSES );
+        return -1;
+    }
+
+    fixed = sizeof(uint64_t) * ( 2LL * bitmapWords( pRepo->codes ) + bitmapWords( pRepo->actualCodes ) );
+
+    // Up to a quarter of the budget goes on the buffers of the runs merged at once
+    pSpill->fanIn = (int)( budget / ( 4LL * SPILL_BUFFER ) );
+    if( pSpill->fanIn < 2 )              pSpill->fanIn = 2;
+    if( pSpill->fanIn > SPILL_MAX_RUNS ) pSpill->fanIn = SPILL_MAX_RUNS;
+
+    // writeRun merges while the chunk is held, and up to fanIn - 1 runs wait at each level (with the one being written
+    // and the one being merged into) - a smaller chunk makes more runs, which can need another level, so the buffers
+    // for the levels and the chunk are settled together
+    for( pass = 0; pass < 8; pass++ )
+    {
+        merging = ( (long long)( pSpill->fanIn - 1 ) * levels + 2 ) * perRun;
+        chunk   = budget > fixed + merging ? ( budget - fixed - merging ) / perLine : 0;
+        if( chunk < SPILL_MIN_LINES )    chunk = SPILL_MIN_LINES;
+        if( chunk > pRepo->actualCodes ) chunk = pRepo->actualCodes > 0 ? pRepo->actualCodes : 1;
+
+        runs = ( pRepo->actualCodes + chunk - 1 ) / chunk;
+        for( need = 1, size = pSpill->fanIn; size < runs; size *= pSpill->fanIn ) need++;
+        if( need <= levels ) break;
+        levels = need;
+    }
+    pSpill->chunk = (int)chunk;
+
+    pSpill->inconsistent = (uint64_t*)calloc( bitmapWords( pRepo->actualCodes ) + 1, sizeof(uint64_t) );
+    if( pSpill->inconsistent == NULL )
+    {
+        fprintf( pRepo->err, "Failed to create line bitmap in spillBudget\n" );
+        return -1;
+    }
+    return 0;
+}
+
+// Read the file a chunk at a time, checking each line on its own and spilling the chunk's records as a sorted run
+// Notes whether any line has a problem, and the total turns to solve
+int spillRuns( Spill* pSpill, bool* pFault, int* pTTTS )
+{
+    Repo*        pRepo   = pSpill->pRepo;
+    Solution*    data    = NULL;
+    SpillRecord* records = NULL;
+    char         line[256];
+    int          fields  = 0;
+    int          count   = 0;
+    int          done    = 0;
+    int          i       = 0;
+    int          rc      = 0;
+
+    data    = (Solution*)malloc( sizeof(Solution) * pSpill->chunk );
+    records = (SpillRecord*)malloc( sizeof(SpillRecord) * pSpill->chunk );
+    if( data == NULL || records == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate arrays in spillRuns\n" );
+        free( data );
+        free( records );
+        return -1;
+    }
+
+    fseek( pRepo->fp, 0, SEEK_SET );
+    getLine( pRepo->fp, line, 256 );            // Step over the header
+
+    for( done = 0; done < pRepo->actualCodes && rc == 0; done += count )
+    {
+        count = pRepo->actualCodes - done < pSpill->chunk ? pRepo->actualCodes - done : pSpill->chunk;
+        rc = initSolutions( pRepo, data, count );
+        if( rc ) break;
+
+        for( i = 0; i < count && rc == 0; i++ )
+        {
+            fields = getLine( pRepo->fp, line, 256 );
+            data[i].line = done + i;
+            if( fields == EOF )
+            {
+                fprintf( pRepo->err, "Problem with inconsistent code counts in spillRuns\n" );
+                rc = -1;
+            }
+            else if( parseLine( pRepo, &data[i], line, fields ) != 0 )
+            {
+                fprintf( pRepo->err, "More guesses than expected\n" );
+                rc = -1;
+            }
+            else
+            {
+                spillLine( pRepo, &data[i], pRepo->seen, pRepo->repeat );
+                spillRecord( pRepo, &data[i], &records[i] );
+                *pTTTS += data[i].noTurns;
+                if( solutionFault( pRepo, &data[i] ) )
+                {
+                    *pFault = true;
+                    progressProblems( pRepo, 1 );
+                }
+                progressCount( pRepo, 1, strlen( line ) + 1 );
+            }
+        }
+        if( rc == 0 ) rc = writeRun( pSpill, records, count );
+
+        for( i = 0; i < count; i++ ) free( data[i].turns );
+    }
+
+    free( data );
+    free( records );
+    return rc;
+}
+
+// Make the checks that need only the line itself, and the codes seen on the lines before it
+// Only the first line (in file order) showing a code escapes being flagged as a repeat
+void spillLine( Repo* pRepo, Solution* pSoln, uint64_t* claimed, uint64_t* repeat )
+{
+    int g = 0;
+
+    countTurns( pRepo, pSoln );
+
+    pSoln->codeRepeated = false;
+    if( pSoln->code >= 0 && pSoln->code < pRepo->codes )
+    {
+        if( ! testBit( claimed, pSoln->code ) )
+            setBit( claimed, pSoln->code );
+        else
+        {
+            pSoln->codeRepeated = true;
+            if( repeat != NULL ) setBit( repeat, pSoln->code );
+        }
+    }
+
+    for( g = 0; g < pSoln->actualNoTurns && g < pRepo->guesses; g++ )
+        pSoln->turns[g].markOK = ( pSoln->turns[g].mark == marking( pRepo, pSoln->code, pSoln->turns[g].guess ) );
+}
+
+// Pack the guesses and marks of a line into a record - turns past the header's guesses are left empty
+void spillRecord( Repo* pRepo, Solution* pSoln, SpillRecord* pRec )
+{
+    int g = 0;
+
+    memset( pRec, 0, sizeof(SpillRecord) );
+    pRec->line          = pSoln->line;
+    pRec->actualNoTurns = pSoln->actualNoTurns;
+    for( g = 0; g < SPILL_MAX_GUESSES; g++ )
+    {
+        pRec->guess[g] = g < pRepo->guesses ? pSoln->turns[g].guess : -1;
+        pRec->mark[g]  = g < pRepo->guesses ? pSoln->turns[g].mark  : -1;
+    }
+}
+
+// Sort a chunk of records and spill it as a run
+// Once there are fanIn runs of the same size, they are merged into one, so there are never many runs open
+int writeRun( Spill* pSpill, SpillRecord* records, int count )
+{
+    SpillRun* runs = NULL;
+    FILE*     fp   = NULL;
+    int       rc   = 0;
+
+    qsort( records, count, sizeof(SpillRecord), cmpSpillOrder );
+
+    if( pSpill->runCount == pSpill->runSize )
+    {
+        runs = (SpillRun*)realloc( pSpill->runs, sizeof(SpillRun) * ( pSpill->runSize + 16 ) );
+        if( runs == NULL )
+        {
+            fprintf( pSpill->pRepo->err, "Failed to allocate array in writeRun\n" );
+            return -1;
+        }
+        pSpill->runs     = runs;
+        pSpill->runSize += 16;
+    }
+
+    fp = newRunFile( pSpill );
+    if( fp == NULL ) return -1;
+    pSpill->runs[pSpill->runCount].fp    = fp;
+    pSpill->runs[pSpill->runCount].level = 0;
+    pSpill->runs[pSpill->runCount].more  = false;
+    pSpill->runCount += 1;
+
+    if( fwrite( records, sizeof(SpillRecord), count, fp ) != (size_t)count )
+    {
+        fprintf( pSpill->pRepo->err, "Failed to write a run to %s\n", pSpill->dir );
+        return -1;
+    }
+
+    // Runs are stacked largest first, so the last fanIn runs are the same size if the first of them is the size of the last
+    while( rc == 0 && pSpill->runCount >= pSpill->fanIn
+           && pSpill->runs[pSpill->runCount - pSpill->fanIn].level == pSpill->runs[pSpill->runCount - 1].level )
+        rc = mergeTop( pSpill, pSpill->fanIn );
+
+    return rc;
+}
+
+// Open a scratch file for a run
+// The file is unlinked straight away, so it goes as soon as it is closed - however the run ends
+FILE* newRunFile( Spill* pSpill )
+{
+    char  path[1024];
+    FILE* fp = NULL;
+    int   fd = -1;
+
+    if( snprintf( path, sizeof(path), "%s/MMchkRun.XXXXXX", pSpill->dir ) >= (int)sizeof(path) )
+    {
+        fprintf( pSpill->pRepo->err, "Scratch directory name is too long: %s\n", pSpill->dir );
+        return NULL;
+    }
+    fd = mkstemp( path );
+    if( fd < 0 )
+    {
+        fprintf( pSpill->pRepo->err, "Unable to create a scratch file in %s\n", pSpill->dir );
+        return NULL;
+    }
+    unlink( path );
+
+    fp = fdopen( fd, "w+b" );
+    if( fp == NULL )
+    {
+        fprintf( pSpill->pRepo->err, "Unable to open a scratch file in %s\n", pSpill->dir );
+        close( fd );
+        return NULL;
+    }
+    setvbuf( fp, NULL, _IOFBF, SPILL_BUFFER );
+    return fp;
+}
+
+// Merge the last count runs into one new run
+int mergeTop( Spill* pSpill, int count )
+{
+    SpillRun* runs  = &pSpill->runs[pSpill->runCount - count];
+    FILE*     fp    = NULL;
+    int       level = runs[0].level + 1;
+    int       rc    = 0;
+
+    fp = newRunFile( pSpill );
+    if( fp == NULL ) return -1;
+
+    rc = mergeRuns( pSpill, runs, count, fp );
+    pSpill->runCount -= count;
+    pSpill->runs[pSpill->runCount].fp    = fp;
+    pSpill->runs[pSpill->runCount].level = level;
+    pSpill->runs[pSpill->runCount].more  = false;
+    pSpill->runCount += 1;
+
+    return rc;
+}
+
+// Merge every run, checking the records in mark order
+// If there are more runs than can be merged at once, they are first merged down in several passes
+int mergeAll( Spill* pSpill )
+{
+    int rc = 0;
+
+    while( rc == 0 && pSpill->runCount > pSpill->fanIn )
+        rc = mergeTop( pSpill, pSpill->fanIn );
+
+    if( rc == 0 ) rc = mergeRuns( pSpill, pSpill->runs, pSpill->runCount, NULL );
+    pSpill->runCount = 0;
+
+    return rc;
+}
+
+// Merge runs into a new run, or (if out is NULL) into checkRecord
+// The run with the next record is kept at the top of a heap.  The runs merged are closed
+int mergeRuns( Spill* pSpill, SpillRun* runs, int count, FILE* out )
+{
+    SpillRun** heap  = NULL;
+    SpillRun*  pRun  = NULL;
+    int        size  = 0;
+    int        i     = 0;
+    int        c     = 0;
+    int        rc    = 0;
+
+    heap = (SpillRun**)malloc( sizeof(SpillRun*) * ( count + 1 ) );
+    if( heap == NULL )
+    {
+        fprintf( pSpill->pRepo->err, "Failed to allocate array in mergeRuns\n" );
+        return -1;
+    }
+
+    // Start each run at its first record, and sift it up into the heap
+    for( i = 0; i < count; i++ )
+    {
+        rewind( runs[i].fp );
+        runs[i].more = ( fread( &runs[i].next, sizeof(SpillRecord), 1, runs[i].fp ) == 1 );
+        if( ! runs[i].more ) continue;
+        for( c = size++; c > 0 && cmpSpillOrder( &runs[i].next, &heap[(c-1)/2]->next ) < 0; c = (c-1)/2 )
+            heap[c] = heap[(c-1)/2];
+        heap[c] = &runs[i];
+    }
+
+    while( size > 0 && rc == 0 )
+    {
+        pRun = heap[0];
+        if( out == NULL )
+        {
+            checkRecord( pSpill, &pRun->next );
+            progressCount( pSpill->pRepo, 1, 0 );
+        }
+        else if( fwrite( &pRun->next, sizeof(SpillRecord), 1, out ) != 1 )
+        {
+            fprintf( pSpill->pRepo->err, "Failed to write a run to %s\n", pSpill->dir );
+            rc = -1;
+        }
+
+        // Move on to the run's next record (or drop the run if it is finished), and sift it down to its place
+        pRun->more = ( fread( &pRun->next, sizeof(SpillRecord), 1, pRun->fp ) == 1 );
+        if( ! pRun->more ) pRun = heap[--size];
+        for( i = 0; ( c = 2 * i + 1 ) < size; i = c )
+        {
+            if( c + 1 < size && cmpSpillOrder( &heap[c+1]->next, &heap[c]->next ) < 0 ) c += 1;
+            if( cmpSpillOrder( &heap[c]->next, &pRun->next ) >= 0 ) break;
+            heap[i] = heap[c];
+        }
+        if( size > 0 ) heap[i] = pRun;
+    }
+
+    for( i = 0; i < count; i++ )
+    {
+        fclose( runs[i].fp );
+        runs[i].fp = NULL;
+    }
+    free( heap );
+    return rc;
+}
+
+// Check a line's guesses against the line before it in mark order - as compareGuesses does for lines in memory
+void checkRecord( Spill* pSpill, SpillRecord* pRec )
+{
+    SpillRecord* pPrev = &pSpill->prev;
+    int          level = 0;
+
+    if( pSpill->merged == 0 )
+        pSpill->first = *pRec;
+    else
+    {
+        // The same guess must be made for every code at first level
+        if( pRec->guess[0] != pSpill->first.guess[0] ) setBit( pSpill->inconsistent, pRec->line );
+
+        // Look at each level and if the previous guesses and marks were the same - this guess must be the same
+        for( level = 1; level < pRec->actualNoTurns && level < pSpill->pRepo->guesses; level++ )
+            if( pRec->mark[level-1] == pPrev->mark[level-1] && pRec->guess[level-1] == pPrev->guess[level-1]
+                && pRec->guess[level] != pPrev->guess[level] )
+                setBit( pSpill->inconsistent, pRec->line );
+    }
+    *pPrev = *pRec;
+    pSpill->merged += 1;
+}
+
+// Output findings, as report does
+// The lines are read again to write the _ERRORS.csv file, checking each again with the inconsistent lines now known
+int spillReport( Spill* pSpill, bool fault, int TTTS )
+{
+    Repo*     pRepo         = pSpill->pRepo;
+    bool      fileError     = false;
+    bool      solutionError = fault;
+    uint64_t* claimed       = NULL;
+    Solution  soln;
+    char      line[256];
+    OutBuf    out;
+    FILE*     fpo           = NULL;
+    int       fields        = 0;
+    int       w             = 0;
+    int       i             = 0;
+    int       rc            = 0;
+
+    for( w = 0; w < bitmapWords( pRepo->actualCodes ) && ! solutionError; w++ )
+        if( pSpill->inconsistent[w] != 0 ) solutionError = true;
+
+    say( pRepo, "\nAnalysis of %s:   ", pRepo->baseName );
+
+    if( ! pRepo->pegsOK || ! pRepo->coloursOK || ! pRepo->codesOK || pRepo->missingCodes > 0 )
+        fileError = true;
+
+    if( ! fileError && ! solutionError )
+    {
+        say( pRepo, "No errors found.  TTTS = %d\n\n", TTTS );
+        return 0;
+    }
+
+    if( fileError )
+        reportFileErrors( pRepo );
+
+    if( solutionError && ! pRepo->errorsFile )
+    {
+        say( pRepo, "solution level errors\n" );
+    }
+    else if( solutionError )
+    {
+        claimed = (uint64_t*)calloc( bitmapWords( pRepo->codes ), sizeof(uint64_t) );
+        if( claimed == NULL )
+        {
+            fprintf( pRepo->err, "Failed to create code bitmap\n" );
+            return -1;
+        }
+        fpo = openErrorsFile( pRepo );
+        if( fpo == NULL || openOut( &out, pRepo, fpo ) )
+        {
+            if( fpo != NULL ) fclose( fpo );
+            free( claimed );
+            return -1;
+        }
+
+        // Now merge the input file with errors found
+        fseek( pRepo->fp, 0, SEEK_SET );
+        getLine( pRepo->fp, line, 256 );
+        putText( &out, "Status,Issues,", 14 );  // Write header
+        putString( &out, line );
+        putChar( &out, '\n' );
+
+        for( i = 0; i < pRepo->actualCodes && rc == 0; i++ )
+        {
+            fields = getLine( pRepo->fp, line, 256 );
+            rc = initSolutions( pRepo, &soln, 1 );
+            if( rc ) break;
+            soln.line = i;
+            parseLine( pRepo, &soln, line, fields );
+            spillLine( pRepo, &soln, claimed, NULL );
+            soln.guessConsistant = ! testBit( pSpill->inconsistent, i );
+            writeErrorRow( &out, &soln, line, solutionFault( pRepo, &soln ) );
+            free( soln.turns );
+        }
+        if( closeOut( &out ) ) fprintf( pRepo->err, "Unable to write all of %s\n", pRepo->outputName );
+        fclose( fpo );
+        free( claimed );
+    }
+    say( pRepo, "\n" );
+
+    return rc;
+}
+
+// Close any runs still open, and free the working state
+void freeSpill( Spill* pSpill )
+{
+    int i = 0;
+
+    for( i = 0; i < pSpill->runCount; i++ )
+        if( pSpill->runs[i].fp != NULL ) fclose( pSpill->runs[i].fp );
+    free( pSpill->runs );
+    free( pSpill->inconsistent );
+    pSpill->runs         = NULL;
+    pSpill->inconsistent = NULL;
+    pSpill->runCount     = 0;
+}
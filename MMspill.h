@@ -0,0 +1,74 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMSPILL_H
+#define MMSPILL_H
+
+#include "MMchk.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define SPILL_MAX_GUESSES      10                      // The most guesses a header can show (see parseHeader)
+#define SPILL_MAX_RUNS         64                      // Most runs merged at once - more are merged in several passes
+#define SPILL_MIN_LINES        64                      // Fewest lines read into each run, however small the budget
+#define SPILL_BUFFER           65536                   // Buffer for each run file while merging
+
+// A line's path through the strategy, packed for sorting into runs
+// Runs are in mark order (then line order), the same order that checkGuesses looks at the lines in
+typedef struct SpillRecord
+{
+    int32_t line;
+    int32_t actualNoTurns;
+    int32_t guess[SPILL_MAX_GUESSES];
+    int8_t  mark[SPILL_MAX_GUESSES];                   // -1 if there is no mark (or it could not be read)
+    int8_t  spare[6];
+} SpillRecord;
+
+// A sorted run, spilled to a scratch file
+typedef struct SpillRun
+{
+    FILE*       fp;
+    SpillRecord next;                                  // Next record to merge
+    bool        more;                                  // Is next still to be merged?
+    int         level;                                 // Times its records have been merged (0 for a run just read)
+} SpillRun;
+
+// Working state of an out-of-core check
+typedef struct Spill
+{
+    Repo*       pRepo;
+    const char* dir;                                   // Scratch directory the runs are written to
+    int         chunk;                                 // Lines read into each run
+    int         fanIn;                                 // Runs merged at once
+    SpillRun*   runs;
+    int         runCount;
+    int         runSize;                               // Runs there is room for
+    uint64_t*   inconsistent;                          // Bitmap of the lines with inconsistent guesses
+    SpillRecord first;                                 // First record in mark order
+    SpillRecord prev;                                  // Record before the one being checked
+    long long   merged;                                // Records checked so far
+} Spill;
+
+int  spillCheck( Repo* pRepo );
+int  spillBudget( Spill* pSpill );
+int  spillRuns( Spill* pSpill, bool* pFault, int* pTTTS );
+void spillLine( Repo* pRepo, Solution* pSoln, uint64_t* claimed, uint64_t* repeat );
+void spillRecord( Repo* pRepo, Solution* pSoln, SpillRecord* pRec );
+int  writeRun( Spill* pSpill, SpillRecord* records, int count );
+FILE* newRunFile( Spill* pSpill );
+int  mergeTop( Spill* pSpill, int count );
+int  mergeAll( Spill* pSpill );
+int  mergeRuns( Spill* pSpill, SpillRun* runs, int count, FILE* out );
+void checkRecord( Spill* pSpill, SpillRecord* pRec );
+int  spillReport( Spill* pSpill, bool fault, int TTTS );
+void freeSpill( Spill* pSpill );
+
+#endif  /* MMSPILL_H */
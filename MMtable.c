@@ -0,0 +1,416 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Decision table export - the strategy of a validated solution, laid out for a game playing service to look up
+// Each node holds an entry for every mark, giving the next guess and the node it is made at, so every move is one lookup
+// The file is written once and mapped in read-only, in the same way as the mark cache
+//
+#include "MMtable.h"
+#include "MMchk.h"
+#include "MMcache.h"
+#include "MMkernels.h"
+#include "MMtree.h"
+#include "MMutility.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static int  fillTable( Repo* pRepo, Tree* pTree, TableEntry* entry, TableHeader* pHeader );
+static int  writeTable( Repo* pRepo, char* name, TableHeader* pHeader, TableEntry* entry );
+static const char* checkEntries( const TableHeader* pHeader, const TableEntry* entry );
+static uint64_t    tableCodes( const TableHeader* pHeader );
+
+// Write the strategy of the solution just checked as a decision table (--export-table)
+// Only a solution with every pass checked, and no errors found, is exported
+int exportTable( Repo* pRepo )
+{
+    Tree        tree;
+    TableHeader header;
+    TableEntry* entry = NULL;
+    int         rc    = 0;
+
+    if( ( pRepo->checks & CHECK_DEFAULT ) != CHECK_DEFAULT )
+    {
+        fprintf( pRepo->err, "Not exporting %s - only a solution with every pass checked can be exported\n", pRepo->tableName );
+        return -1;
+    }
+    if( ! solutionValid( pRepo ) )
+    {
+        fprintf( pRepo->err, "Not exporting %s - the solution has errors\n", pRepo->tableName );
+        return -1;
+    }
+
+    rc = buildTree( pRepo, &tree );
+    if( rc == 0 )
+    {
+        entry = (TableEntry*)malloc( sizeof(TableEntry) * (size_t)tree.nodes * tree.marks );
+        if( entry == NULL )
+        {
+            fprintf( pRepo->err, "Failed to allocate decision table\n" );
+            rc = -1;
+        }
+    }
+    if( rc == 0 )
+    {
+        memset( &header, 0, sizeof(header) );
+        memcpy( header.magic, TABLE_MAGIC, 8 );
+        header.version = TABLE_VERSION;
+        header.pegs    = pRepo->pegs;
+        header.colours = pRepo->colours;
+        header.codes   = pRepo->codes;
+        rc = fillTable( pRepo, &tree, entry, &header );
+    }
+    if( rc == 0 ) rc = writeTable( pRepo, pRepo->tableName, &header, entry );
+    if( rc == 0 ) say( pRepo, "Decision table of %u nodes written to %s\n\n", header.nodes, pRepo->tableName );
+
+    free( entry );
+    freeTree( &tree );
+    return rc;
+}
+
+// Lay the tree out breadth first - each node's children are numbered in mark order as the node is reached
+// Returns -1 if memory ran out
+static int fillTable( Repo* pRepo, Tree* pTree, TableEntry* entry, TableHeader* pHeader )
+{
+    int* order = NULL;                                 // Tree node at each position in the table
+    int* index = NULL;                                 // Position in the table of each tree node
+    int  next  = 1;
+    int  old   = 0;
+    int  child = 0;
+    int  n     = 0;
+    int  m     = 0;
+
+    order = (int*)malloc( sizeof(int) * pTree->nodes );
+    index = (int*)malloc( sizeof(int) * pTree->nodes );
+    if( order == NULL || index == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate decision table\n" );
+        free( order );
+        free( index );
+        return -1;
+    }
+
+    // The table order is itself the queue of the breadth first walk
+    order[0] = 0;
+    index[0] = 0;
+    for( n = 0; n < next; n++ )
+    {
+        old = order[n];
+        for( m = 0; m < pTree->marks; m++ )
+        {
+            child = pTree->child[old * pTree->marks + m];
+            if( child == -1 || pTree->node[child].guess == -1 ) continue;
+            index[child]  = next;
+            order[next++] = child;
+        }
+    }
+
+    pHeader->marks = pTree->marks;
+    pHeader->nodes = next;
+    pHeader->first = pTree->node[0].guess == -1 ? TABLE_NONE : (uint32_t)pTree->node[0].guess;
+    pHeader->depth = 0;
+    for( n = 0; n < next; n++ )
+    {
+        old = order[n];
+        if( (uint32_t)pTree->node[old].depth + 1 > pHeader->depth ) pHeader->depth = pTree->node[old].depth + 1;
+        for( m = 0; m < pTree->marks; m++ )
+        {
+            child = pTree->child[old * pTree->marks + m];
+            if( child == -1 || pTree->node[child].guess == -1 )
+            {
+                entry[n * pTree->marks + m].guess = TABLE_NONE;
+                entry[n * pTree->marks + m].child = TABLE_NONE;
+            }
+            else
+            {
+                entry[n * pTree->marks + m].guess = pTree->node[child].guess;
+                entry[n * pTree->marks + m].child = index[child];
+            }
+        }
+    }
+    pHeader->size     = sizeof(TableEntry) * (uint64_t)next * pTree->marks;
+    pHeader->checksum = cacheChecksum( (unsigned char*)entry, pHeader->size );
+
+    free( order );
+    free( index );
+    return 0;
+}
+
+// Write the table to a temporary file which is then renamed, so a service never maps a half written table
+static int writeTable( Repo* pRepo, char* name, TableHeader* pHeader, TableEntry* entry )
+{
+    char     temp[520];
+    char*    data    = (char*)entry;
+    uint64_t done    = 0;
+    ssize_t  written = 0;
+    int      fd      = -1;
+    int      rc      = 0;
+
+    snprintf( temp, sizeof(temp), "%s.XXXXXX", name );
+    fd = mkstemp( temp );
+    if( fd == -1 )
+    {
+        fprintf( pRepo->err, "Unable to write decision table %s (%s)\n", name, strerror( errno ) );
+        return -1;
+    }
+
+    if( write( fd, pHeader, sizeof(TableHeader) ) != sizeof(TableHeader) ) rc = -1;
+    while( rc == 0 && done < pHeader->size )
+    {
+        written = write( fd, data + done, pHeader->size - done );
+        if( written <= 0 ) rc = -1;
+        else done += written;
+    }
+    if( rc == 0 && fchmod( fd, 0644 ) != 0 ) rc = -1;
+    if( close( fd ) != 0 ) rc = -1;
+    if( rc == 0 && rename( temp, name ) != 0 ) rc = -1;
+
+    if( rc != 0 )
+    {
+        fprintf( pRepo->err, "Unable to write decision table %s (%s)\n", name, strerror( errno ) );
+        unlink( temp );
+    }
+    return rc;
+}
+
+// Were there no errors of any kind found in the solution?  (The same test as report makes)
+bool solutionValid( Repo* pRepo )
+{
+    int i = 0;
+
+    if( ! pRepo->pegsOK || ! pRepo->coloursOK || ! pRepo->codesOK || pRepo->missingCodes > 0 )
+        return false;
+    for( i = 0; i < pRepo->actualCodes; i++ )
+        if( solutionFault( pRepo, &pRepo->data[i] ) )
+            return false;
+    return true;
+}
+
+// Map in a decision table, checking that it is whole
+// Returns 0 if the table is ready for lookups, otherwise -1
+int openTable( Repo* pRepo, DecisionTable* pTable, const char* name )
+{
+    struct stat  info;
+    TableHeader* pHeader = NULL;
+    void*        map     = NULL;
+    const char*  reason  = NULL;
+    int          fd      = -1;
+
+    memset( pTable, 0, sizeof(DecisionTable) );
+    fd = open( name, O_RDONLY );
+    if( fd == -1 || fstat( fd, &info ) != 0 )
+    {
+        fprintf( pRepo->err, "Unable to open decision table %s (%s)\n", name, strerror( errno ) );
+        if( fd != -1 ) close( fd );
+        return -1;
+    }
+    if( (size_t)info.st_size < sizeof(TableHeader) )
+    {
+        close( fd );
+        fprintf( pRepo->err, "Decision table %s is too short\n", name );
+        return -1;
+    }
+    map = mmap( NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if( map == MAP_FAILED )
+    {
+        fprintf( pRepo->err, "Unable to map decision table %s (%s)\n", name, strerror( errno ) );
+        return -1;
+    }
+
+    pHeader = (TableHeader*)map;
+    if( memcmp( pHeader->magic, TABLE_MAGIC, 8 ) != 0 )
+        reason = "is not a decision table";
+    else if( pHeader->version != TABLE_VERSION )
+        reason = "is from another version";
+    else if( pHeader->pegs < 1 || pHeader->pegs > MAX_PEGS || pHeader->marks != ( pHeader->pegs * ( pHeader->pegs + 3 ) ) / 2
+             || pHeader->colours < 1 || pHeader->colours > MAX_COLOURS || pHeader->codes != tableCodes( pHeader ) )
+        reason = "is not for a puzzle that can be checked";
+    else if( pHeader->nodes < 1 || ( pHeader->first != TABLE_NONE && pHeader->first >= pHeader->codes ) )
+        reason = "has no sound root node";
+    else if( (uint64_t)info.st_size != sizeof(TableHeader) + pHeader->size || pHeader->size != sizeof(TableEntry) * (uint64_t)pHeader->nodes * pHeader->marks )
+        reason = "is the wrong size";
+    else if( pHeader->checksum != cacheChecksum( (unsigned char*)map + sizeof(TableHeader), pHeader->size ) )
+        reason = "is corrupt";
+    else
+        reason = checkEntries( pHeader, (TableEntry*)( (char*)map + sizeof(TableHeader) ) );
+
+    if( reason != NULL )
+    {
+        munmap( map, info.st_size );
+        fprintf( pRepo->err, "Decision table %s %s\n", name, reason );
+        return -1;
+    }
+
+    pTable->header  = pHeader;
+    pTable->entry   = (TableEntry*)( (char*)map + sizeof(TableHeader) );
+    pTable->map     = map;
+    pTable->mapSize = info.st_size;
+    return 0;
+}
+
+// Codes in the puzzle the table is for - colours^pegs, or more than any header can hold if that overflows
+static uint64_t tableCodes( const TableHeader* pHeader )
+{
+    uint64_t codes = 1;
+    uint32_t p     = 0;
+
+    for( p = 0; p < pHeader->pegs && codes <= UINT32_MAX; p++ ) codes *= pHeader->colours;
+    return codes;
+}
+
+// Walk every entry once, so lookups can trust the table - returns why the table is bad, or NULL if every entry is sound
+// An entry either has no next guess and no child, or a guess that is a code and a child that is a node
+static const char* checkEntries( const TableHeader* pHeader, const TableEntry* entry )
+{
+    uint64_t entries = (uint64_t)pHeader->nodes * pHeader->marks;
+    uint64_t e       = 0;
+
+    for( e = 0; e < entries; e++ )
+    {
+        if( entry[e].guess == TABLE_NONE && entry[e].child == TABLE_NONE ) continue;
+        if( entry[e].guess >= pHeader->codes ) return "has a guess that is not a code";
+        if( entry[e].child >= pHeader->nodes ) return "has a child that is not a node";
+    }
+    return NULL;
+}
+
+// Release a mapped decision table
+void closeTable( DecisionTable* pTable )
+{
+    if( pTable->map != NULL ) munmap( pTable->map, pTable->mapSize );
+    memset( pTable, 0, sizeof(DecisionTable) );
+}
+
+// The mark numbering used by the table for a number of black and white pegs
+// Returns -1 if there can be no such mark
+int tableMark( const DecisionTable* pTable, int black, int white )
+{
+    if( black < 0 || white < 0 || black + white > (int)pTable->header->pegs ) return -1;
+    if( black == (int)pTable->header->pegs - 1 && white == 1 ) return -1;
+    return markTranslation[black][white];
+}
+
+// Construct the string for a code in the table, eg "ABCD" (as in the solution file)
+// NOTE - There MUST be pegs+1 bytes space available in the buffer
+char* tableCode( const DecisionTable* pTable, uint32_t code, char* buffer )
+{
+    int i = 0;
+
+    for( i = pTable->header->pegs; i > 0; i-- )
+    {
+        buffer[i-1] = 'A' + code % pTable->header->colours;
+        code       /= pTable->header->colours;
+    }
+    buffer[pTable->header->pegs] = '\0';
+    return buffer;
+}
+
+// Benchmark lookups in a decision table (--bench-table)
+// Every code is played through the table once to find its marks (which also shows the table solves every code)
+// Then the games are replayed from those marks alone, for at least TABLE_BENCH_SECONDS, so only the lookups are timed
+int benchTable( Repo* pRepo )
+{
+    DecisionTable     table;
+    const TableEntry* pEntry   = NULL;
+    char*             marks    = NULL;
+    char              buffer[MAX_PEGS+1];
+    struct timespec   start;
+    struct timespec   now;
+    double            seconds  = 0;
+    long long         lookups  = 0;
+    long long         TTTS     = 0;
+    uint32_t          sum      = 0;
+    uint32_t          node     = 0;
+    uint32_t          guess    = 0;
+    int               allBlack = 0;
+    int               depth    = 0;
+    int               passes   = 0;
+    int               code     = 0;
+    int               g        = 0;
+    int               rc       = 0;
+
+    rc = openTable( pRepo, &table, pRepo->benchName ); if( rc ) return rc;
+    pRepo->pegs    = table.header->pegs;
+    pRepo->colours = table.header->colours;
+    pRepo->codes   = table.header->codes;
+    selectKernel( pRepo );
+    allBlack = table.header->marks - 1;
+    depth    = table.header->depth;
+
+    marks = (char*)malloc( (size_t)pRepo->codes * depth );
+    if( marks == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate array in benchTable\n" );
+        closeTable( &table );
+        return -1;
+    }
+
+    // Play every code, keeping its marks
+    for( code = 0; code < pRepo->codes && rc == 0; code++ )
+    {
+        node  = 0;
+        guess = table.header->first;
+        for( g = 0; g < depth && guess != TABLE_NONE; g++ )
+        {
+            marks[(size_t)code * depth + g] = scoreCodes( pRepo, guess, code );
+            if( marks[(size_t)code * depth + g] == allBlack ) break;
+            pEntry = tableEntry( &table, node, marks[(size_t)code * depth + g] );
+            guess  = pEntry->guess;
+            node   = pEntry->child;
+        }
+        if( g == depth || guess == TABLE_NONE )
+        {
+            fprintf( pRepo->err, "Decision table %s does not solve %s\n", pRepo->benchName, tableCode( &table, code, buffer ) );
+            rc = -1;
+        }
+        else
+            TTTS += g + 1;
+    }
+
+    // Time the lookups alone
+    clock_gettime( CLOCK_MONOTONIC, &start );
+    while( rc == 0 && seconds < TABLE_BENCH_SECONDS )
+    {
+        for( code = 0; code < pRepo->codes; code++ )
+        {
+            node = 0;
+            for( g = 0; marks[(size_t)code * depth + g] != allBlack; g++ )
+            {
+                pEntry   = tableEntry( &table, node, marks[(size_t)code * depth + g] );
+                sum     += pEntry->guess;
+                node     = pEntry->child;
+                lookups += 1;
+            }
+        }
+        passes += 1;
+        clock_gettime( CLOCK_MONOTONIC, &now );
+        seconds = ( now.tv_sec - start.tv_sec ) + ( now.tv_nsec - start.tv_nsec ) / 1e9;
+    }
+
+    if( rc == 0 )
+    {
+        say( pRepo, "\nDecision table %s:   %u nodes, %d pegs %d colours, TTTS = %lld\n", pRepo->benchName, table.header->nodes, pRepo->pegs, pRepo->colours, TTTS );
+        say( pRepo, "Every code played %d times - %lld lookups in %.3f seconds = %.1f million lookups per second  (check %08x)\n\n",
+                    passes, lookups, seconds, lookups / seconds / 1e6, sum );
+    }
+
+    free( marks );
+    closeTable( &table );
+    return rc;
+}
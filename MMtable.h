@@ -0,0 +1,73 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMTABLE_H
+#define MMTABLE_H
+
+#include "MMchk.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define TABLE_MAGIC            "MMchkTBL"
+#define TABLE_VERSION          1                       // Change whenever the layout of the decision table changes
+#define TABLE_NONE             0xFFFFFFFFu             // No guess follows (the mark is all-black, or never given at this node)
+#define TABLE_BENCH_SECONDS    1.0                     // Least time to spend timing lookups
+
+// Start of a decision table file - the entries follow straight after
+typedef struct TableHeader
+{
+    char     magic[8];                                 // TABLE_MAGIC
+    uint32_t version;                                  // TABLE_VERSION
+    uint32_t pegs;
+    uint32_t colours;
+    uint32_t codes;
+    uint32_t marks;                                    // Entries per node - one for each possible mark
+    uint32_t nodes;
+    uint32_t first;                                    // Guess made at the root node (node 0)
+    uint32_t depth;                                    // Most guesses taken by any code
+    uint64_t size;                                     // Bytes of entries following the header
+    uint64_t checksum;                                 // Of the entries, to catch a corrupt file
+    uint8_t  spare[8];                                 // Pad to 64 bytes, so the entries are well aligned
+} TableHeader;
+
+// What to do when a mark is given at a node - make this guess, which is at this child node
+// Nodes are numbered breadth first, so the entries for a node's children are near each other (and near its own)
+typedef struct TableEntry
+{
+    uint32_t guess;                                    // Next guess (TABLE_NONE if there is none)
+    uint32_t child;                                    // Node the next guess is made at
+} TableEntry;
+
+// A decision table mapped in for lookups
+typedef struct DecisionTable
+{
+    const TableHeader* header;
+    const TableEntry*  entry;                          // marks entries for each node in turn
+    void*              map;
+    size_t             mapSize;
+} DecisionTable;
+
+// One move - the entry for the mark given to the guess made at a node
+// Start with header->first at node 0, then follow entry->guess and entry->child until the mark is all-black
+static inline const TableEntry* tableEntry( const DecisionTable* pTable, uint32_t node, int mark )
+{
+    return &pTable->entry[(size_t)node * pTable->header->marks + mark];
+}
+
+int   exportTable( Repo* pRepo );
+bool  solutionValid( Repo* pRepo );
+int   benchTable( Repo* pRepo );
+int   openTable( Repo* pRepo, DecisionTable* pTable, const char* name );
+void  closeTable( DecisionTable* pTable );
+int   tableMark( const DecisionTable* pTable, int black, int white );
+char* tableCode( const DecisionTable* pTable, uint32_t code, char* buffer );
+
+#endif  /* MMTABLE_H */
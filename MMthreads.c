@@ -0,0 +1,85 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Simple fork/join parallelism - a range of items is split into one contiguous block per thread
+//
+#include "MMthreads.h"
+#include "MMchk.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define MIN_ITEMS_PER_THREAD   64                      // Not worth starting a thread for less than this
+
+// Number of threads to use if not told otherwise - one per online processor
+int defaultThreads( void )
+{
+    long cpus = sysconf( _SC_NPROCESSORS_ONLN );
+
+    if( cpus < 1 ) return 1;
+    if( cpus > MAX_THREADS ) return MAX_THREADS;
+    return (int)cpus;
+}
+
+// Run fn over items [0, items), split across up to pRepo->threads threads
+// The calling thread takes the last block itself, then waits for the others
+// If a thread can't be started, its block is run on the calling thread instead
+int runParallel( Repo* pRepo, int items, TaskFn fn, void* arg )
+{
+    pthread_t tid[MAX_THREADS];
+    bool      started[MAX_THREADS];
+    Task      task[MAX_THREADS];
+    int       threads = 0;
+    int       t       = 0;
+
+    threads = pRepo->threads;
+    if( threads > items / MIN_ITEMS_PER_THREAD ) threads = items / MIN_ITEMS_PER_THREAD;
+    if( threads > MAX_THREADS ) threads = MAX_THREADS;
+    if( threads <= 1 )
+    {
+        fn( pRepo, 0, items, arg );
+        return 0;
+    }
+
+    for( t = 0; t < threads; t++ )
+    {
+        task[t].pRepo = pRepo;
+        task[t].fn    = fn;
+        task[t].arg   = arg;
+        task[t].from  = (int)( (long)items * t / threads );
+        task[t].to    = (int)( (long)items * ( t + 1 ) / threads );
+    }
+
+    for( t = 0; t < threads - 1; t++ )
+        started[t] = ( pthread_create( &tid[t], NULL, runTask, &task[t] ) == 0 );
+
+    runTask( &task[threads-1] );
+
+    for( t = 0; t < threads - 1; t++ )
+    {
+        if( started[t] )
+            pthread_join( tid[t], NULL );
+        else
+            runTask( &task[t] );
+    }
+    return 0;
+}
+
+// Thread entry point - unpack the task and run it
+void* runTask( void* task )
+{
+    Task* pTask = (Task*)task;
+
+    pTask->fn( pTask->pRepo, pTask->from, pTask->to, pTask->arg );
+    return NULL;
+}
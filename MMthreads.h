@@ -0,0 +1,33 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMTHREADS_H
+#define MMTHREADS_H
+
+#include "MMchk.h"
+
+// Work function run on each thread - it is given a range of items [from, to) to work through
+typedef void (*TaskFn)( Repo* pRepo, int from, int to, void* arg );
+
+// Details of the work handed to each thread
+typedef struct Task
+{
+    Repo*  pRepo;
+    TaskFn fn;
+    void*  arg;
+    int    from;
+    int    to;
+} Task;
+
+int   defaultThreads( void );
+int   runParallel( Repo* pRepo, int items, TaskFn fn, void* arg );
+void* runTask( void* task );
+
+#endif  /* MMTHREADS_H */
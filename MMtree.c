@@ -0,0 +1,260 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// The strategy tree - the guess made at each point, and where each possible mark leads
+// Built from the solution lines, and then used to replay every code in the code space
+//
+#include "MMtree.h"
+#include "MMchk.h"
+#include "MMutility.h"
+#include "MMthreads.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TREE_START_NODES       1024                    // Initial size of the node array (it grows as needed)
+
+// Set up an empty tree - just the root node, with no guess yet
+int newTree( Repo* pRepo, Tree* pTree )
+{
+    pTree->marks = ( pRepo->pegs * ( pRepo->pegs + 3 ) ) / 2;
+    pTree->nodes = 0;
+    pTree->size  = 0;
+    pTree->node  = NULL;
+    pTree->child = NULL;
+
+    return addNode( pRepo, pTree ) == 0 ? 0 : -1;
+}
+
+// Add a node to the tree, growing the arrays if need be
+// Returns the index of the new node, or -1 if memory ran out
+int addNode( Repo* pRepo, Tree* pTree )
+{
+    Node* node  = NULL;
+    int*  child = NULL;
+    int   size  = 0;
+    int   m     = 0;
+
+    if( pTree->nodes == pTree->size )
+    {
+        size  = pTree->size > 0 ? pTree->size * 2 : TREE_START_NODES;
+        node  = (Node*)realloc( pTree->node, sizeof(Node) * size );
+        if( node == NULL )
+        {
+            fprintf( pRepo->err, "Failed to grow the strategy tree\n" );
+            return -1;
+        }
+        pTree->node = node;
+        child = (int*)realloc( pTree->child, sizeof(int) * size * pTree->marks );
+        if( child == NULL )
+        {
+            fprintf( pRepo->err, "Failed to grow the strategy tree\n" );
+            return -1;
+        }
+        pTree->child = child;
+        pTree->size  = size;
+    }
+
+    pTree->node[pTree->nodes].guess = -1;
+    pTree->node[pTree->nodes].depth = 0;
+    pTree->node[pTree->nodes].line  = -1;
+    for( m = 0; m < pTree->marks; m++ )
+        pTree->child[pTree->nodes * pTree->marks + m] = -1;
+
+    return pTree->nodes++;
+}
+
+// Build the strategy tree from the solution lines (which must be in their original order)
+// The first line to reach a node decides the guess made there - any later line making a different guess is inconsistent
+int buildTree( Repo* pRepo, Tree* pTree )
+{
+    Solution* pSoln    = NULL;
+    int       allBlack = 0;
+    int       node     = 0;
+    int       next     = 0;
+    int       mark     = 0;
+    int       i        = 0;
+    int       g        = 0;
+    int       rc       = 0;
+
+    rc = newTree( pRepo, pTree ); if( rc ) return rc;
+    allBlack = pTree->marks - 1;
+
+    for( i = 0; i < pRepo->actualCodes; i++ )
+    {
+        pSoln = &pRepo->data[i];
+        node  = 0;
+        for( g = 0; g < pSoln->actualNoTurns && g < pRepo->guesses && node != -1; g++ )
+        {
+            if( pTree->node[node].guess == -1 )
+            {
+                pTree->node[node].guess = pSoln->turns[g].guess;
+                pTree->node[node].line  = pSoln->line;
+            }
+            else if( pTree->node[node].guess != pSoln->turns[g].guess )
+            {
+                pSoln->guessConsistant = false;
+                break;                                       // The rest of this line is off the tree
+            }
+
+            mark = pSoln->turns[g].mark;
+            if( mark < 0 || mark >= allBlack ) break;        // Resolved (or a bad mark)
+
+            next = pTree->child[node * pTree->marks + mark];
+            if( next == -1 )
+            {
+                next = addNode( pRepo, pTree );
+                if( next == -1 ) return -1;
+                pTree->child[node * pTree->marks + mark] = next;
+                pTree->node[next].depth = g + 1;
+            }
+            node = next;
+        }
+    }
+    return 0;
+}
+
+// Release the memory held by a tree
+void freeTree( Tree* pTree )
+{
+    free( pTree->node );
+    free( pTree->child );
+    pTree->node  = NULL;
+    pTree->child = NULL;
+    pTree->nodes = 0;
+    pTree->size  = 0;
+}
+
+// Replay validation
+// Build the strategy tree from the file, then play every code through it using the real marking function
+// Completeness, marks and consistency are all checked in the one pass over the codes
+// There is no sorting and no mark table is needed
+int checkReplay( Repo* pRepo )
+{
+    Tree  tree;
+    int*  lineOf  = NULL;
+    int   code    = 0;
+    int   i       = 0;
+    int   g       = 0;
+    int   rc      = 0;
+
+    rc = newCodeMaps( pRepo ); if( rc ) return rc;
+
+    // Find the line claiming each code, in file order, so the first claim is the one played through the tree
+    lineOf = (int*)malloc( sizeof(int) * pRepo->codes );
+    if( lineOf == NULL )
+    {
+        fprintf( pRepo->err, "Failed to allocate array in checkReplay\n" );
+        return -1;
+    }
+    for( code = 0; code < pRepo->codes; code++ ) lineOf[code] = -1;
+
+    for( i = 0; i < pRepo->actualCodes; i++ )
+    {
+        code = pRepo->data[i].code;
+        if( code < 0 || code >= pRepo->codes )
+        {
+            pRepo->data[i].codeRepeated = false;
+        }
+        else if( lineOf[code] == -1 )
+        {
+            lineOf[code] = i;
+            pRepo->data[i].codeRepeated = false;
+            setBit( pRepo->seen, code );
+        }
+        else
+        {
+            pRepo->data[i].codeRepeated = true;
+            setBit( pRepo->repeat, code );
+
+            // Repeated lines are not played through the tree, so check their marks directly
+            for( g = 0; g < pRepo->data[i].actualNoTurns && g < pRepo->guesses; g++ )
+                if( pRepo->data[i].turns[g].guess >= 0 )
+                    pRepo->data[i].turns[g].markOK = ( pRepo->data[i].turns[g].mark == scoreCodes( pRepo, pRepo->data[i].turns[g].guess, code ) );
+        }
+    }
+    pRepo->missingCodes = countMissing( pRepo );
+
+    rc = buildTree( pRepo, &tree );
+    if( rc == 0 )
+    {
+        pRepo->tree = &tree;
+        rc = runParallel( pRepo, pRepo->codes, replayCodes, lineOf );
+        pRepo->tree = NULL;
+    }
+
+    freeTree( &tree );
+    free( lineOf );
+    return rc;
+}
+
+// Play codes [from, to) through the strategy tree
+// Each code's own line (if it has one) is checked against the game actually played
+// Only the line belonging to each code is updated, so codes can be played on separate threads
+void replayCodes( Repo* pRepo, int from, int to, void* arg )
+{
+    Tree*     pTree    = pRepo->tree;
+    int*      lineOf   = (int*)arg;
+    Solution* pSoln    = NULL;
+    int       allBlack = 0;
+    int       node     = 0;
+    int       guess    = 0;
+    int       mark     = 0;
+    int       depth    = 0;
+    int       left     = 0;
+    int       code     = 0;
+    int       g        = 0;
+
+    allBlack = pTree->marks - 1;
+
+    for( code = from; code < to; code++ )
+    {
+        if( lineOf[code] == -1 ) continue;                  // Missing - already reported
+        pSoln  = &pRepo->data[lineOf[code]];
+        node   = 0;
+        depth  = 0;
+        left   = -1;
+
+        // Play the game
+        for( g = 0; g < pRepo->guesses && node != -1; g++ )
+        {
+            guess = pTree->node[node].guess;
+            if( guess < 0 || guess >= pRepo->codes ) break;
+            mark  = scoreCodes( pRepo, guess, code );
+
+            // While the line follows the tree, its mark must be the one just scored
+            if( left == -1 && g < pSoln->actualNoTurns && pSoln->turns[g].guess == guess )
+                pSoln->turns[g].markOK = ( pSoln->turns[g].mark == mark );
+            else if( left == -1 )
+                left = g;
+
+            if( mark == allBlack )
+            {
+                depth = g + 1;
+                break;
+            }
+            node = pTree->child[node * pTree->marks + mark];
+        }
+
+        // If the line has left the tree (eg after a wrong mark), or goes on past the end of the game, score its own guesses
+        if( left == -1 ) left = depth > 0 ? depth : g;
+        for( g = left; g < pSoln->actualNoTurns && g < pRepo->guesses; g++ )
+            if( pSoln->turns[g].guess >= 0 )
+                pSoln->turns[g].markOK = ( pSoln->turns[g].mark == scoreCodes( pRepo, pSoln->turns[g].guess, code ) );
+
+        // The game must reach all-black, in the number of turns the line claims
+        if( depth == 0 )
+            pSoln->resolved = false;
+        else if( depth != pSoln->noTurns )
+            pSoln->turnsOK = false;
+    }
+}
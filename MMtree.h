@@ -0,0 +1,23 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//  
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+#ifndef MMTREE_H
+#define MMTREE_H
+
+#include "MMchk.h"
+
+int  newTree( Repo* pRepo, Tree* pTree );
+int  addNode( Repo* pRepo, Tree* pTree );
+int  buildTree( Repo* pRepo, Tree* pTree );
+void freeTree( Tree* pTree );
+int  checkReplay( Repo* pRepo );
+void replayCodes( Repo* pRepo, int from, int to, void* arg );
+
+#endif  /* MMTREE_H */
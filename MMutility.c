@@ -13,10 +13,28 @@
 //
 #include "MMutility.h"
 #include "MMchk.h"
+#include "MMkernels.h"
 
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
+
+// Translation of a [black, white] marking into the mark numbering used throughout
+// Use a numbering scheme so that for each number of pegs, there is a contiguous range of marks
+const unsigned char markTranslation[MAX_PEGS+1][MAX_PEGS+1] = {       // Use  marking[black, white]
+                                                        {  0,  2,  3,  5,  9, 14, 20, 27, 35, 44, 54 }   // 0 black pegs; 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 and 10 white pegs
+                                                      , {  1,  6,  7, 10, 15, 21, 28, 36, 45, 55, XX }   // 1 black peg;  0, 1, 2, 3, 4, 5, 6, 7, 8 and 9 white pegs
+                                                      , {  4, 11, 12, 16, 22, 29, 37, 46, 56, XX, XX }   // 2 black pegs; 0, 1, 2, 3, 4, 5, 6, 7 and 8 white pegs
+                                                      , {  8, 17, 18, 23, 30, 38, 47, 57, XX, XX, XX }   // 3 black pegs; 0, 1, 2, 3, 4, 5, 6 and 7 white pegs
+                                                      , { 13, 24, 25, 31, 39, 48, 58, XX, XX, XX, XX }   // 4 black pegs; 0, 1, 2, 3, 4, 5 and 6 white pegs
+                                                      , { 19, 32, 33, 40, 49, 59, XX, XX, XX, XX, XX }   // 5 black pegs; 0, 1, 2, 3, 4 and 5 white pegs
+                                                      , { 26, 41, 42, 50, 60, XX, XX, XX, XX, XX, XX }   // 6 black pegs; 0, 1, 2, 3 and 4 white pegs
+                                                      , { 34, 51, 52, 61, XX, XX, XX, XX, XX, XX, XX }   // 7 black pegs; 0, 1, 2 and 3 white pegs
+                                                      , { 43, 62, 63, XX, XX, XX, XX, XX, XX, XX, XX }   // 8 black pegs; 0, 1 and 2 white pegs
+                                                      , { 53, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX }   // 9 black pegs; No white pags (can't have 9 black, 1 white)
+                                                      , { 64, XX, XX, XX, XX, XX, XX, XX, XX, XX, XX }   // 10 black pegs
+                                                      };
 
 // Convert a string to an integer
 // Only positive integers are allowed (including zero)
@@ -65,10 +83,30 @@ int stringToInt( char* str )
     return (int)val;
 }
 
+// Convert a string to a number of bytes - a whole number, optionally followed by K, M or G
+// Handle error situations and return -1 in the case of an error
+long long stringToSize( char* str )
+{
+    long long val  = 0;
+    char*     end  = NULL;
+
+    if( str[0] < '0' || str[0] > '9' ) return -1;
+    val = strtoll( str, &end, 10 );
+    switch( *end )
+    {
+        case 'k': case 'K':   val <<= 10;   end++;   break;
+        case 'm': case 'M':   val <<= 20;   end++;   break;
+        case 'g': case 'G':   val <<= 30;   end++;   break;
+    }
+    if( *end != '\0' || val <= 0 ) return -1;
+
+    return val;
+}
+
 // Construct a string that represents a specified code
 // If the second parameter is false (to show that the code is not feasible), then mark the code in perenthesis
 // NOTE - There MUST be Pegs+3 bytes space available in the string - or it will crash
-char* printCode( Repo* pRepo, unsigned short code, bool feasible, char* pcBuf )
+char* printCode( Repo* pRepo, int code, bool feasible, char* pcBuf )
 {
     int posn = 0;
     int i    = 0;
@@ -77,9 +115,17 @@ char* printCode( Repo* pRepo, unsigned short code, bool feasible, char* pcBuf )
     {
         if( !feasible ) pcBuf[posn++] = '(';
 
-        for( i = pRepo->pegs; i > 0; i-- )
+        if( pRepo->kernel != NULL )
+        {
+            pRepo->kernel->print( code, pcBuf + posn );
+            posn += pRepo->pegs;
+        }
+        else
         {
-            pcBuf[posn++] = 'A'+pRepo->codeDefs[code].peg[i-1];    // Display as letters, but can easily change to numbers
+            for( i = pRepo->pegs; i > 0; i-- )
+            {
+                pcBuf[posn++] = 'A'+pRepo->codeDefs[code].peg[i-1];    // Display as letters, but can easily change to numbers
+            }
         }
         if( !feasible ) pcBuf[posn++] = ')';
         pcBuf[posn] = '\0';
@@ -88,12 +134,88 @@ char* printCode( Repo* pRepo, unsigned short code, bool feasible, char* pcBuf )
     return pcBuf;
 }
 
+// Construct the string for a mark, eg "bbw" - or "-" for no score
+// NOTE - There MUST be Pegs+1 bytes space available in the string
+char* printMark( Repo* pRepo, int mark, char* buffer )
+{
+    int black = 0;
+    int white = 0;
+    int posn  = 0;
+
+    strcpy( buffer, "-" );
+    for( black = 0; black <= pRepo->pegs; black++ )
+        for( white = 0; black + white <= pRepo->pegs; white++ )
+            if( markTranslation[black][white] == mark && black + white > 0 )
+            {
+                for( posn = 0; posn < black; posn++ )         buffer[posn] = 'b';
+                for( ; posn < black + white; posn++ )         buffer[posn] = 'w';
+                buffer[posn] = '\0';
+            }
+
+    return buffer;
+}
+
 // Return the mark awarded for the given guess and solution
 // Note, this is functionalised so that the larger parameter can be passed first
 // This allows the marking array to be effectively halved in size
-char marking( Repo* pRepo, unsigned short guess, unsigned short solution )
+// Depending on the memory available, the mark comes from the full table, from a row for the guess, or is scored there and then
+char marking( Repo* pRepo, int guess, int solution )
+{
+    size_t index = 0;
+
+    if( guess < 0 || solution < 0 || guess >= pRepo->codes || solution >= pRepo->codes ) return XX;
+    if( guess == solution ) return ( pRepo->pegs * ( pRepo->pegs + 3 ) ) / 2 - 1;     // All black
+
+    if( pRepo->markTable != NULL )
+    {
+        index = guess > solution ? markIndex( guess, solution ) : markIndex( solution, guess );
+        if( pRepo->markPacked )
+            return ( pRepo->markTable[index/2] >> ( ( index & 1 ) * 4 ) ) & 0x0F;
+        return pRepo->markTable[index];
+    }
+    if( pRepo->guessMarks != NULL && pRepo->guessMarks[guess] != NULL )
+        return pRepo->guessMarks[guess][solution];
+    if( pRepo->guessMarks != NULL && pRepo->guessMarks[solution] != NULL )
+        return pRepo->guessMarks[solution][guess];
+
+    return scoreCodes( pRepo, guess, solution );
+}
+
+// Score a guess against a solution directly, without needing the marking array (or the code definitions)
+// Each code is broken down into its pegs as it is scored
+char scoreCodes( Repo* pRepo, int guess, int solution )
 {
-    return guess > solution ? pRepo->marking[guess][solution] : pRepo->marking[solution][guess];
+    unsigned char guessColours[MAX_COLOURS];
+    unsigned char solutionColours[MAX_COLOURS];
+    unsigned char black    = 0;
+    unsigned char total    = 0;
+    int           g        = 0;
+    int           s        = 0;
+    int           i        = 0;
+
+    if( pRepo->kernel != NULL ) return pRepo->kernel->score( guess, solution );
+
+    for( i = 0; i < pRepo->colours; i++ )
+    {
+        guessColours[i]    = 0;
+        solutionColours[i] = 0;
+    }
+
+    for( i = 0; i < pRepo->pegs; i++ )
+    {
+        g = guess % pRepo->colours;
+        s = solution % pRepo->colours;
+        if( g == s ) black += 1;
+        guessColours[g]++;
+        solutionColours[s]++;
+        guess /= pRepo->colours;
+        solution /= pRepo->colours;
+    }
+
+    for( i = 0; i < pRepo->colours; i++ )
+        total += solutionColours[i] < guessColours[i] ? solutionColours[i] : guessColours[i];
+
+    return markTranslation[black][total-black];
 }
 
 // Determine the code value for the string provided
@@ -101,11 +223,11 @@ char marking( Repo* pRepo, unsigned short guess, unsigned short solution )
 // If the string does not match up with a valid code then return STOP
 // Note that any additional characters after the expected number will be ignored
 // (Therefore "ABCD" will be seen as the same as "ABCDE" if only 4 pegs are expected)
-unsigned short getCode( Repo* pRepo, char* codeString )
+int getCode( Repo* pRepo, char* codeString )
 {
-    short          i      = 0;
-    int            colour = 0;
-    unsigned short code   = 0;
+    int i      = 0;
+    int colour = 0;
+    int code   = 0;
 
     if( strlen( codeString ) < pRepo->pegs ) return STOP;
     for( i = 0; i < pRepo->pegs; i++ )
@@ -221,4 +343,17 @@ int getMark( Repo* pRepo, char* markString )
     if( strcmp(cleanMark, "bbbbbbbbbb" ) == 0 ) return 64;
 
     return -1;
-}
\ No newline at end of file
+}
+
+// Write to the report stream
+// If there isn't one (eg when validating in-process and only the results are wanted) then say nothing
+void say( Repo* pRepo, const char* format, ... )
+{
+    va_list args;
+
+    if( pRepo->out == NULL ) return;
+
+    va_start( args, format );
+    vfprintf( pRepo->out, format, args );
+    va_end( args );
+}
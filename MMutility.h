@@ -15,10 +15,31 @@
 
 #include <stdbool.h>
 
+extern const unsigned char markTranslation[MAX_PEGS+1][MAX_PEGS+1];
+
 int   stringToInt( char* str );
-char* printCode( Repo* pRepo, unsigned short code, bool feasible, char* buffer );
-char  marking( Repo* pRepo, unsigned short guess, unsigned short solution );
-unsigned short getCode( Repo* pRepo, char* codeString );
+long long stringToSize( char* str );
+char* printCode( Repo* pRepo, int code, bool feasible, char* buffer );
+char* printMark( Repo* pRepo, int mark, char* buffer );
+char  marking( Repo* pRepo, int guess, int solution );
+char  scoreCodes( Repo* pRepo, int guess, int solution );
+int   getCode( Repo* pRepo, char* codeString );
 int   getMark( Repo* pRepo, char* markString );
+void  say( Repo* pRepo, const char* format, ... );
+
+// Position of the mark for codes row and col (row >= col) in the triangular mark table - row r starts after r(r+1)/2 marks
+static inline size_t markIndex( int row, int col )       { return (size_t)row * ( row + 1 ) / 2 + col; }
+
+// Bitmaps (eg of codes) are held as arrays of 64 bit words
+static inline int  bitmapWords( int bits )               { return ( bits + 63 ) / 64; }
+static inline bool testBit( uint64_t* map, int bit )     { return ( map[bit/64] >> ( bit % 64 ) ) & 1; }
+static inline void setBit( uint64_t* map, int bit )      { map[bit/64] |= 1ULL << ( bit % 64 ); }
+
+// Set a bit, safely with other threads doing the same - returns whether it was already set
+static inline bool atomicSetBit( uint64_t* map, int bit )
+{
+    uint64_t mask = 1ULL << ( bit % 64 );
+    return ( __atomic_fetch_or( &map[bit/64], mask, __ATOMIC_RELAXED ) & mask ) != 0;
+}
 
 #endif  /* MMUTILITY_H */
\ No newline at end of file
@@ -0,0 +1,286 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Test input generator - writes a valid solution file, in the format MMopt writes, for any size of puzzle
+//     MMgen pegs colours file [--shuffle] [--crlf]
+// The strategy is simple but always the same, so a file generated for the tests can be checked against a known report
+// The first guess is half A's and half B's, after that the guess is whichever of the first few codes still possible
+// leaves the smallest largest group.  Every guess could be the code, so no guess is bracketed
+// --shuffle writes the lines in a fixed random order rather than in code order, and --crlf ends lines with CR LF
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#define GEN_MAX_PEGS           10
+#define GEN_MAX_GUESSES        10                      // The most guesses MMchk will read from a header
+#define GEN_TRIALS             8                       // Codes tried as each guess
+
+typedef struct Gen
+{
+    int   pegs;
+    int   colours;
+    int   codes;
+    int   keys;                                        // Marks are keyed black * ( pegs + 1 ) + white
+    int*  turns;                                       // Turns taken to solve each code
+    int*  guess;                                       // Guesses made for each code - GEN_MAX_GUESSES per code
+    int*  mark;                                        // Mark each guess got
+    int   deepest;
+} Gen;
+
+int  solve( Gen* pGen, int* cands, int count, int depth, int* path, int* marks );
+int  score( Gen* pGen, int a, int b );
+void codeString( Gen* pGen, int code, char* buffer );
+void markString( Gen* pGen, int key, char* buffer );
+int  writeFile( Gen* pGen, char* filename, bool shuffle, bool crlf );
+
+int main( int argc, char** argv )
+{
+    Gen   gen;
+    int*  cands   = NULL;
+    int   path[GEN_MAX_GUESSES];
+    int   marks[GEN_MAX_GUESSES];
+    bool  shuffle = false;
+    bool  crlf    = false;
+    int   i       = 0;
+    int   rc      = 0;
+
+    if( argc < 4 )
+    {
+        fprintf( stderr, "Usage: MMgen pegs colours file [--shuffle] [--crlf]\n" );
+        return 1;
+    }
+    memset( &gen, 0, sizeof(Gen) );
+    gen.pegs    = atoi( argv[1] );
+    gen.colours = atoi( argv[2] );
+    for( i = 4; i < argc; i++ )
+    {
+        if( strcmp( argv[i], "--shuffle" ) == 0 )   shuffle = true;
+        else if( strcmp( argv[i], "--crlf" ) == 0 ) crlf    = true;
+        else
+        {
+            fprintf( stderr, "Unknown option: %s\n", argv[i] );
+            return 1;
+        }
+    }
+    if( gen.pegs < 1 || gen.pegs > GEN_MAX_PEGS || gen.colours < 1 || gen.colours > 26 )
+    {
+        fprintf( stderr, "Pegs must be 1 to %d, and colours 1 to 26\n", GEN_MAX_PEGS );
+        return 1;
+    }
+
+    gen.codes = 1;
+    for( i = 0; i < gen.pegs; i++ ) gen.codes *= gen.colours;
+    gen.keys  = ( gen.pegs + 1 ) * ( gen.pegs + 1 );
+    gen.turns = (int*)malloc( sizeof(int) * gen.codes );
+    gen.guess = (int*)malloc( sizeof(int) * gen.codes * GEN_MAX_GUESSES );
+    gen.mark  = (int*)malloc( sizeof(int) * gen.codes * GEN_MAX_GUESSES );
+    cands     = (int*)malloc( sizeof(int) * gen.codes );
+    if( gen.turns == NULL || gen.guess == NULL || gen.mark == NULL || cands == NULL )
+    {
+        fprintf( stderr, "Failed to allocate arrays in MMgen\n" );
+        return 1;
+    }
+
+    for( i = 0; i < gen.codes; i++ ) cands[i] = i;
+    rc = solve( &gen, cands, gen.codes, 0, path, marks );
+    if( rc == 0 ) rc = writeFile( &gen, argv[3], shuffle, crlf );
+
+    free( cands );
+    free( gen.turns );
+    free( gen.guess );
+    free( gen.mark );
+    return rc == 0 ? 0 : 1;
+}
+
+// Choose a guess for the codes still possible, then split them by the mark each would get and solve each group
+// path and marks hold the guesses and marks leading here
+int solve( Gen* pGen, int* cands, int count, int depth, int* path, int* marks )
+{
+    int* size    = NULL;
+    int* start   = NULL;
+    int* split   = NULL;
+    int  solved  = pGen->pegs * ( pGen->pegs + 1 );    // Key of the all-black mark
+    int  guess   = 0;
+    int  largest = 0;
+    int  best    = 0;
+    int  key     = 0;
+    int  i       = 0;
+    int  t       = 0;
+    int  rc      = 0;
+
+    if( depth >= GEN_MAX_GUESSES )
+    {
+        fprintf( stderr, "The strategy needs more than %d guesses for this puzzle\n", GEN_MAX_GUESSES );
+        return -1;
+    }
+
+    size  = (int*)calloc( pGen->keys, sizeof(int) );
+    start = (int*)calloc( pGen->keys, sizeof(int) );
+    split = (int*)malloc( sizeof(int) * count );
+    if( size == NULL || start == NULL || split == NULL )
+    {
+        fprintf( stderr, "Failed to allocate arrays in solve\n" );
+        free( size ); free( start ); free( split );
+        return -1;
+    }
+
+    // Pick the guess
+    if( depth == 0 )
+    {
+        for( i = 0; i < pGen->pegs; i++ )
+            guess = guess * pGen->colours + ( i < pGen->pegs / 2 || pGen->colours < 2 ? 0 : 1 );
+    }
+    else
+    {
+        best = count + 1;
+        for( t = 0; t < count && t < GEN_TRIALS; t++ )
+        {
+            memset( size, 0, sizeof(int) * pGen->keys );
+            for( i = 0, largest = 0; i < count; i++ )
+                if( ++size[score( pGen, cands[t], cands[i] )] > largest ) largest = size[score( pGen, cands[t], cands[i] )];
+            if( largest < best )
+            {
+                best  = largest;
+                guess = cands[t];
+            }
+        }
+    }
+
+    // Group the codes by mark, keeping them in code order within each group
+    memset( size, 0, sizeof(int) * pGen->keys );
+    for( i = 0; i < count; i++ ) size[score( pGen, guess, cands[i] )] += 1;
+    for( key = 1; key < pGen->keys; key++ ) start[key] = start[key-1] + size[key-1];
+    for( i = 0; i < count; i++ ) split[start[score( pGen, guess, cands[i] )]++] = cands[i];
+    for( key = 0; key < pGen->keys; key++ ) start[key] -= size[key];
+
+    path[depth] = guess;
+    for( key = 0; key < pGen->keys && rc == 0; key++ )
+    {
+        if( size[key] == 0 ) continue;
+        marks[depth] = key;
+        if( key == solved )
+        {
+            pGen->turns[guess] = depth + 1;
+            memcpy( &pGen->guess[guess * GEN_MAX_GUESSES], path, sizeof(int) * ( depth + 1 ) );
+            memcpy( &pGen->mark[guess * GEN_MAX_GUESSES], marks, sizeof(int) * ( depth + 1 ) );
+            if( depth + 1 > pGen->deepest ) pGen->deepest = depth + 1;
+        }
+        else
+            rc = solve( pGen, &split[start[key]], size[key], depth + 1, path, marks );
+    }
+
+    free( size );
+    free( start );
+    free( split );
+    return rc;
+}
+
+// Mark for guess a against code b, as black * ( pegs + 1 ) + white
+int score( Gen* pGen, int a, int b )
+{
+    int countA[26];
+    int countB[26];
+    int black = 0;
+    int both  = 0;
+    int i     = 0;
+
+    memset( countA, 0, sizeof(countA) );
+    memset( countB, 0, sizeof(countB) );
+    for( i = 0; i < pGen->pegs; i++, a /= pGen->colours, b /= pGen->colours )
+    {
+        if( a % pGen->colours == b % pGen->colours ) black += 1;
+        countA[a % pGen->colours] += 1;
+        countB[b % pGen->colours] += 1;
+    }
+    for( i = 0; i < pGen->colours; i++ )
+        both += countA[i] < countB[i] ? countA[i] : countB[i];
+
+    return black * ( pGen->pegs + 1 ) + both - black;
+}
+
+// Code as letters, the first peg the most significant
+void codeString( Gen* pGen, int code, char* buffer )
+{
+    int i = 0;
+
+    for( i = pGen->pegs - 1; i >= 0; i--, code /= pGen->colours )
+        buffer[i] = 'A' + code % pGen->colours;
+    buffer[pGen->pegs] = '\0';
+}
+
+// Mark as b's then w's, or - for no score
+void markString( Gen* pGen, int key, char* buffer )
+{
+    int black = key / ( pGen->pegs + 1 );
+    int white = key % ( pGen->pegs + 1 );
+    int i     = 0;
+
+    for( i = 0; i < black; i++ )         buffer[i] = 'b';
+    for( ; i < black + white; i++ )      buffer[i] = 'w';
+    if( i == 0 )                         buffer[i++] = '-';
+    buffer[i] = '\0';
+}
+
+// Write the header, then a line for each code
+int writeFile( Gen* pGen, char* filename, bool shuffle, bool crlf )
+{
+    char         code[GEN_MAX_PEGS + 1];
+    char         mark[GEN_MAX_PEGS + 2];
+    char*        eol   = crlf ? "\r\n" : "\n";
+    int*         order = NULL;
+    FILE*        fp    = NULL;
+    unsigned int seed  = 12345;
+    int          swap  = 0;
+    int          i     = 0;
+    int          j     = 0;
+    int          g     = 0;
+
+    order = (int*)malloc( sizeof(int) * pGen->codes );
+    fp    = fopen( filename, "wb" );
+    if( order == NULL || fp == NULL )
+    {
+        fprintf( stderr, "Unable to write %s\n", filename );
+        free( order );
+        if( fp != NULL ) fclose( fp );
+        return -1;
+    }
+
+    // A fixed shuffle, the same on every platform
+    for( i = 0; i < pGen->codes; i++ ) order[i] = i;
+    for( i = pGen->codes - 1; shuffle && i > 0; i-- )
+    {
+        seed = seed * 1103515245 + 12345;
+        j    = ( seed >> 8 ) % ( i + 1 );
+        swap = order[i]; order[i] = order[j]; order[j] = swap;
+    }
+
+    fprintf( fp, "#,Solution,Turns" );
+    for( g = 0; g < pGen->deepest; g++ ) fprintf( fp, ",Guess%d,Mark%d", g + 1, g + 1 );
+    fprintf( fp, "%s", eol );
+
+    for( i = 0; i < pGen->codes; i++ )
+    {
+        codeString( pGen, order[i], code );
+        fprintf( fp, "%d,%s,%d", order[i], code, pGen->turns[order[i]] );
+        for( g = 0; g < pGen->turns[order[i]]; g++ )
+        {
+            codeString( pGen, pGen->guess[order[i] * GEN_MAX_GUESSES + g], code );
+            markString( pGen, pGen->mark[order[i] * GEN_MAX_GUESSES + g], mark );
+            fprintf( fp, ",%s,%s", code, mark );
+        }
+        fprintf( fp, "%s", eol );
+    }
+
+    free( order );
+    return fclose( fp ) == 0 ? 0 : -1;
+}
@@ -0,0 +1,147 @@
+/******************************************************************************************************************/
+//  This is part of a program to find optimal or near optimal solutions to Mastermind games of varying complexity
+//  The specific puzzle to be solved and method employed may be configured using a series of parameters
+//  For details about the parameters please run:   MMopt -h
+//
+//  The author of this code is myself  Bruce Tandy
+//  My contact details are bruce.tandy@btinternet.com
+//
+//  I would be very interested to hear your feedback about this program and results you have obtained from it
+/******************************************************************************************************************/
+//
+// Library test - validates a solution file through each entry point of the mmchk library, and shows the results
+//     MMlibtest file
+// The file is validated from its name, from a buffer holding it and a row at a time, all with the same repository
+// Each MMresult is shown in turn, so the golden tests can hold them to what MMchk reports for the file
+// Returns 1 if the entry points don't agree
+//
+#include "MMlib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Rows of the solution, handed out one at a time by nextRow
+typedef struct Rows
+{
+    char*  text;
+    char*  next;
+} Rows;
+
+const char* nextRow( void* user );
+char*       readFile( char* filename, size_t* pLength );
+void        showResult( char* how, int rc, MMresult* pResult );
+
+int main( int argc, char** argv )
+{
+    MMresult result[3];
+    Repo*    pRepo  = NULL;
+    Rows     rows;
+    char*    text   = NULL;
+    size_t   length = 0;
+    int      rc[3];
+    int      i      = 0;
+
+    if( argc != 2 )
+    {
+        fprintf( stderr, "Usage: MMlibtest file\n" );
+        return 1;
+    }
+    text = readFile( argv[1], &length );
+    pRepo = mmchkNew();
+    if( text == NULL || pRepo == NULL )
+        return 1;
+
+    rc[0] = mmchkValidateFile( pRepo, argv[1], &result[0] );
+    showResult( "file", rc[0], &result[0] );
+
+    rc[1] = mmchkValidateBuffer( pRepo, argv[1], text, length, &result[1] );
+    showResult( "buffer", rc[1], &result[1] );
+
+    // The rows are the lines of the text, without their new lines
+    rows.text = strdup( text );
+    rows.next = rows.text;
+    rc[2] = mmchkValidateRows( pRepo, argv[1], nextRow, &rows, &result[2] );
+    showResult( "rows", rc[2], &result[2] );
+
+    mmchkDelete( pRepo );
+    free( rows.text );
+    free( text );
+
+    for( i = 1; i < 3; i++ )
+        if( rc[i] != rc[0] || ( rc[0] == 0 && memcmp( &result[i], &result[0], sizeof(MMresult) ) != 0 ) )
+        {
+            printf( "The results differ\n" );
+            return 1;
+        }
+    return 0;
+}
+
+// Hand out the next row, or NULL after the last
+const char* nextRow( void* user )
+{
+    Rows* pRows = (Rows*)user;
+    char* row   = pRows->next;
+    char* end   = NULL;
+
+    if( row == NULL || *row == '\0' ) return NULL;
+    end = strchr( row, '\n' );
+    if( end != NULL )
+    {
+        *end        = '\0';
+        pRows->next = end + 1;
+    }
+    else
+        pRows->next = NULL;
+    return row;
+}
+
+// The whole of a file, in memory
+char* readFile( char* filename, size_t* pLength )
+{
+    FILE* fp   = fopen( filename, "rb" );
+    char* text = NULL;
+    long  size = 0;
+
+    if( fp == NULL )
+    {
+        fprintf( stderr, "Unable to open file: %s\n", filename );
+        return NULL;
+    }
+    fseek( fp, 0, SEEK_END );
+    size = ftell( fp );
+    fseek( fp, 0, SEEK_SET );
+    text = (char*)malloc( size + 1 );
+    if( text != NULL && fread( text, 1, size, fp ) == (size_t)size )
+    {
+        text[size] = '\0';
+        *pLength   = size;
+    }
+    else
+    {
+        fprintf( stderr, "Unable to read file: %s\n", filename );
+        free( text );
+        text = NULL;
+    }
+    fclose( fp );
+    return text;
+}
+
+// Show what was found - only the return code if the solution could not be checked
+void showResult( char* how, int rc, MMresult* pResult )
+{
+    if( rc != 0 )
+    {
+        printf( "%-7s rc %d\n", how, rc );
+        return;
+    }
+    printf( "%-7s rc %d, valid %d, %d pegs %d colours, %d of %d codes, pegs/colours/codes OK %d%d%d, %d missing\n",
+            how, rc, pResult->valid, pResult->pegs, pResult->colours, pResult->actualCodes, pResult->codes,
+            pResult->pegsOK, pResult->coloursOK, pResult->codesOK, pResult->missingCodes );
+    printf( "        %d error lines: %d bad codes, %d repeated, %d wrong turns, %d unresolved, %d wrong marks,"
+            " %d bad guesses, %d inconsistent, %d wrong brackets - first on line %d\n",
+            pResult->errorLines, pResult->badCodes, pResult->repeatedCodes, pResult->wrongTurns, pResult->unresolved,
+            pResult->wrongMarks, pResult->badGuesses, pResult->inconsistent, pResult->wrongBrackets,
+            pResult->firstErrorLine );
+    printf( "        TTTS %ld, worst case %d\n", pResult->TTTS, pResult->worstCase );
+}
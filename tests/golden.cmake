@@ -0,0 +1,118 @@
+# Run MMchk on one solution file and compare what it does with the expected results
+#   cmake -DMMCHK=<MMchk> -DINPUT=<solution file> -DEXPECTED=<expected results, less the extension>
+#         -DWORK=<scratch directory> [-DOPTIONS="<options>"] [-DUPDATE=ON] -P golden.cmake
+# The file is added after the options, unless they name it themselves - @FILE@ is the file, @NAME@ the file less .csv
+# Optionally:
+#   -DEXTRA="<file>|..."        more files copied alongside it (eg the other solution for --diff)
+#   -DBEFORE="<options>|..."    runs made first, each of which must succeed (eg --shard 1/2 @FILE@|--shard 2/2 @FILE@)
+#   -DDAEMON=ON                 a daemon is started on the socket "sock" for the run, and stopped after it
+#   -DMASK="<regex>"            whatever the regex matches in the report is shown as ... (eg timings)
+# The expected results are:
+#   <name>.out          the report (stdout)
+#   <name>.err          anything written to stderr (no file if nothing is)
+#   <name>.rc           the exit status (no file if it is 0)
+#   <name>_ERRORS.csv   the _ERRORS.csv file written (no file if none is)
+# With -DUPDATE=ON the expected results are written from this run instead - check the differences before committing them
+
+foreach( var MMCHK INPUT EXPECTED WORK )
+    if( NOT DEFINED ${var} )
+        message( FATAL_ERROR "golden.cmake needs -D${var}=..." )
+    endif()
+endforeach()
+
+# The file is checked from a directory of its own, so the report names it the same way wherever the tree is
+get_filename_component( name "${INPUT}" NAME_WE )
+get_filename_component( file "${INPUT}" NAME )
+string( REPLACE "|" ";" EXTRA "${EXTRA}" )
+file( REMOVE_RECURSE "${WORK}" )
+file( MAKE_DIRECTORY "${WORK}/cache" )
+file( COPY "${INPUT}" ${EXTRA} DESTINATION "${WORK}" )
+
+# Options as a list, with the file put in where it is named (or at the end)
+function( arguments var options )
+    if( NOT options MATCHES "@FILE@|@NAME@" )
+        set( options "${options} @FILE@" )
+    endif()
+    string( REPLACE "@FILE@" "\"${file}\"" options "${options}" )
+    string( REPLACE "@NAME@" "${name}" options "${options}" )
+    separate_arguments( options UNIX_COMMAND "${options}" )
+    set( ${var} ${options} PARENT_SCOPE )
+endfunction()
+
+string( REPLACE "|" ";" BEFORE "${BEFORE}" )
+foreach( before ${BEFORE} )
+    arguments( args "${before}" )
+    execute_process( COMMAND "${MMCHK}" ${args} WORKING_DIRECTORY "${WORK}" RESULT_VARIABLE rc
+                     OUTPUT_QUIET ERROR_VARIABLE err )
+    if( NOT rc EQUAL 0 )
+        message( FATAL_ERROR "MMchk ${before} failed (${rc}) for ${file}\n${err}" )
+    endif()
+endforeach()
+
+# The daemon is left running in the background (by the shell) until the run is over
+if( DAEMON )
+    execute_process( COMMAND sh -c "\"$0\" --daemon sock </dev/null >daemon.out 2>daemon.err & echo $! >daemon.pid" "${MMCHK}"
+                     WORKING_DIRECTORY "${WORK}" )
+    foreach( wait RANGE 50 )
+        if( EXISTS "${WORK}/sock" )
+            break()
+        endif()
+        execute_process( COMMAND ${CMAKE_COMMAND} -E sleep 0.1 )
+    endforeach()
+endif()
+
+arguments( OPTIONS "${OPTIONS}" )
+execute_process( COMMAND "${MMCHK}" ${OPTIONS}
+                 WORKING_DIRECTORY "${WORK}"
+                 OUTPUT_FILE "${WORK}/stdout"
+                 ERROR_FILE "${WORK}/stderr"
+                 RESULT_VARIABLE rc )
+file( WRITE "${WORK}/rc" "${rc}\n" )
+
+if( DAEMON )
+    execute_process( COMMAND sh -c "kill $(cat daemon.pid)" WORKING_DIRECTORY "${WORK}" )
+endif()
+
+if( MASK )
+    file( READ "${WORK}/stdout" report )
+    string( REGEX REPLACE "${MASK}" "..." report "${report}" )
+    file( WRITE "${WORK}/stdout" "${report}" )
+endif()
+
+if( UPDATE )
+    configure_file( "${WORK}/stdout" "${EXPECTED}.out" COPYONLY )
+    file( REMOVE "${EXPECTED}.err" "${EXPECTED}.rc" "${EXPECTED}_ERRORS.csv" )
+    file( SIZE "${WORK}/stderr" size )
+    if( size GREATER 0 )
+        configure_file( "${WORK}/stderr" "${EXPECTED}.err" COPYONLY )
+    endif()
+    if( NOT rc EQUAL 0 )
+        configure_file( "${WORK}/rc" "${EXPECTED}.rc" COPYONLY )
+    endif()
+    if( EXISTS "${WORK}/${name}_ERRORS.csv" )
+        configure_file( "${WORK}/${name}_ERRORS.csv" "${EXPECTED}_ERRORS.csv" COPYONLY )
+    endif()
+    return()
+endif()
+
+# Compare one result, showing both versions if they differ
+function( compare what actual expected )
+    if( EXISTS "${expected}" )
+        file( READ "${expected}" want )
+    else()
+        set( want "${ARGN}" )
+    endif()
+    if( EXISTS "${actual}" )
+        file( READ "${actual}" got )
+    else()
+        set( got "(no file)" )
+    endif()
+    if( NOT got STREQUAL want )
+        message( FATAL_ERROR "${what} differs for ${file} ${OPTIONS}\n--- expected\n${want}\n--- actual\n${got}" )
+    endif()
+endfunction()
+
+compare( "Report" "${WORK}/stdout" "${EXPECTED}.out" )
+compare( "Stderr" "${WORK}/stderr" "${EXPECTED}.err" "" )
+compare( "Exit status" "${WORK}/rc" "${EXPECTED}.rc" "0\n" )
+compare( "_ERRORS.csv" "${WORK}/${name}_ERRORS.csv" "${EXPECTED}_ERRORS.csv" "(no file)" )
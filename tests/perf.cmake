@@ -0,0 +1,50 @@
+# Run MMchk with --perf-counters on a (generated) solution file, and check each phase keeps up a floor of lines per second
+#   cmake -DMMCHK=<MMchk> -DINPUT=<solution file> -DLINES=<lines in the file> -DWORK=<scratch directory>
+#         -DFLOORS=<phase>=<lines per second>,... [-DOPTIONS="<options>"] -P perf.cmake
+# Phases too quick to time (0.00 ms) always pass.  Phases not run are an error, so a floor can't quietly stop applying
+
+foreach( var MMCHK INPUT LINES WORK FLOORS )
+    if( NOT DEFINED ${var} )
+        message( FATAL_ERROR "perf.cmake needs -D${var}=..." )
+    endif()
+endforeach()
+
+separate_arguments( OPTIONS UNIX_COMMAND "${OPTIONS}" )
+string( REPLACE "," ";" FLOORS "${FLOORS}" )
+
+file( MAKE_DIRECTORY "${WORK}" )
+execute_process( COMMAND "${MMCHK}" --perf-counters ${OPTIONS} "${INPUT}"
+                 WORKING_DIRECTORY "${WORK}"
+                 OUTPUT_VARIABLE report
+                 ERROR_QUIET
+                 RESULT_VARIABLE rc )
+if( NOT rc EQUAL 0 )
+    message( FATAL_ERROR "MMchk failed (${rc}) on ${INPUT}\n${report}" )
+endif()
+message( "${report}" )
+
+set( failed "" )
+foreach( floor ${FLOORS} )
+    string( REPLACE "=" ";" floor "${floor}" )
+    list( GET floor 0 phase )
+    list( GET floor 1 minimum )
+
+    # Phase name, then the wall time in ms to two places - taken as hundredths of a ms to stay in integers
+    if( NOT report MATCHES "\n${phase} +([0-9]+)\\.([0-9][0-9]) " )
+        string( APPEND failed "  ${phase}: not run\n" )
+        continue()
+    endif()
+    math( EXPR hundredths "${CMAKE_MATCH_1} * 100 + ${CMAKE_MATCH_2}" )
+    if( hundredths EQUAL 0 )
+        continue()
+    endif()
+    math( EXPR rate "${LINES} * 100000 / ${hundredths}" )
+    message( "${phase}: ${rate} lines/s (floor ${minimum})" )
+    if( rate LESS minimum )
+        string( APPEND failed "  ${phase}: ${rate} lines/s, below the floor of ${minimum}\n" )
+    endif()
+endforeach()
+
+if( NOT failed STREQUAL "" )
+    message( FATAL_ERROR "Phases below their throughput floor:\n${failed}" )
+endif()